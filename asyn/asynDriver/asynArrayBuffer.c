@@ -0,0 +1,103 @@
+/* asynArrayBuffer.c */
+/***********************************************************************
+* Copyright (c) 2002 The University of Chicago, as Operator of Argonne
+* National Laboratory, and the Regents of the University of
+* California, as Operator of Los Alamos National Laboratory, and
+* Berliner Elektronenspeicherring-Gesellschaft m.b.H. (BESSY).
+* asynDriver is distributed subject to a Software License Agreement
+* found in file LICENSE that is included with this distribution.
+***********************************************************************/
+
+/* Reference counted array buffers */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <cantProceed.h>
+
+#include "asynDriver.h"
+#include "asynArrayBuffer.h"
+
+#if LT_EPICSBASE(3,15,0,1)
+#define ARRAY_BUFFER_USE_MUTEX
+#else
+#include <epicsAtomic.h>
+#endif
+
+struct asynArrayBuffer {
+    size_t        nBytes;
+    int           refCount;
+    double        data[1]; /*aligned for all array types*/
+};
+
+#ifdef ARRAY_BUFFER_USE_MUTEX
+static epicsThreadOnceId onceId = EPICS_THREAD_ONCE_INIT;
+static epicsMutexId lock; /*for refCount*/
+
+static void arrayBufferInit(void *arg)
+{
+    lock = epicsMutexMustCreate();
+}
+
+static void incrRefCount(asynArrayBuffer *pbuf)
+{
+    epicsThreadOnce(&onceId,arrayBufferInit,0);
+    epicsMutexMustLock(lock);
+    pbuf->refCount++;
+    epicsMutexUnlock(lock);
+}
+static int decrRefCount(asynArrayBuffer *pbuf)
+{
+    int refCount;
+
+    epicsThreadOnce(&onceId,arrayBufferInit,0);
+    epicsMutexMustLock(lock);
+    refCount = --pbuf->refCount;
+    epicsMutexUnlock(lock);
+    return refCount;
+}
+#else
+static void incrRefCount(asynArrayBuffer *pbuf)
+{
+    epicsAtomicIncrIntT(&pbuf->refCount);
+}
+static int decrRefCount(asynArrayBuffer *pbuf)
+{
+    return epicsAtomicDecrIntT(&pbuf->refCount);
+}
+#endif
+
+asynArrayBuffer *asynArrayBufferCreate(size_t nBytes)
+{
+    asynArrayBuffer *pbuf;
+
+    pbuf = mallocMustSucceed(offsetof(asynArrayBuffer,data) + nBytes + 1,
+        "asynArrayBufferCreate");
+    pbuf->nBytes = nBytes;
+    pbuf->refCount = 1;
+    return pbuf;
+}
+
+void *asynArrayBufferData(asynArrayBuffer *pbuf)
+{
+    return pbuf->data;
+}
+
+size_t asynArrayBufferSize(asynArrayBuffer *pbuf)
+{
+    return pbuf->nBytes;
+}
+
+void asynArrayBufferReserve(asynArrayBuffer *pbuf)
+{
+    incrRefCount(pbuf);
+}
+
+void asynArrayBufferRelease(asynArrayBuffer *pbuf)
+{
+    if(!pbuf) return;
+    if(decrRefCount(pbuf)!=0) return;
+    free(pbuf);
+}
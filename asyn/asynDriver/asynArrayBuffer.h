@@ -0,0 +1,51 @@
+/* asynArrayBuffer.h */
+/***********************************************************************
+* Copyright (c) 2002 The University of Chicago, as Operator of Argonne
+* National Laboratory, and the Regents of the University of
+* California, as Operator of Los Alamos National Laboratory, and
+* Berliner Elektronenspeicherring-Gesellschaft m.b.H. (BESSY).
+* asynDriver is distributed subject to a Software License Agreement
+* found in file LICENSE that is included with this distribution.
+***********************************************************************/
+
+/* Reference counted array buffers
+ *
+ * A driver that passes an asynArrayBuffer to array interrupt callbacks lets
+ * clients keep a reference instead of copying the data.
+ * The driver must not modify the data after the callbacks.
+ *
+ *     pbuf = asynArrayBufferCreate(n*sizeof(epicsFloat64));
+ *     pdata = (epicsFloat64 *)asynArrayBufferData(pbuf);
+ *     ... fill pdata ...
+ *     doCallbacksArrayBuffer(pbuf, n, reason, addr);
+ *     asynArrayBufferRelease(pbuf);
+ *
+ * During the callbacks pasynUser->arrayBuffer is the buffer, otherwise it is
+ * 0. A client that keeps the data calls asynArrayBufferReserve in the
+ * callback and asynArrayBufferRelease when it is done.
+ */
+
+#ifndef ASYNARRAYBUFFER_H
+#define ASYNARRAYBUFFER_H
+
+#include <stddef.h>
+#include <asynAPI.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+typedef struct asynArrayBuffer asynArrayBuffer;
+
+/* Returns a buffer of nBytes with one reference*/
+ASYN_API asynArrayBuffer *asynArrayBufferCreate(size_t nBytes);
+ASYN_API void *asynArrayBufferData(asynArrayBuffer *pbuf);
+ASYN_API size_t asynArrayBufferSize(asynArrayBuffer *pbuf);
+ASYN_API void asynArrayBufferReserve(asynArrayBuffer *pbuf);
+/* Frees the buffer when the last reference is released*/
+ASYN_API void asynArrayBufferRelease(asynArrayBuffer *pbuf);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+#endif  /* ASYNARRAYBUFFER_H */
@@ -82,6 +82,8 @@ typedef struct asynUser {
     int            auxStatus;     /* For auxillary status*/
     int            alarmStatus;   /* Typically for EPICS record alarm status */
     int            alarmSeverity; /* Typically for EPICS record alarm severity */
+    /* Set by the driver during array callbacks, see asynArrayBuffer.h */
+    struct asynArrayBuffer *arrayBuffer;
 }asynUser;
 
 typedef struct asynInterface{
@@ -93,6 +95,11 @@ typedef struct asynInterface{
 /*registerPort attributes*/
 #define ASYN_MULTIDEVICE  0x0001
 #define ASYN_CANBLOCK     0x0002
+/*canBlock port whose requests are processed by the shared port thread pool*/
+#define ASYN_SHAREDTHREAD 0x0004
+/*multiDevice, canBlock port whose driver can process requests for different
+ *addresses concurrently without relying on lockPort. Required by setPortWorkers*/
+#define ASYN_REENTRANT    0x0008
 
 /*standard values for asynUser.reason*/
 #define ASYN_REASON_SIGNAL -1
@@ -105,12 +112,38 @@ typedef struct asynInterface{
 typedef void (*userCallback)(asynUser *pasynUser);
 typedef void (*exceptionCallback)(asynUser *pasynUser,asynException exception);
 typedef void (*timeStampCallback)(void *userPvt, epicsTimeStamp *pTimeStamp);
+typedef asynStatus (*interruptAddrCallback)(void *userPvt, asynUser *pasynUser, int *addr);
 
 typedef struct interruptNode{
     ELLNODE node;
     void    *drvPvt;
 }interruptNode;
 
+/* Element of the per reason/addr lists returned by findInterruptUsers */
+typedef struct interruptIndexNode{
+    ELLNODE       node;
+    interruptNode *pinterruptNode;
+}interruptIndexNode;
+
+/* Latency histograms of the queued requests of a canBlock port or device.
+ * count[i] is the number of latencies less than latencyBinLimit(i) seconds
+ * and not less than latencyBinLimit(i-1). The last bin also counts all
+ * larger latencies*/
+#define ASYN_LATENCY_BINS 100
+typedef struct asynLatencyHistogram {
+    epicsUInt32 count[ASYN_LATENCY_BINS];
+    epicsUInt32 n;
+    double      sum;  /*seconds*/
+    double      max;  /*seconds*/
+}asynLatencyHistogram;
+
+typedef struct asynRequestStats {
+    asynLatencyHistogram queueWait; /*from queueRequest until the callback starts*/
+    asynLatencyHistogram callback;  /*time spent in the callback*/
+    epicsUInt32 nQueued[asynQueuePriorityConnect+1];
+    epicsUInt32 nTimeout;           /*queueRequest timeouts*/
+}asynRequestStats;
+
 typedef struct asynManager {
     void      (*report)(FILE *fp,int details,const char*portName);
     asynUser  *(*createAsynUser)(userCallback process,userCallback timeout);
@@ -183,6 +216,25 @@ typedef struct asynManager {
     asynStatus (*setTimeStamp)(asynUser *pasynUser, const epicsTimeStamp *pTimeStamp);
 
     const char *(*strStatus)(asynStatus status);
+    /* Users registered with a given reason and addr.
+     * Must be called between interruptStart and interruptEnd */
+    asynStatus (*findInterruptUsers)(void *pasynPvt,int reason,int addr,
+                                  ELLLIST **plist);
+    /* Process queued requests for different devices of a multiDevice,
+     * canBlock port concurrently with numWorkers threads */
+    asynStatus (*setPortWorkers)(const char *portName,int numWorkers);
+    /* Statistics of the device or, if not connected to a device, the port.
+     * The statistics of a port include those of all its devices */
+    asynStatus (*getRequestStats)(asynUser *pasynUser,asynRequestStats *pstats);
+    asynStatus (*resetRequestStats)(asynUser *pasynUser);
+    double     (*latencyBinLimit)(int bin);
+    /* Number of threads that process the queued requests of all ports
+     * registered with ASYN_SHAREDTHREAD. It can only be increased */
+    asynStatus (*setPortPoolThreads)(int numThreads);
+    /* Address addInterruptUser indexes the users of the port with,
+     * instead of getAddr, for drivers that compute addresses themselves */
+    asynStatus (*registerInterruptAddrSource)(asynUser *pasynUser, void *userPvt,
+                                              interruptAddrCallback callback);
 }asynManager;
 ASYN_API extern asynManager *pasynManager;
 
@@ -217,6 +269,7 @@ typedef struct  asynLockPortNotify {
 #define ASYN_TRACEIO_ASCII  0x0001
 #define ASYN_TRACEIO_ESCAPE 0x0002
 #define ASYN_TRACEIO_HEX    0x0004
+#define ASYN_TRACEIO_BINARY 0x0008 /*store the data in the binary trace file*/
 
 /* traceInfo mask definitions*/
 #define ASYN_TRACEINFO_TIME 0x0001
@@ -224,10 +277,27 @@ typedef struct  asynLockPortNotify {
 #define ASYN_TRACEINFO_SOURCE 0x0004
 #define ASYN_TRACEINFO_THREAD 0x0008
 
+/* What asynchronous trace output does when its buffer is full*/
+typedef enum {
+    asynTraceOverflowDropNew, /*discard the new message*/
+    asynTraceOverflowDropOld, /*discard the oldest messages*/
+    asynTraceOverflowBlock    /*wait up to 1 second for the writer thread*/
+}asynTraceOverflow;
+
+/* Direction of the data passed to asynPrintIORead and asynPrintIOWrite.
+ * asynPrintIO does not say, its data is asynTraceIOUnknown*/
+typedef enum {
+    asynTraceIOUnknown,
+    asynTraceIORead,   /*data read from the device*/
+    asynTraceIOWrite   /*data written to the device*/
+}asynTraceIODirection;
+
 /* asynPrint and asynPrintIO are macros that act like
    int asynPrint(asynUser *pasynUser,int reason, const char *format, ... );
    int asynPrintIO(asynUser *pasynUser,int reason,
         const char *buffer, size_t len, const char *format, ... );
+   asynPrintIORead and asynPrintIOWrite take the same arguments as
+   asynPrintIO and also record the direction of the data
 */
 typedef struct asynTrace {
     /* lock/unlock are only necessary if caller performs I/O other than */
@@ -271,6 +341,23 @@ typedef struct asynTrace {
                     const char *buffer, size_t len,const char *pformat, va_list pvar) EPICS_PRINTF_STYLE(5,0);
     int        (*vprintIOSource)(asynUser *pasynUser,int reason,
                     const char *buffer, size_t len,const char *file, int line, const char *pformat, va_list pvar) EPICS_PRINTF_STYLE(7,0);
+#endif
+    /* When enabled trace messages are formatted by the calling thread and
+     * written by a background thread */
+    asynStatus (*setTraceAsync)(int yesNo,size_t bufferSize,
+                    asynTraceOverflow overflow);
+    /* Circular file used by ports and devices with ASYN_TRACEIO_BINARY */
+    asynStatus (*setTraceBinaryFile)(asynUser *pasynUser,
+                    const char *fileName,size_t size);
+    /* printIOSource for data that is read or written, see asynPrintIORead */
+#if defined(__GNUC__) && (__GNUC__ < 3)
+    int        (*printIODirectionSource)(asynUser *pasynUser,int reason,
+                    asynTraceIODirection direction,
+                    const char *buffer, size_t len,const char *file, int line, const char *pformat, ...);
+#else
+    int        (*printIODirectionSource)(asynUser *pasynUser,int reason,
+                    asynTraceIODirection direction,
+                    const char *buffer, size_t len,const char *file, int line, const char *pformat, ...) EPICS_PRINTF_STYLE(8,9);
 #endif
 }asynTrace;
 ASYN_API extern asynTrace *pasynTrace;
@@ -303,6 +390,30 @@ ASYN_API extern asynTrace *pasynTrace;
 #define asynPrintIO pasynTrace->printIO
 #endif
 
+#if (defined(__STDC_VERSION__) && __STDC_VERSION__>=199901L) || defined(_WIN32)
+#define asynPrintIORead(pasynUser,reason,buffer,len, ...) \
+   ((pasynTrace->getTraceMask((pasynUser))&(reason)) \
+    ? pasynTrace->printIODirectionSource((pasynUser),(reason),asynTraceIORead,(buffer),(len),__FILE__,__LINE__,__VA_ARGS__) \
+    : 0)
+#define asynPrintIOWrite(pasynUser,reason,buffer,len, ...) \
+   ((pasynTrace->getTraceMask((pasynUser))&(reason)) \
+    ? pasynTrace->printIODirectionSource((pasynUser),(reason),asynTraceIOWrite,(buffer),(len),__FILE__,__LINE__,__VA_ARGS__) \
+    : 0)
+#elif defined(__GNUC__)
+#define asynPrintIORead(pasynUser,reason,buffer,len,format...) \
+   ((pasynTrace->getTraceMask((pasynUser))&(reason)) \
+    ? pasynTrace->printIODirectionSource((pasynUser),(reason),asynTraceIORead,(buffer),(len),__FILE__,__LINE__,format) \
+    : 0)
+#define asynPrintIOWrite(pasynUser,reason,buffer,len,format...) \
+   ((pasynTrace->getTraceMask((pasynUser))&(reason)) \
+    ? pasynTrace->printIODirectionSource((pasynUser),(reason),asynTraceIOWrite,(buffer),(len),__FILE__,__LINE__,format) \
+    : 0)
+#else
+/* Without variadic macros the direction is not recorded */
+#define asynPrintIORead pasynTrace->printIO
+#define asynPrintIOWrite pasynTrace->printIO
+#endif
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
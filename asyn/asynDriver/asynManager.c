@@ -32,6 +32,13 @@
 
 #include <epicsExport.h>
 #include "asynDriver.h"
+#include "asynTraceBinary.h"
+
+#if LT_EPICSBASE(3,15,0,1)
+#define TRACE_USE_MUTEX
+#else
+#include <epicsAtomic.h>
+#endif
 
 #define BOOL int
 #ifndef TRUE
@@ -44,9 +51,13 @@
 #define NUMBER_QUEUE_PRIORITIES (asynQueuePriorityConnect + 1)
 #define DEFAULT_TRACE_TRUNCATE_SIZE 80
 #define DEFAULT_TRACE_BUFFER_SIZE 80
+#define DEFAULT_TRACE_ASYNC_BUFFER_SIZE 65536
+#define DEFAULT_TRACE_BINARY_SIZE 16000000
+#define TRACE_BINARY_MESSAGE_SIZE 256
 #define DEFAULT_SECONDS_BETWEEN_PORT_CONNECT 20
 #define DEFAULT_AUTOCONNECT_TIMEOUT 0.5
 #define DEFAULT_QUEUE_LOCK_PORT_TIMEOUT 2.0
+#define DEFAULT_PORT_POOL_THREADS 4
 
 /* This is taken from dbDefs.h, which we don't want to include */
 /* Subtract member byte offset, returning pointer to parent object */
@@ -71,6 +82,56 @@ typedef enum {
     traceFileErrlog,traceFileStdout,traceFileStderr,traceFileFP
 }traceFileType;
 
+/*
+ * Asynchronous trace: a thread formats its messages into one of
+ * NUMBER_TRACE_RINGS circular buffers, selected by its thread id, and
+ * traceWriterThread writes them to the trace files.
+ * Messages longer than TRACE_MESSAGE_SIZE are truncated.
+ */
+#define NUMBER_TRACE_RINGS 8
+#define TRACE_MESSAGE_SIZE 4096
+#define TRACE_BLOCK_TIMEOUT 1.0
+
+/* Destination of trace output. Text is written to fp, to errlog if fp is 0,
+ * or is appended to buffer if it is not 0*/
+typedef struct traceOutput {
+    FILE   *fp;
+    char   *buffer;
+    size_t size;
+    size_t len;
+}traceOutput;
+
+/* Each message is queued as a traceRecord followed by len characters*/
+typedef struct traceRecord {
+    FILE   *fp;
+    size_t len;
+}traceRecord;
+
+typedef struct traceRing {
+    epicsMutexId  formatLock; /*held while message is formatted and queued*/
+    epicsMutexId  lock;       /*for buffer,head,tail,used and counters*/
+    epicsEventId  spaceAvailable;
+    char          *buffer;
+    size_t        size;
+    size_t        head;
+    size_t        tail;
+    size_t        used;
+    size_t        highWater;
+    unsigned long nMessages;
+    unsigned long nDropped;
+    char          message[TRACE_MESSAGE_SIZE];
+}traceRing;
+
+typedef struct traceAsync {
+    int               enabled; /*read by traceBegin without a lock*/
+    asynTraceOverflow overflow;
+    size_t            bufferSize;
+    traceRing         *ring; /*allocated when first enabled*/
+    epicsEventId      notify;
+    unsigned long     nDroppedReported;
+    char              message[TRACE_MESSAGE_SIZE+1]; /*for traceWriterThread*/
+}traceAsync;
+
 struct tracePvt {
     int           traceMask;
     int           traceIOMask;
@@ -95,6 +156,39 @@ typedef struct memNode {
  */
 #define NODESIZE (((sizeof(memNode)+15)/16)*16)
 
+/*
+ * Free memNodes and asynUsers are kept in NUMBER_MEM_CACHES caches, each with
+ * its own lock, in front of the lists in asynBase. A thread uses the cache
+ * selected by its thread id so that threads seldom contend for a lock.
+ * Half of a cache is moved to or from asynBase when it is full or empty.
+ */
+#define NUMBER_MEM_CACHES 16
+#define MEM_CACHE_SIZE 32
+typedef struct cacheStats {
+    unsigned long hits;   /*taken from the cache*/
+    unsigned long misses; /*taken from asynBase or allocated*/
+    unsigned long nAlloc;
+    unsigned long nFree;
+}cacheStats;
+typedef struct memCache {
+    epicsMutexId lock;
+    ELLLIST    memList[nMemList];
+    ELLLIST    asynUserFreeList;
+    cacheStats memStats[nMemList];
+    cacheStats userStats;
+    double     largeAlloc; /*bytes allocated by malloc*/
+    double     largeFree;
+}memCache;
+
+/* Threads shared by the canBlock ports registered with ASYN_SHAREDTHREAD */
+typedef struct portPool {
+    epicsMutexId      lock;
+    epicsEventId      notify;
+    ELLLIST           readyList; /*ports with requests to process*/
+    int               numThreads;
+    int               numPorts;
+}portPool;
+
 typedef struct asynBase {
     ELLLIST           asynPortList;
     ELLLIST           asynUserFreeList;
@@ -102,14 +196,28 @@ typedef struct asynBase {
     epicsTimerQueueId timerQueue;
     epicsMutexId      lock;
     epicsMutexId      lockTrace;
+    traceAsync        traceAsync;
+    asynTraceBinaryFile *traceBinaryFile; /*for ports without their own*/
     tracePvt          trace;
     ELLLIST           memList[nMemList];
+    memCache          memCache[NUMBER_MEM_CACHES];
     /* following for connectPort */
     epicsTimerQueueId connectPortTimerQueue;
     double            autoConnectTimeout;
+    portPool          portPool;
 }asynBase;
 static asynBase *pasynBase = 0;
 
+/* Users of an interrupt source with the same reason and addr */
+typedef struct interruptIndexKey {
+    ELLNODE      node;     /*For interruptBase.indexTable[]*/
+    int          reason;
+    int          addr;
+    ELLLIST      userList; /*list of interruptIndexNode*/
+}interruptIndexKey;
+
+#define INTERRUPT_INDEX_INITIAL_SIZE 64
+
 typedef struct interruptBase {
     ELLLIST      callbackList;
     ELLLIST      addRemoveList;
@@ -117,6 +225,11 @@ typedef struct interruptBase {
     BOOL         listModified;
     port         *pport;
     asynInterface *pasynInterface;
+    /* hash table of interruptIndexKey, size is a power of 2 */
+    ELLLIST      *indexTable;
+    int          indexTableSize;
+    int          indexNumKeys;
+    ELLLIST      indexEmptyList;
 }interruptBase;
 
 typedef struct interruptNodePvt {
@@ -125,6 +238,8 @@ typedef struct interruptNodePvt {
     BOOL     isOnAddRemoveList;
     epicsEventId  callbackDone;
     interruptBase *pinterruptBase;
+    interruptIndexKey  *pindexKey;
+    interruptIndexNode indexNode;
     interruptNode nodePublic;
 }interruptNodePvt;
 
@@ -134,6 +249,15 @@ typedef struct interfaceNode {
     interruptBase *pinterruptBase;
 }interfaceNode;
 
+/* Links a dpCommon into port.readyList when the request at the head of its
+ * queueList for that priority can be started*/
+typedef struct readyNode {
+    ELLNODE         node;
+    struct dpCommon *pdpCommon;
+    BOOL            isReady;
+    struct userPvt  *pfirst; /*the request readyList is ordered by*/
+}readyNode;
+
 typedef struct dpCommon { /*device/port common fields*/
     BOOL           enabled;
     BOOL           connected;
@@ -149,6 +273,11 @@ typedef struct dpCommon { /*device/port common fields*/
     tracePvt       trace;
     port           *pport;
     device         *pdevice; /* 0 if port.dpc*/
+    /*The following are only used if port attributes&ASYN_CANBLOCK*/
+    ELLLIST        queueList[NUMBER_QUEUE_PRIORITIES];
+    readyNode      ready[NUMBER_QUEUE_PRIORITIES];
+    BOOL           active; /*a port worker is processing one of its requests*/
+    asynRequestStats stats;
 }dpCommon;
 
 typedef struct exceptionUser {
@@ -161,7 +290,7 @@ typedef struct exceptionUser {
 
 typedef enum {callbackIdle,callbackActive,callbackCanceled}callbackState;
 struct userPvt {
-    ELLNODE       node;        /*For asynPort.queueList*/
+    ELLNODE       node;        /*For dpCommon.queueList*/
     /* timer,...,state are for queueRequest callbacks*/
     epicsTimerId  timer;
     epicsEventId  callbackDone;
@@ -177,6 +306,9 @@ struct userPvt {
     exceptionUser *pexceptionUser;
     BOOL          freeAfterCallback;
     BOOL          isQueued;
+    asynQueuePriority priority; /*of the queueList while isQueued*/
+    epicsTimeStamp queueTime;   /*when queueRequest was called*/
+    unsigned long sequence;     /*order of queueRequest calls on the port*/
     asynUser      user;
 };
 
@@ -210,11 +342,27 @@ struct port {
     asynLockPortNotify *pasynLockPortNotify;
     void          *lockPortNotifyPvt;
     /*The following are only initialized/used if attributes&ASYN_CANBLOCK*/
-    ELLLIST       queueList[NUMBER_QUEUE_PRIORITIES];
+    /* dpCommons with a request that can be started, oldest request first.
+     * Connect requests are all queued in order on
+     * dpc.queueList[asynQueuePriorityConnect]*/
+    ELLLIST       readyList[NUMBER_QUEUE_PRIORITIES];
+    unsigned long queueSequence; /*next userPvt.sequence*/
+    unsigned long frontSequence; /*next userPvt.sequence of a lockHolder*/
     BOOL          queueStateChange;
     epicsEventId  notifyPortThread;
     epicsThreadId threadid;
     userPvt       *pblockProcessHolder;
+    /* The following are for multiple port worker threads. See setPortWorkers*/
+    int           numWorkers;
+    int           numActive;
+    BOOL          exclusiveActive;
+    unsigned int  threadPriority;
+    unsigned int  threadStackSize;
+    /* The following are for ASYN_SHAREDTHREAD. See notifyPort*/
+    ELLNODE       poolNode; /*For portPool.readyList*/
+    BOOL          poolQueued;
+    BOOL          poolActive;
+    BOOL          poolNotify;
     /* following are for portConnect */
     asynUser      *pconnectUser;
     asynInterface *pcommonInterface;
@@ -225,6 +373,11 @@ struct port {
     epicsTimeStamp timeStamp;
     timeStampCallback timeStampSource;
     void          *timeStampPvt;
+    /* The address interrupt users are indexed with, see addInterruptUser */
+    interruptAddrCallback interruptAddrSource;
+    void          *interruptAddrPvt;
+    /* Created by the first setTraceBinaryFile for the port*/
+    asynTraceBinaryFile *traceBinaryFile;
 };
 
 typedef struct queueLockPortPvt {
@@ -240,6 +393,7 @@ typedef struct queueLockPortPvt {
 #define asynUserToUserPvt(p) \
   ((userPvt *) ((char *)(p) \
           - ( (char *)&(((userPvt *)0)->user) - (char *)0 ) ) )
+#define poolNodeToPort(p) CONTAINER(p, port, poolNode)
 #define  notifyNodeToExceptionUser(p) \
   ((exceptionUser *) ((char *)(p) \
           - ( (char *)&(((exceptionUser *)0)->notifyNode) - (char *)0 ) ) )
@@ -261,7 +415,21 @@ static void queueTimeoutCallback(void *pvt);
 /*autoConnectDevice must be called with asynManagerLock held*/
 static BOOL autoConnectDevice(port *pport,device *pdevice);
 static void connectAttempt(dpCommon *pdpCommon);
+static void traceFlushAsync(void);
+static void reportTraceAsync(FILE *fp);
+static size_t threadHash(void);
+static memCache *getMemCache(void);
+static void freeUserPvt(userPvt *puserPvt);
+/* functions for request statistics, called with asynManagerLock held*/
+static void addLatency(asynLatencyHistogram *phist,double seconds);
+static void recordLatency(port *pport,dpCommon *pdpCommon,BOOL isQueueWait,
+    const epicsTimeStamp *pstart,const epicsTimeStamp *pend);
+static void recordRequestCount(userPvt *puserPvt,BOOL isTimeout);
+static void notifyPort(port *pport);
+static void processPortQueue(port *pport);
 static void portThread(port *pport);
+static void portPoolThread(void *arg);
+static int startPortPoolThreads(int numThreads);
 /* functions for portConnect */
 static void initPortConnect(port *ppport);
 static void portConnectTimerCallback(void *pvt);
@@ -326,6 +494,15 @@ static asynStatus removeInterruptUser(asynUser *pasynUser,
                                    interruptNode*pinterruptNode);
 static asynStatus interruptStart(void *pasynPvt,ELLLIST **plist);
 static asynStatus interruptEnd(void *pasynPvt);
+static asynStatus findInterruptUsers(void *pasynPvt,int reason,int addr,
+    ELLLIST **plist);
+static asynStatus registerInterruptAddrSource(asynUser *pasynUser,
+    void *userPvt, interruptAddrCallback callback);
+static asynStatus setPortWorkers(const char *portName,int numWorkers);
+static asynStatus setPortPoolThreads(int numThreads);
+static asynStatus getRequestStats(asynUser *pasynUser,asynRequestStats *pstats);
+static asynStatus resetRequestStats(asynUser *pasynUser);
+static double latencyBinLimit(int bin);
 static void defaultTimeStampSource(void *userPvt, epicsTimeStamp *pTimeStamp);
 static asynStatus registerTimeStampSource(asynUser *pasynUser, void *userPvt, timeStampCallback callback);
 static asynStatus unregisterTimeStampSource(asynUser *pasynUser);
@@ -384,7 +561,14 @@ static asynManager manager = {
     updateTimeStamp,
     getTimeStamp,
     setTimeStamp,
-    strStatus
+    strStatus,
+    findInterruptUsers,
+    setPortWorkers,
+    getRequestStats,
+    resetRequestStats,
+    latencyBinLimit,
+    setPortPoolThreads,
+    registerInterruptAddrSource
 };
 asynManager *pasynManager = &manager;
 
@@ -399,6 +583,10 @@ static asynStatus setTraceInfoMask(asynUser *pasynUser,int mask);
 static int        getTraceInfoMask(asynUser *pasynUser);
 static asynStatus setTraceFile(asynUser *pasynUser,FILE *fp);
 static FILE       *getTraceFile(asynUser *pasynUser);
+static asynStatus setTraceAsync(int yesNo,size_t bufferSize,
+    asynTraceOverflow overflow);
+static asynStatus setTraceBinaryFile(asynUser *pasynUser,
+    const char *fileName,size_t size);
 static asynStatus setTraceIOTruncateSize(asynUser *pasynUser,size_t size);
 static size_t     getTraceIOTruncateSize(asynUser *pasynUser);
 static int        tracePrint(asynUser *pasynUser,
@@ -417,6 +605,12 @@ static int        traceVprintIO(asynUser *pasynUser,int reason,
                       const char *buffer, size_t len,const char *pformat, va_list pvar);
 static int        traceVprintIOSource(asynUser *pasynUser,int reason,
                       const char *buffer, size_t len, const char *file, int line, const char *pformat, va_list pvar);
+static int        traceVprintIODirection(asynUser *pasynUser,int reason,
+                      asynTraceIODirection direction,
+                      const char *buffer, size_t len, const char *file, int line, const char *pformat, va_list pvar);
+static int        tracePrintIODirectionSource(asynUser *pasynUser,int reason,
+                      asynTraceIODirection direction,
+                      const char *buffer, size_t len, const char *file, int line, const char *pformat, ...);
 static asynTrace asynTraceManager = {
     traceLock,
     traceUnlock,
@@ -437,7 +631,10 @@ static asynTrace asynTraceManager = {
     tracePrintIO,
     tracePrintIOSource,
     traceVprintIO,
-    traceVprintIOSource
+    traceVprintIOSource,
+    setTraceAsync,
+    setTraceBinaryFile,
+    tracePrintIODirectionSource
 };
 asynTrace *pasynTrace = &asynTraceManager;
 
@@ -494,11 +691,23 @@ static void asynInitOnceImpl(void* arg)
         1,epicsThreadPriorityScanLow);
     pasynBase->lock = epicsMutexMustCreate();
     pasynBase->lockTrace = epicsMutexMustCreate();
+    pasynBase->traceBinaryFile = asynTraceBinaryCreate();
     tracePvtInit(&pasynBase->trace);
     for(i=0; i<nMemList; i++) ellInit(&pasynBase->memList[i]);
+    for(i=0; i<NUMBER_MEM_CACHES; i++) {
+        memCache *pcache = &pasynBase->memCache[i];
+        int      j;
+
+        pcache->lock = epicsMutexMustCreate();
+        for(j=0; j<nMemList; j++) ellInit(&pcache->memList[j]);
+        ellInit(&pcache->asynUserFreeList);
+    }
     pasynBase->connectPortTimerQueue = epicsTimerQueueAllocate(
         0,epicsThreadPriorityScanLow);
     pasynBase->autoConnectTimeout = DEFAULT_AUTOCONNECT_TIMEOUT;
+    pasynBase->portPool.lock = epicsMutexMustCreate();
+    pasynBase->portPool.notify = epicsEventMustCreate(epicsEventEmpty);
+    ellInit(&pasynBase->portPool.readyList);
 }
 
 static epicsThreadOnceId asynInitOnce = EPICS_THREAD_ONCE_INIT;
@@ -511,6 +720,7 @@ static void asynInit(void)
 static void dpCommonInit(port *pport,device *pdevice,BOOL autoConnect)
 {
     dpCommon *pdpCommon;
+    int      i;
 
     if(pdevice) {
         pdpCommon = &pdevice->dpc;
@@ -525,6 +735,10 @@ static void dpCommonInit(port *pport,device *pdevice,BOOL autoConnect)
     ellInit(&pdpCommon->exceptionNotifyList);
     pdpCommon->pport = pport;
     pdpCommon->pdevice = pdevice;
+    for(i=0; i<NUMBER_QUEUE_PRIORITIES; i++) {
+        ellInit(&pdpCommon->queueList[i]);
+        pdpCommon->ready[i].pdpCommon = pdpCommon;
+    }
     tracePvtInit(&pdpCommon->trace);
 }
 
@@ -546,6 +760,119 @@ static dpCommon *findDpCommon(userPvt *puserPvt)
     return(&pdevice->dpc);
 }
 
+/*Connect requests for all devices are kept in order on the port*/
+static ELLLIST *findQueueList(userPvt *puserPvt,int priority)
+{
+    if(priority==asynQueuePriorityConnect)
+        return(&puserPvt->pport->dpc.queueList[asynQueuePriorityConnect]);
+    return(&findDpCommon(puserPvt)->queueList[priority]);
+}
+
+/* Latency bins have 4 sub bins for each power of 2 microseconds*/
+static void addLatency(asynLatencyHistogram *phist,double seconds)
+{
+    double      usec = seconds*1e6;
+    epicsUInt32 value;
+    int         bin, exponent;
+
+    if(seconds<0.0) seconds = usec = 0.0;
+    if(usec>=4294967295.0) {
+        bin = ASYN_LATENCY_BINS - 1;
+    } else {
+        value = (epicsUInt32)usec;
+        if(value<4) {
+            bin = (int)value;
+        } else {
+            for(exponent=2; (value>>(exponent+1))!=0; exponent++) ;
+            bin = 4*(exponent-1) + (int)((value>>(exponent-2))&3);
+        }
+        if(bin>=ASYN_LATENCY_BINS) bin = ASYN_LATENCY_BINS - 1;
+    }
+    phist->count[bin]++;
+    phist->n++;
+    phist->sum += seconds;
+    if(seconds>phist->max) phist->max = seconds;
+}
+
+static double latencyBinLimit(int bin)
+{
+    if(bin<0) return 0.0;
+    if(bin>=ASYN_LATENCY_BINS) bin = ASYN_LATENCY_BINS - 1;
+    if(bin<4) return (bin + 1)*1e-6;
+    return (double)((epicsUInt32)(5 + bin%4)<<(bin/4 - 1))*1e-6;
+}
+
+/* Statistics go to the port and, for a multiDevice port, the device.
+ * The port and device are passed by the caller because the asynUser
+ * may be disconnected by another thread while its callback runs*/
+static void recordLatency(port *pport,dpCommon *pdpCommon,BOOL isQueueWait,
+    const epicsTimeStamp *pstart,const epicsTimeStamp *pend)
+{
+    double   seconds = epicsTimeDiffInSeconds(pend,pstart);
+
+    addLatency(isQueueWait ? &pport->dpc.stats.queueWait
+                           : &pport->dpc.stats.callback,seconds);
+    if(pdpCommon!=&pport->dpc)
+        addLatency(isQueueWait ? &pdpCommon->stats.queueWait
+                               : &pdpCommon->stats.callback,seconds);
+}
+
+static void recordRequestCount(userPvt *puserPvt,BOOL isTimeout)
+{
+    port     *pport = puserPvt->pport;
+    dpCommon *pdpCommon = findDpCommon(puserPvt);
+
+    if(isTimeout) {
+        pport->dpc.stats.nTimeout++;
+        if(pdpCommon!=&pport->dpc) pdpCommon->stats.nTimeout++;
+    } else {
+        pport->dpc.stats.nQueued[puserPvt->priority]++;
+        if(pdpCommon!=&pport->dpc) pdpCommon->stats.nQueued[puserPvt->priority]++;
+    }
+}
+
+/* Add pdpCommon to or remove it from port.readyList[priority].
+ * readyList is ordered by the sequence of the first request of each dpCommon,
+ * so the oldest request that can be started is at its head. A request older
+ * than the head, e.g. a lockHolder, goes first. Otherwise the list is searched
+ * from the end, where a newly queued request, the newest, is added at once.
+ * Must be called with asynManagerLock held whenever the head of its queueList,
+ * enabled, active or pblockProcessHolder change*/
+static void updateReady(dpCommon *pdpCommon,int priority)
+{
+    ELLLIST   *preadyList = &pdpCommon->pport->readyList[priority];
+    readyNode *pready = &pdpCommon->ready[priority];
+    readyNode *pprev;
+    userPvt   *pfirst = (userPvt *)ellFirst(&pdpCommon->queueList[priority]);
+    BOOL      isReady;
+
+    isReady = (pfirst && pdpCommon->enabled && !pdpCommon->active
+        && (!pdpCommon->pblockProcessHolder
+            || pdpCommon->pblockProcessHolder==pfirst));
+    if(isReady==pready->isReady && (!isReady || pfirst==pready->pfirst)) return;
+    if(pready->isReady) ellDelete(preadyList,&pready->node);
+    pready->isReady = isReady;
+    pready->pfirst = isReady ? pfirst : 0;
+    if(!isReady) return;
+    pprev = (readyNode *)ellFirst(preadyList);
+    if(pprev && (long)(pfirst->sequence - pprev->pfirst->sequence) > 0) {
+        pprev = (readyNode *)ellLast(preadyList);
+        while((long)(pfirst->sequence - pprev->pfirst->sequence) < 0)
+            pprev = (readyNode *)ellPrevious(&pprev->node);
+        ellInsert(preadyList,&pprev->node,&pready->node);
+    } else {
+        ellInsert(preadyList,0,&pready->node);
+    }
+}
+
+static void updateReadyAll(dpCommon *pdpCommon)
+{
+    int i;
+
+    for(i=asynQueuePriorityLow; i<=asynQueuePriorityHigh; i++)
+        updateReady(pdpCommon,i);
+}
+
 static tracePvt *findTracePvt(userPvt *puserPvt)
 {
 	dpCommon *pdpCommon;
@@ -638,7 +965,7 @@ static void announceExceptionOccurred(port *pport, device *pdevice, asynExceptio
     pport->queueStateChange = TRUE;
     epicsMutexUnlock(pport->asynManagerLock);
     if(pport->attributes&ASYN_CANBLOCK)
-        epicsEventSignal(pport->notifyPortThread);
+        notifyPort(pport);
 }
 static void exceptionOccurred(asynUser *pasynUser,asynException exception)
 {
@@ -654,7 +981,6 @@ static void queueTimeoutCallback(void *pvt)
     userPvt  *puserPvt = (userPvt *)pvt;
     asynUser *pasynUser = &puserPvt->user;
     port     *pport = puserPvt->pport;
-    int      i;
 
     epicsMutexMustLock(pport->asynManagerLock);
     if(!puserPvt->isQueued) {
@@ -664,26 +990,12 @@ static void queueTimeoutCallback(void *pvt)
             pport->portName );
         return;
     }
-    for(i=asynQueuePriorityConnect; i>=asynQueuePriorityLow; i--) {
-        puserPvt = (userPvt *)ellFirst(&pport->queueList[i]);
-        while(puserPvt) {
-            if(pasynUser == &puserPvt->user) {
-                ellDelete(&pport->queueList[i],&puserPvt->node);
-                break;
-            }
-            puserPvt = (userPvt *)ellNext(&puserPvt->node);
-        }
-        if (puserPvt) break;
-    }
-    if(!puserPvt) {
-        epicsMutexUnlock(pport->asynManagerLock);
-        asynPrint(pasynUser,ASYN_TRACE_ERROR,
-            "%s asynManager:queueTimeoutCallback LOGIC ERROR\n",
-            pport->portName);
-        return;
-    }
+    ellDelete(findQueueList(puserPvt,puserPvt->priority),&puserPvt->node);
+    if(puserPvt->priority!=asynQueuePriorityConnect)
+        updateReady(findDpCommon(puserPvt),puserPvt->priority);
     asynPrint(pasynUser,ASYN_TRACE_FLOW,
         "%s asynManager:queueTimeoutCallback\n", pport->portName);
+    recordRequestCount(puserPvt,TRUE);
     puserPvt->isQueued = FALSE;
     pport->queueStateChange = TRUE;
     if(puserPvt->timeoutUser) {
@@ -696,13 +1008,11 @@ static void queueTimeoutCallback(void *pvt)
         puserPvt->state = callbackIdle;
         if(puserPvt->freeAfterCallback) {
             puserPvt->freeAfterCallback = FALSE;
-            epicsMutexMustLock(pasynBase->lock);
-            ellAdd(&pasynBase->asynUserFreeList,&puserPvt->node);
-            epicsMutexUnlock(pasynBase->lock);
+            freeUserPvt(puserPvt);
         }
     }
     epicsMutexUnlock(pport->asynManagerLock);
-    epicsEventSignal(pport->notifyPortThread);
+    notifyPort(pport);
 }
 
 /*autoConnectDevice must be called with asynManagerLock held*/
@@ -797,157 +1107,305 @@ disconnect:
     }
 }
 
-static void portThread(port *pport)
+/* A request must run with no other worker active if it is queued on the
+ * port itself rather than on a device or its user blocks all devices.
+ * Must be called with asynManagerLock held*/
+static BOOL isExclusiveRequest(userPvt *puserPvt)
+{
+    return (!findDpCommon(puserPvt)->pdevice || puserPvt->blockPortCount>0);
+}
+
+/* Next request that can be started. readyList is ordered by the requests
+ * at the head of its dpCommons, so requests with the same priority start in
+ * the order they were queued, as with a single queue.
+ * Must be called with asynManagerLock held*/
+static userPvt *findReadyRequest(port *pport,int *ppriority)
+{
+    userPvt   *pholder = pport->pblockProcessHolder;
+    readyNode *pready;
+    int       i;
+
+    if(pholder) {
+        dpCommon *pdpCommon = findDpCommon(pholder);
+
+        /*Only the holder may run and it queues at the front*/
+        i = pholder->priority;
+        if(!pholder->isQueued || i==asynQueuePriorityConnect
+        || !pdpCommon->ready[i].isReady
+        || (userPvt *)ellFirst(&pdpCommon->queueList[i])!=pholder) return 0;
+        *ppriority = i;
+        return pholder;
+    }
+    for(i=asynQueuePriorityHigh; i>=asynQueuePriorityLow; i--) {
+        pready = (readyNode *)ellFirst(&pport->readyList[i]);
+        if(pready) {
+            *ppriority = i;
+            return pready->pfirst;
+        }
+    }
+    return 0;
+}
+
+/*Wake the thread that processes the queued requests of the port*/
+static void notifyPort(port *pport)
+{
+    portPool *ppool = &pasynBase->portPool;
+
+    if(!(pport->attributes&ASYN_SHAREDTHREAD)) {
+        epicsEventSignal(pport->notifyPortThread);
+        return;
+    }
+    /*Only one pool thread at a time processes the requests of a port.
+     *If one is active it runs processPortQueue again when it is done*/
+    epicsMutexMustLock(ppool->lock);
+    if(pport->poolActive) {
+        pport->poolNotify = TRUE;
+    } else if(!pport->poolQueued) {
+        pport->poolQueued = TRUE;
+        ellAdd(&ppool->readyList,&pport->poolNode);
+        epicsEventSignal(ppool->notify);
+    }
+    epicsMutexUnlock(ppool->lock);
+}
+
+static void processPortQueue(port *pport)
 {
     userPvt  *puserPvt;
     asynUser *pasynUser;
     double   timeout;
     BOOL     callTimeoutUser = FALSE;
+    ELLLIST  *pconnectList = &pport->dpc.queueList[asynQueuePriorityConnect];
+    epicsTimeStamp startTime, endTime;
 
-    taskwdInsert(epicsThreadGetIdSelf(),0,0);
-    while(1) {
-        epicsEventMustWait(pport->notifyPortThread);
+    epicsMutexMustLock(pport->asynManagerLock);
+    if(!pport->dpc.enabled) {
+        epicsMutexUnlock(pport->asynManagerLock);
+        return;
+    }
+    /*Process ALL connect/disconnect requests first*/
+    /*With multiple workers wait until no other worker is active*/
+    while(pport->numActive==0
+    && (puserPvt = (userPvt *)ellFirst(pconnectList))) {
+        asynStatus status = asynSuccess;
+        dpCommon   *pdpCommon = findDpCommon(puserPvt);
+
+        assert(puserPvt->isQueued);
+        ellDelete(pconnectList,&puserPvt->node);
+        puserPvt->isQueued = FALSE;
+        pport->queueStateChange = TRUE;
+        pport->numActive++;
+        pport->exclusiveActive = TRUE;
+        pasynUser = userPvtToAsynUser(puserPvt);
+        pasynUser->errorMessage[0] = '\0';
+        asynPrint(pasynUser,ASYN_TRACE_FLOW,
+            "asynManager connect queueCallback port:%s\n",
+             pport->portName);
+        epicsTimeGetCurrent(&startTime);
+        recordLatency(pport,pdpCommon,TRUE,&puserPvt->queueTime,&startTime);
+        puserPvt->state = callbackActive;
+        timeout = puserPvt->timeout;
+        epicsMutexUnlock(pport->asynManagerLock);
+        if(puserPvt->timer && timeout>0.0) epicsTimerCancel(puserPvt->timer);
+        epicsMutexMustLock(pport->synchronousLock);
+        if(pport->pasynLockPortNotify) {
+            status = pport->pasynLockPortNotify->lock(
+               pport->lockPortNotifyPvt,pasynUser);
+            if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
+                    "%s queueCallback pasynLockPortNotify:lock error %s\n",
+                     pport->portName,pasynUser->errorMessage);
+        }
+        puserPvt->processUser(pasynUser);
+        if(pport->pasynLockPortNotify) {
+            status = pport->pasynLockPortNotify->unlock(
+               pport->lockPortNotifyPvt,pasynUser);
+            if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
+                    "%s queueCallback pasynLockPortNotify:lock error %s\n",
+                     pport->portName,pasynUser->errorMessage);
+        }
+        epicsMutexUnlock(pport->synchronousLock);
+        epicsTimeGetCurrent(&endTime);
         epicsMutexMustLock(pport->asynManagerLock);
-        if(!pport->dpc.enabled) {
-            epicsMutexUnlock(pport->asynManagerLock);
-            continue;
+        recordLatency(pport,pdpCommon,FALSE,&startTime,&endTime);
+        pport->numActive--;
+        pport->exclusiveActive = FALSE;
+        if (puserPvt->state==callbackCanceled)
+            epicsEventSignal(puserPvt->callbackDone);
+        puserPvt->state = callbackIdle;
+        if(puserPvt->freeAfterCallback) {
+            puserPvt->freeAfterCallback = FALSE;
+            freeUserPvt(puserPvt);
         }
-        /*Process ALL connect/disconnect requests first*/
-        while((puserPvt = (userPvt *)ellFirst(
-        &pport->queueList[asynQueuePriorityConnect]))) {
-            asynStatus status = asynSuccess;
-
-            assert(puserPvt->isQueued);
-            ellDelete(&pport->queueList[asynQueuePriorityConnect],
-               &puserPvt->node);
-            puserPvt->isQueued = FALSE;
-            pasynUser = userPvtToAsynUser(puserPvt);
-            pasynUser->errorMessage[0] = '\0';
-            asynPrint(pasynUser,ASYN_TRACE_FLOW,
-                "asynManager connect queueCallback port:%s\n",
-                 pport->portName);
-            puserPvt->state = callbackActive;
-            timeout = puserPvt->timeout;
+    }
+    if(!pport->dpc.connected) {
+        if(!autoConnectDevice(pport,0)) {
             epicsMutexUnlock(pport->asynManagerLock);
-            if(puserPvt->timer && timeout>0.0) epicsTimerCancel(puserPvt->timer);
-            epicsMutexMustLock(pport->synchronousLock);
-            if(pport->pasynLockPortNotify) {
-                status = pport->pasynLockPortNotify->lock(
-                   pport->lockPortNotifyPvt,pasynUser);
-                if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
-                        "%s queueCallback pasynLockPortNotify:lock error %s\n",
-                         pport->portName,pasynUser->errorMessage);
-            }
-            puserPvt->processUser(pasynUser);
-            if(pport->pasynLockPortNotify) {
-                status = pport->pasynLockPortNotify->unlock(
-                   pport->lockPortNotifyPvt,pasynUser);
-                if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
-                        "%s queueCallback pasynLockPortNotify:lock error %s\n",
-                         pport->portName,pasynUser->errorMessage);
-            }
-            epicsMutexUnlock(pport->synchronousLock);
-            epicsMutexMustLock(pport->asynManagerLock);
-            if (puserPvt->state==callbackCanceled)
-                epicsEventSignal(puserPvt->callbackDone);
-            puserPvt->state = callbackIdle;
-            if(puserPvt->freeAfterCallback) {
-                puserPvt->freeAfterCallback = FALSE;
-                epicsMutexMustLock(pasynBase->lock);
-                ellAdd(&pasynBase->asynUserFreeList,&puserPvt->node);
-                epicsMutexUnlock(pasynBase->lock);
-            }
+            return;
         }
-        if(!pport->dpc.connected) {
-            if(!autoConnectDevice(pport,0)) {
-                epicsMutexUnlock(pport->asynManagerLock);
-                continue; /*while (1); */
-            }
+    }
+    while(1) {
+        int i;
+        dpCommon *pdpCommon = 0;
+        asynStatus status = asynSuccess;
+        BOOL     exclusive = FALSE;
+        BOOL     useSynchronousLock;
+
+        callTimeoutUser = FALSE;
+        pport->queueStateChange = FALSE;
+        /*Another worker is running an exclusive request or
+         *connect requests are waiting for active workers to finish*/
+        if(pport->exclusiveActive || ellCount(pconnectList)>0) break;
+        puserPvt = findReadyRequest(pport,&i);
+        if(!puserPvt) break; /*while(1)*/
+        pdpCommon = findDpCommon(puserPvt);
+        assert(pdpCommon);
+        exclusive = isExclusiveRequest(puserPvt);
+        /*Nothing may start until the exclusive request has run*/
+        if(exclusive && pport->numActive>0) break; /*while(1)*/
+        if(!pdpCommon->connected) {
+            autoConnectDevice(pdpCommon->pport,
+                pdpCommon->pdevice);
+            if(pport->queueStateChange) break; /*while(1)*/
         }
-        while(1) {
-            int i;
-            dpCommon *pdpCommon = 0;
-            asynStatus status = asynSuccess;
-
-            callTimeoutUser = FALSE;
-            pport->queueStateChange = FALSE;
+        if(!pdpCommon->connected && puserPvt->timeoutUser!=0) {
+           callTimeoutUser = TRUE;
+        }
+        assert(puserPvt->isQueued);
+        ellDelete(&pdpCommon->queueList[i],&puserPvt->node);
+        puserPvt->isQueued = FALSE;
+        /*Requests for a device are processed in order by one worker at a
+         *time. It is added back to the end of readyList when done*/
+        pdpCommon->active = TRUE;
+        updateReadyAll(pdpCommon);
+        pport->numActive++;
+        if(exclusive) pport->exclusiveActive = TRUE;
+        /*Device requests on a port with several workers run
+         *concurrently so they can not hold synchronousLock*/
+        useSynchronousLock = (exclusive || pport->numWorkers<=1);
+        if(pport->numWorkers>1) {
+            /*Other workers must rescan the queues.
+             *Wake one of them if more requests are waiting*/
+            pport->queueStateChange = TRUE;
             for(i=asynQueuePriorityHigh; i>=asynQueuePriorityLow; i--) {
-                for(puserPvt = (userPvt *)ellFirst(&pport->queueList[i]);
-                puserPvt; puserPvt = (userPvt *)ellNext(&puserPvt->node)) {
-                    pdpCommon = findDpCommon(puserPvt);
-                    assert(pdpCommon);
-
-                    if(!pdpCommon->enabled) continue;
-                    if(!pdpCommon->connected) {
-                        autoConnectDevice(pdpCommon->pport,
-                            pdpCommon->pdevice);
-                        if(pport->queueStateChange) {
-                            puserPvt = 0;
-                            break;
-                        }
-                    }
-                    if(!pdpCommon->connected && puserPvt->timeoutUser!=0) {
-                       callTimeoutUser = TRUE;
-                    }
-                    if((pport->pblockProcessHolder==NULL
-                        || pport->pblockProcessHolder==puserPvt)
-                    && (pdpCommon->pblockProcessHolder==NULL
-                        || pdpCommon->pblockProcessHolder==puserPvt)) {
-                        assert(puserPvt->isQueued);
-                        ellDelete(&pport->queueList[i],&puserPvt->node);
-                        puserPvt->isQueued = FALSE;
-                        break;
-                    }
-                }
-                if(puserPvt || pport->queueStateChange) break; /*for*/
-            }
-            if(!puserPvt) break; /*while(1)*/
-            pasynUser = userPvtToAsynUser(puserPvt);
-            pasynUser->errorMessage[0] = '\0';
-            asynPrint(pasynUser,ASYN_TRACE_FLOW,"asynManager::portThread port=%s callback\n",pport->portName);
-            puserPvt->state = callbackActive;
-            timeout = puserPvt->timeout;
-            epicsMutexUnlock(pport->asynManagerLock);
-            if(puserPvt->timer && timeout>0.0) epicsTimerCancel(puserPvt->timer);
-            epicsMutexMustLock(pport->synchronousLock);
-            if(pport->pasynLockPortNotify) {
-                status = pport->pasynLockPortNotify->lock(
-                   pport->lockPortNotifyPvt,pasynUser);
-                if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
-                        "%s queueCallback pasynLockPortNotify:lock error %s\n",
-                         pport->portName,pasynUser->errorMessage);
-            }
-            if(callTimeoutUser) {
-                puserPvt->timeoutUser(pasynUser);
-            } else {
-                puserPvt->processUser(pasynUser);
-            }
-            if(pport->pasynLockPortNotify) {
-                status = pport->pasynLockPortNotify->unlock(
-                   pport->lockPortNotifyPvt,pasynUser);
-                if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
-                        "%s queueCallback pasynLockPortNotify:lock error %s\n",
-                         pport->portName,pasynUser->errorMessage);
-            }
-            epicsMutexUnlock(pport->synchronousLock);
-            epicsMutexMustLock(pport->asynManagerLock);
-            if(puserPvt->blockPortCount>0)
-                pport->pblockProcessHolder = puserPvt;
-            if(puserPvt->blockDeviceCount>0)
-                pdpCommon->pblockProcessHolder = puserPvt;
-            if(puserPvt->state==callbackCanceled)
-                epicsEventSignal(puserPvt->callbackDone);
-            puserPvt->state = callbackIdle;
-            if(puserPvt->freeAfterCallback) {
-                puserPvt->freeAfterCallback = FALSE;
-                epicsMutexMustLock(pasynBase->lock);
-                ellAdd(&pasynBase->asynUserFreeList,&puserPvt->node);
-                epicsMutexUnlock(pasynBase->lock);
+                if(ellCount(&pport->readyList[i])>0) break;
             }
-            if(pport->queueStateChange) break;
+            if(i>=asynQueuePriorityLow)
+                notifyPort(pport);
         }
+        pasynUser = userPvtToAsynUser(puserPvt);
+        pasynUser->errorMessage[0] = '\0';
+        asynPrint(pasynUser,ASYN_TRACE_FLOW,"asynManager::portThread port=%s callback\n",pport->portName);
+        epicsTimeGetCurrent(&startTime);
+        recordLatency(pport,pdpCommon,TRUE,&puserPvt->queueTime,&startTime);
+        puserPvt->state = callbackActive;
+        timeout = puserPvt->timeout;
         epicsMutexUnlock(pport->asynManagerLock);
+        if(puserPvt->timer && timeout>0.0) epicsTimerCancel(puserPvt->timer);
+        if(useSynchronousLock) epicsMutexMustLock(pport->synchronousLock);
+        if(pport->pasynLockPortNotify) {
+            status = pport->pasynLockPortNotify->lock(
+               pport->lockPortNotifyPvt,pasynUser);
+            if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
+                    "%s queueCallback pasynLockPortNotify:lock error %s\n",
+                     pport->portName,pasynUser->errorMessage);
+        }
+        if(callTimeoutUser) {
+            puserPvt->timeoutUser(pasynUser);
+        } else {
+            puserPvt->processUser(pasynUser);
+        }
+        if(pport->pasynLockPortNotify) {
+            status = pport->pasynLockPortNotify->unlock(
+               pport->lockPortNotifyPvt,pasynUser);
+            if(status!=asynSuccess) asynPrint(pasynUser,ASYN_TRACE_ERROR,
+                    "%s queueCallback pasynLockPortNotify:lock error %s\n",
+                     pport->portName,pasynUser->errorMessage);
+        }
+        if(useSynchronousLock) epicsMutexUnlock(pport->synchronousLock);
+        epicsTimeGetCurrent(&endTime);
+        epicsMutexMustLock(pport->asynManagerLock);
+        recordLatency(pport,pdpCommon,FALSE,&startTime,&endTime);
+        pport->numActive--;
+        if(exclusive) pport->exclusiveActive = FALSE;
+        pdpCommon->active = FALSE;
+        /*Requests skipped while this one was active may now run*/
+        if(pport->numWorkers>1) notifyPort(pport);
+        if(puserPvt->blockPortCount>0)
+            pport->pblockProcessHolder = puserPvt;
+        if(puserPvt->blockDeviceCount>0)
+            pdpCommon->pblockProcessHolder = puserPvt;
+        updateReadyAll(pdpCommon);
+        if(puserPvt->state==callbackCanceled)
+            epicsEventSignal(puserPvt->callbackDone);
+        puserPvt->state = callbackIdle;
+        if(puserPvt->freeAfterCallback) {
+            puserPvt->freeAfterCallback = FALSE;
+            freeUserPvt(puserPvt);
+        }
+        if(pport->queueStateChange) break;
+    }
+    epicsMutexUnlock(pport->asynManagerLock);
+}
+
+static void portThread(port *pport)
+{
+    taskwdInsert(epicsThreadGetIdSelf(),0,0);
+    while(1) {
+        epicsEventMustWait(pport->notifyPortThread);
+        processPortQueue(pport);
+    }
+}
+
+static void portPoolThread(void *arg)
+{
+    portPool *ppool = &pasynBase->portPool;
+    ELLNODE  *pnode;
+    port     *pport;
+
+    taskwdInsert(epicsThreadGetIdSelf(),0,0);
+    while(1) {
+        epicsMutexMustLock(ppool->lock);
+        pnode = ellGet(&ppool->readyList);
+        if(!pnode) {
+            epicsMutexUnlock(ppool->lock);
+            epicsEventMustWait(ppool->notify);
+            continue;
+        }
+        pport = poolNodeToPort(pnode);
+        pport->poolQueued = FALSE;
+        pport->poolActive = TRUE;
+        pport->poolNotify = FALSE;
+        /*Let another pool thread start on the next port*/
+        if(ellCount(&ppool->readyList)>0) epicsEventSignal(ppool->notify);
+        epicsMutexUnlock(ppool->lock);
+        processPortQueue(pport);
+        epicsMutexMustLock(ppool->lock);
+        pport->poolActive = FALSE;
+        if(pport->poolNotify) {
+            pport->poolQueued = TRUE;
+            ellAdd(&ppool->readyList,&pport->poolNode);
+        }
+        epicsMutexUnlock(ppool->lock);
+    }
+}
+
+/*Must be called with portPool.lock held*/
+static int startPortPoolThreads(int numThreads)
+{
+    portPool *ppool = &pasynBase->portPool;
+    char     threadName[32];
+
+    while(ppool->numThreads<numThreads) {
+        epicsSnprintf(threadName,sizeof(threadName),"asynPortPool%d",
+            ppool->numThreads);
+        if(!epicsThreadCreate(threadName,epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackMedium),
+            portPoolThread,0)) {
+            printf("asynManager: portPool epicsThreadCreate failed\n");
+            return -1;
+        }
+        ppool->numThreads++;
     }
+    return 0;
 }
 static void queueLockPortCallback(asynUser *pasynUser)
 {
@@ -1020,6 +1478,48 @@ typedef struct printPortArgs {
     int  details;
 }printPortArgs;
 
+/* Value below which fraction of the latencies are*/
+static double latencyPercentile(const asynLatencyHistogram *phist,double fraction)
+{
+    double      target = fraction*phist->n;
+    epicsUInt32 sum = 0;
+    double      limit;
+    int         bin;
+
+    for(bin=0; bin<ASYN_LATENCY_BINS-1; bin++) {
+        sum += phist->count[bin];
+        if(sum>=target) break;
+    }
+    limit = latencyBinLimit(bin);
+    return (bin==ASYN_LATENCY_BINS-1 || limit>phist->max) ? phist->max : limit;
+}
+
+static void reportRequestStats(FILE *fp,const char *indent,
+    const asynRequestStats *pstats)
+{
+    const asynLatencyHistogram *phist[2];
+    const char *name[2] = {"queueWait","callback "};
+    int i;
+
+    phist[0] = &pstats->queueWait;
+    phist[1] = &pstats->callback;
+    fprintf(fp,"%srequests low %lu medium %lu high %lu connect %lu timeouts %lu\n",
+        indent,(unsigned long)pstats->nQueued[asynQueuePriorityLow],
+        (unsigned long)pstats->nQueued[asynQueuePriorityMedium],
+        (unsigned long)pstats->nQueued[asynQueuePriorityHigh],
+        (unsigned long)pstats->nQueued[asynQueuePriorityConnect],
+        (unsigned long)pstats->nTimeout);
+    for(i=0; i<2; i++) {
+        if(phist[i]->n==0) continue;
+        fprintf(fp,"%s%s msec mean %.3f p50 %.3f p90 %.3f p99 %.3f max %.3f\n",
+            indent,name[i],1e3*phist[i]->sum/phist[i]->n,
+            1e3*latencyPercentile(phist[i],0.5),
+            1e3*latencyPercentile(phist[i],0.9),
+            1e3*latencyPercentile(phist[i],0.99),
+            1e3*phist[i]->max);
+    }
+}
+
 static void reportPrintPort(printPortArgs *pprintPortArgs)
 {
     epicsEventId done = pprintPortArgs->done;
@@ -1033,13 +1533,20 @@ static void reportPrintPort(printPortArgs *pprintPortArgs)
     asynCommon    *pasynCommon = 0;
     void          *drvPvt = 0;
     int           nQueued = 0;
+    device        *pdevice;
 
     if (details < 0) {
         showDevices = 0;
         details = -details;
     }
     for(i=asynQueuePriorityLow; i<=asynQueuePriorityConnect; i++)
-        nQueued += ellCount(&pport->queueList[i]);
+        nQueued += ellCount(&pport->dpc.queueList[i]);
+    pdevice = (device *)ellFirst(&pport->deviceList);
+    while(pdevice) {
+        for(i=asynQueuePriorityLow; i<=asynQueuePriorityHigh; i++)
+            nQueued += ellCount(&pdevice->dpc.queueList[i]);
+        pdevice = (device *)ellNext(&pdevice->node);
+    }
     pdpc = &pport->dpc;
     fprintf(fp,"%s multiDevice:%s canBlock:%s autoConnect:%s\n",
         pport->portName,
@@ -1063,6 +1570,12 @@ static void reportPrintPort(printPortArgs *pprintPortArgs)
             ellCount(&pport->deviceList),
             nQueued,
             (pport->pblockProcessHolder ? "Yes" : "No"));
+        if(pport->attributes&ASYN_SHAREDTHREAD)
+            fprintf(fp,"    uses shared port thread pool\n");
+        if(pport->numWorkers>1)
+            fprintf(fp,"    numWorkers %d numActive %d exclusiveActive:%s\n",
+                pport->numWorkers,pport->numActive,
+                (pport->exclusiveActive ? "Yes" : "No"));
         fprintf(fp,"    asynManagerLock:%s synchronousLock:%s\n",
             ((mgrStatus==epicsMutexLockOK) ? "No" : "Yes"),
             ((syncStatus==epicsMutexLockOK) ? "No" : "Yes"));
@@ -1073,6 +1586,10 @@ static void reportPrintPort(printPortArgs *pprintPortArgs)
             ellCount(&pdpc->exceptionNotifyList));
         fprintf(fp,"    traceMask:0x%x traceIOMask:0x%x traceInfoMask:0x%x\n",
             pdpc->trace.traceMask, pdpc->trace.traceIOMask, pdpc->trace.traceInfoMask);
+        if(pport->traceBinaryFile)
+            asynTraceBinaryReport(pport->traceBinaryFile,fp,"    ");
+        if(pport->attributes&ASYN_CANBLOCK)
+            reportRequestStats(fp,"    ",&pdpc->stats);
     }
     if(details>=2) {
         reportPrintInterfaceList(fp,&pdpc->interposeInterfaceList,
@@ -1080,7 +1597,7 @@ static void reportPrintPort(printPortArgs *pprintPortArgs)
         reportPrintInterfaceList(fp,&pport->interfaceList,"interfaceList");
     }
     if (showDevices) {
-        device   *pdevice = (device *)ellFirst(&pport->deviceList);
+        pdevice = (device *)ellFirst(&pport->deviceList);
         while(pdevice) {
             pdpc = &pdevice->dpc;
             if(!pdpc->connected || details>=1) {
@@ -1101,6 +1618,9 @@ static void reportPrintPort(printPortArgs *pprintPortArgs)
                     (pdpc->pblockProcessHolder ? "Yes" : "No"));
                 fprintf(fp,"        traceMask:0x%x traceIOMask:0x%x traceInfoMask:0x%x\n",
                     pdpc->trace.traceMask, pdpc->trace.traceIOMask, pdpc->trace.traceInfoMask);
+                if((pport->attributes&(ASYN_CANBLOCK|ASYN_MULTIDEVICE))
+                == (ASYN_CANBLOCK|ASYN_MULTIDEVICE))
+                    reportRequestStats(fp,"        ",&pdpc->stats);
             }
             if(details>=2) {
                 reportPrintInterfaceList(fp,&pdpc->interposeInterfaceList,
@@ -1132,6 +1652,46 @@ static void reportPrintPort(printPortArgs *pprintPortArgs)
     epicsEventSignal(done);
 }
 
+static void reportMemCache(FILE *fp)
+{
+    cacheStats memStats[nMemList];
+    cacheStats userStats;
+    double     largeBytes = 0.0;
+    int        i, j;
+
+    memset(memStats,0,sizeof(memStats));
+    memset(&userStats,0,sizeof(userStats));
+    for(i=0; i<NUMBER_MEM_CACHES; i++) {
+        memCache *pcache = &pasynBase->memCache[i];
+
+        epicsMutexMustLock(pcache->lock);
+        for(j=0; j<nMemList; j++) {
+            memStats[j].hits += pcache->memStats[j].hits;
+            memStats[j].misses += pcache->memStats[j].misses;
+            memStats[j].nAlloc += pcache->memStats[j].nAlloc;
+            memStats[j].nFree += pcache->memStats[j].nFree;
+        }
+        userStats.hits += pcache->userStats.hits;
+        userStats.misses += pcache->userStats.misses;
+        userStats.nAlloc += pcache->userStats.nAlloc;
+        userStats.nFree += pcache->userStats.nFree;
+        largeBytes += pcache->largeAlloc - pcache->largeFree;
+        epicsMutexUnlock(pcache->lock);
+    }
+    fprintf(fp,"asynManager memory caches\n");
+    for(j=0; j<nMemList; j++) {
+        if(memStats[j].nAlloc==0) continue;
+        fprintf(fp,"    size %4lu hits %lu misses %lu outstanding bytes %ld\n",
+            (unsigned long)memListSize[j],memStats[j].hits,memStats[j].misses,
+            (long)(memStats[j].nAlloc-memStats[j].nFree)*(long)memListSize[j]);
+    }
+    fprintf(fp,"    size >%lu outstanding bytes %.0f\n",
+        (unsigned long)memListSize[nMemList-1],largeBytes);
+    fprintf(fp,"    asynUser hits %lu misses %lu outstanding %ld\n",
+        userStats.hits,userStats.misses,
+        (long)(userStats.nAlloc-userStats.nFree));
+}
+
 static void report(FILE *fp,int details,const char *portName)
 {
     port *pport;
@@ -1166,21 +1726,88 @@ static void report(FILE *fp,int details,const char *portName)
             epicsEventMustWait(done);
             pport = (port *)ellNext(&pport->node);
         }
+        if(details>=1) {
+            portPool *ppool = &pasynBase->portPool;
+            if(ppool->numThreads>0) {
+                epicsMutexMustLock(ppool->lock);
+                fprintf(fp,"port thread pool: %d threads %d ports %d waiting\n",
+                    ppool->numThreads,ppool->numPorts,
+                    ellCount(&ppool->readyList));
+                epicsMutexUnlock(ppool->lock);
+            }
+            reportMemCache(fp);
+            reportTraceAsync(fp);
+            asynTraceBinaryReport(pasynBase->traceBinaryFile,fp,"");
+        }
     }
     epicsEventDestroy(done);
 }
 
+/* Spreads threads over memCaches and traceRings*/
+static size_t threadHash(void)
+{
+    size_t id = (size_t)epicsThreadGetIdSelf();
+
+    return id ^ (id>>7) ^ (id>>13);
+}
+
+static memCache *getMemCache(void)
+{
+    return &pasynBase->memCache[threadHash()%NUMBER_MEM_CACHES];
+}
+
+/* Move up to n nodes from pfrom to pto*/
+static void moveFreeNodes(ELLLIST *pto,ELLLIST *pfrom,int n)
+{
+    ELLNODE *pnode;
+
+    while(n-- > 0 && (pnode = ellFirst(pfrom))) {
+        ellDelete(pfrom,pnode);
+        ellAdd(pto,pnode);
+    }
+}
+
+static void freeUserPvt(userPvt *puserPvt)
+{
+    memCache *pcache = getMemCache();
+
+    epicsMutexMustLock(pcache->lock);
+    ellAdd(&pcache->asynUserFreeList,&puserPvt->node);
+    pcache->userStats.nFree++;
+    if(ellCount(&pcache->asynUserFreeList)>MEM_CACHE_SIZE) {
+        epicsMutexMustLock(pasynBase->lock);
+        moveFreeNodes(&pasynBase->asynUserFreeList,
+            &pcache->asynUserFreeList,MEM_CACHE_SIZE/2);
+        epicsMutexUnlock(pasynBase->lock);
+    }
+    epicsMutexUnlock(pcache->lock);
+}
+
 static asynUser *createAsynUser(userCallback process, userCallback timeout)
 {
     userPvt  *puserPvt;
     asynUser *pasynUser;
     int      nbytes;
+    memCache *pcache;
 
     if(!pasynBase) asynInit();
-    epicsMutexMustLock(pasynBase->lock);
-    puserPvt = (userPvt *)ellFirst(&pasynBase->asynUserFreeList);
-    if(!puserPvt) {
+    pcache = getMemCache();
+    epicsMutexMustLock(pcache->lock);
+    pcache->userStats.nAlloc++;
+    puserPvt = (userPvt *)ellFirst(&pcache->asynUserFreeList);
+    if(puserPvt) {
+        pcache->userStats.hits++;
+    } else {
+        pcache->userStats.misses++;
+        epicsMutexMustLock(pasynBase->lock);
+        moveFreeNodes(&pcache->asynUserFreeList,
+            &pasynBase->asynUserFreeList,MEM_CACHE_SIZE/2);
         epicsMutexUnlock(pasynBase->lock);
+        puserPvt = (userPvt *)ellFirst(&pcache->asynUserFreeList);
+    }
+    if(puserPvt) ellDelete(&pcache->asynUserFreeList,&puserPvt->node);
+    epicsMutexUnlock(pcache->lock);
+    if(!puserPvt) {
         nbytes = sizeof(userPvt) + ERROR_MESSAGE_SIZE + 1;
         puserPvt = callocMustSucceed(1,nbytes,"asynCommon:registerDriver");
         puserPvt->timer = epicsTimerQueueCreateTimer(
@@ -1190,8 +1817,6 @@ static asynUser *createAsynUser(userCallback process, userCallback timeout)
         pasynUser->errorMessage = (char *)(puserPvt +1);
         pasynUser->errorMessageSize = ERROR_MESSAGE_SIZE;
     } else {
-        ellDelete(&pasynBase->asynUserFreeList,&puserPvt->node);
-        epicsMutexUnlock(pasynBase->lock);
         pasynUser = userPvtToAsynUser(puserPvt);
     }
     puserPvt->processUser = process;
@@ -1210,6 +1835,7 @@ static asynUser *createAsynUser(userCallback process, userCallback timeout)
     pasynUser->drvUser = 0;
     pasynUser->reason = 0;
     pasynUser->auxStatus = 0;
+    pasynUser->arrayBuffer = 0;
     return pasynUser;
 }
 
@@ -1242,13 +1868,11 @@ static asynStatus freeAsynUser(asynUser *pasynUser)
         status = disconnect(pasynUser);
         if(status!=asynSuccess) return asynError;
     }
-    epicsMutexMustLock(pasynBase->lock);
     if(puserPvt->state==callbackIdle) {
-        ellAdd(&pasynBase->asynUserFreeList,&puserPvt->node);
+        freeUserPvt(puserPvt);
     } else {
         puserPvt->freeAfterCallback = TRUE;
     }
-    epicsMutexUnlock(pasynBase->lock);
     return asynSuccess;
 }
 
@@ -1257,27 +1881,41 @@ static void *memMalloc(size_t size)
     int ind;
     ELLLIST *pmemList;
     memNode *pmemNode;
+    memCache *pcache;
 
     if(!pasynBase) asynInit();
+    pcache = getMemCache();
     for(ind=0; ind<nMemList; ind++) {
         if(size<=memListSize[ind]) break;
     }
     if(ind>=nMemList) {
+        epicsMutexMustLock(pcache->lock);
+        pcache->largeAlloc += size;
+        epicsMutexUnlock(pcache->lock);
         return mallocMustSucceed(size,"asynManager::memMalloc");
     }
-    pmemList = &pasynBase->memList[ind];
-    epicsMutexMustLock(pasynBase->lock);
+    pmemList = &pcache->memList[ind];
+    epicsMutexMustLock(pcache->lock);
+    pcache->memStats[ind].nAlloc++;
     pmemNode = (memNode *)ellFirst(pmemList);
     if(pmemNode) {
-         ellDelete(pmemList,&pmemNode->node);
-     } else {
+        pcache->memStats[ind].hits++;
+    } else {
+        pcache->memStats[ind].misses++;
+        epicsMutexMustLock(pasynBase->lock);
+        moveFreeNodes(pmemList,&pasynBase->memList[ind],MEM_CACHE_SIZE/2);
+        epicsMutexUnlock(pasynBase->lock);
+        pmemNode = (memNode *)ellFirst(pmemList);
+    }
+    if(pmemNode) ellDelete(pmemList,&pmemNode->node);
+    epicsMutexUnlock(pcache->lock);
+    if(!pmemNode) {
         /* Note: pmemNode->memory must be multiple of 16 in order to hold any data type */
         pmemNode = mallocMustSucceed(NODESIZE + memListSize[ind],
              "asynManager::memMalloc");
         pmemNode->memory = (char *)pmemNode + NODESIZE;
-     }
-     epicsMutexUnlock(pasynBase->lock);
-     return pmemNode->memory;
+    }
+    return pmemNode->memory;
 }
 
 static void memFree(void *pmem,size_t size)
@@ -1285,10 +1923,15 @@ static void memFree(void *pmem,size_t size)
     int ind;
     ELLLIST *pmemList;
     memNode *pmemNode;
+    memCache *pcache;
 
     assert(size>0);
     if(!pasynBase) asynInit();
+    pcache = getMemCache();
     if(size>memListSize[nMemList-1]) {
+        epicsMutexMustLock(pcache->lock);
+        pcache->largeFree += size;
+        epicsMutexUnlock(pcache->lock);
         free(pmem);
         return;
     }
@@ -1296,12 +1939,18 @@ static void memFree(void *pmem,size_t size)
         if(size<=memListSize[ind]) break;
     }
     assert(ind<nMemList);
-    pmemList = &pasynBase->memList[ind];
+    pmemList = &pcache->memList[ind];
     pmemNode = (memNode *)((char *)pmem - NODESIZE);
     assert(pmemNode->memory==pmem);
-    epicsMutexMustLock(pasynBase->lock);
+    epicsMutexMustLock(pcache->lock);
     ellAdd(pmemList,&pmemNode->node);
-    epicsMutexUnlock(pasynBase->lock);
+    pcache->memStats[ind].nFree++;
+    if(ellCount(pmemList)>MEM_CACHE_SIZE) {
+        epicsMutexMustLock(pasynBase->lock);
+        moveFreeNodes(&pasynBase->memList[ind],pmemList,MEM_CACHE_SIZE/2);
+        epicsMutexUnlock(pasynBase->lock);
+    }
+    epicsMutexUnlock(pcache->lock);
 }
 
 static asynStatus isMultiDevice(asynUser *pasynUser,
@@ -1579,16 +2228,23 @@ static asynStatus queueRequest(asynUser *pasynUser,
         asynPrint(pasynUser,ASYN_TRACE_FLOW,
             "%s addr %d queueRequest priority %d from lockHolder\n",
             pport->portName,addr,priority);
-        ellInsert(&pport->queueList[priority],0,&puserPvt->node);
+        ellInsert(findQueueList(puserPvt,priority),0,&puserPvt->node);
     } else {
         asynPrint(pasynUser,ASYN_TRACE_FLOW,
             "%s addr %d queueRequest priority %d not lockHolder\n",
             pport->portName,addr,priority);
         /*Add to end of list*/
-        ellAdd(&pport->queueList[priority],&puserPvt->node);
+        ellAdd(findQueueList(puserPvt,priority),&puserPvt->node);
     }
+    /*A lockHolder goes before every request that is already queued*/
+    puserPvt->sequence = addToFront ?
+        pport->frontSequence-- : pport->queueSequence++;
+    if(priority!=asynQueuePriorityConnect) updateReady(pdpCommon,priority);
     pport->queueStateChange = TRUE;
     puserPvt->isQueued = TRUE;
+    puserPvt->priority = priority;
+    epicsTimeGetCurrent(&puserPvt->queueTime);
+    recordRequestCount(puserPvt,FALSE);
     if(timeout<=0.0) {
         puserPvt->timeout = 0.0;
     } else {
@@ -1598,7 +2254,7 @@ static asynStatus queueRequest(asynUser *pasynUser,
         epicsTimerStartDelay(puserPvt->timer,puserPvt->timeout);
     }
     epicsMutexUnlock(pport->asynManagerLock);
-    epicsEventSignal(pport->notifyPortThread);
+    notifyPort(pport);
     return asynSuccess;
 }
 
@@ -1609,7 +2265,6 @@ static asynStatus cancelRequest(asynUser *pasynUser,int *wasQueued)
     device   *pdevice = puserPvt->pdevice;
     double   timeout;
     int      addr = (pdevice ? pdevice->addr : -1);
-    int      i;
     *wasQueued = 0; /*Initialize to not removed*/
     if(!pport) {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
@@ -1633,25 +2288,10 @@ static asynStatus cancelRequest(asynUser *pasynUser,int *wasQueued)
         }
         return asynSuccess;
     }
-    for(i=asynQueuePriorityConnect; i>=asynQueuePriorityLow; i--) {
-        puserPvt = (userPvt *)ellFirst(&pport->queueList[i]);
-        while(puserPvt) {
-            if(pasynUser == &puserPvt->user) {
-                ellDelete(&pport->queueList[i],&puserPvt->node);
-                *wasQueued = 1;
-                break;
-            }
-            puserPvt = (userPvt *)ellNext(&puserPvt->node);
-        }
-        if(puserPvt) break;
-    }
-    if(!puserPvt) {
-        asynPrint(pasynUser,ASYN_TRACE_ERROR,
-            "%s addr %d asynManager:cancelRequest LOGIC ERROR\n",
-            pport->portName, addr);
-        epicsMutexUnlock(pport->asynManagerLock);
-        return asynError;
-    }
+    ellDelete(findQueueList(puserPvt,puserPvt->priority),&puserPvt->node);
+    if(puserPvt->priority!=asynQueuePriorityConnect)
+        updateReady(findDpCommon(puserPvt),puserPvt->priority);
+    *wasQueued = 1;
     asynPrint(pasynUser,ASYN_TRACE_FLOW,
              "%s addr %d asynManager:cancelRequest\n",
               pport->portName,addr);
@@ -1660,7 +2300,7 @@ static asynStatus cancelRequest(asynUser *pasynUser,int *wasQueued)
     timeout = puserPvt->timeout;
     epicsMutexUnlock(pport->asynManagerLock);
     if(puserPvt->timer && timeout>0.0) epicsTimerCancel(puserPvt->timer);
-    epicsEventSignal(pport->notifyPortThread);
+    notifyPort(pport);
     return asynSuccess;
 }
 
@@ -1740,11 +2380,12 @@ static asynStatus unblockProcessCallback(asynUser *pasynUser, int allDevices)
 
         if (pdpCommon->pblockProcessHolder==puserPvt) {
             pdpCommon->pblockProcessHolder = 0;
+            updateReadyAll(pdpCommon);
             wasOwner = TRUE;
         }
     }
     epicsMutexUnlock(pport->asynManagerLock);
-    if(wasOwner) epicsEventSignal(pport->notifyPortThread);
+    if(wasOwner) notifyPort(pport);
     return asynSuccess;
 }
 
@@ -1987,6 +2628,7 @@ static asynStatus registerPort(const char *portName,
         printf("asynCommon:registerDriver %s already registered\n",portName);
         return asynError;
     }
+    if(!(attributes&ASYN_CANBLOCK)) attributes &= ~ASYN_SHAREDTHREAD;
     len = sizeof(port) + strlen(portName) + 1;
     pport = callocMustSucceed(len,sizeof(char),"asynCommon:registerDriver");
     pport->portName = (char *)(pport + 1);
@@ -2000,15 +2642,43 @@ static asynStatus registerPort(const char *portName,
     pport->pasynUser = createAsynUser(0,0);
     pport->previousConnectStatus = portConnectSuccess;
     pport->queueLockPortTimeout = DEFAULT_QUEUE_LOCK_PORT_TIMEOUT;
+    /*Counts down from just before the first queueSequence*/
+    pport->frontSequence = (unsigned long)-1;
     ellInit(&pport->deviceList);
     ellInit(&pport->interfaceList);
-    if((attributes&ASYN_CANBLOCK)) {
-        for(i=0; i<NUMBER_QUEUE_PRIORITIES; i++) ellInit(&pport->queueList[i]);
+    if((attributes&ASYN_SHAREDTHREAD)) {
+        portPool *ppool = &pasynBase->portPool;
+        int      status;
+
+        for(i=0; i<NUMBER_QUEUE_PRIORITIES; i++) ellInit(&pport->readyList[i]);
+        pport->numWorkers = 1;
+        epicsMutexMustLock(ppool->lock);
+        status = startPortPoolThreads(ppool->numThreads ?
+                     ppool->numThreads : DEFAULT_PORT_POOL_THREADS);
+        if(ppool->numThreads==0) {
+            epicsMutexUnlock(ppool->lock);
+            freeAsynUser(pport->pasynUser);
+            dpCommonFree(&pport->dpc);
+            epicsMutexDestroy(pport->synchronousLock);
+            epicsMutexDestroy(pport->asynManagerLock);
+            free(pport);
+            return asynError;
+        }
+        if(status)
+            printf("asynCommon:registerDriver %s port pool has only %d threads\n",
+                portName,ppool->numThreads);
+        ppool->numPorts++;
+        epicsMutexUnlock(ppool->lock);
+    } else if((attributes&ASYN_CANBLOCK)) {
+        for(i=0; i<NUMBER_QUEUE_PRIORITIES; i++) ellInit(&pport->readyList[i]);
         pport->notifyPortThread = epicsEventMustCreate(epicsEventEmpty);
         priority = priority ? priority : epicsThreadPriorityMedium;
         stackSize = stackSize ?
                        stackSize :
                        epicsThreadGetStackSize(epicsThreadStackMedium);
+        pport->numWorkers = 1;
+        pport->threadPriority = priority;
+        pport->threadStackSize = stackSize;
         pport->threadid = epicsThreadCreate(portName,priority,stackSize,
              (EPICSTHREADFUNC)portThread,pport);
         if(!pport->threadid){
@@ -2029,16 +2699,128 @@ static asynStatus registerPort(const char *portName,
     return asynSuccess;
 }
 
-static asynStatus registerInterface(const char *portName,
-    asynInterface *pasynInterface)
+static asynStatus setPortWorkers(const char *portName,int numWorkers)
 {
-    port          *pport = locatePort(portName);
-    interfaceNode *pinterfaceNode;
+    port    *pport = locatePort(portName);
+    char    threadName[64];
+    int     i;
 
     if(!pport) {
-       printf("asynManager:registerInterface portName %s not registered\n",
-          portName);
-       return asynError;
+        printf("asynManager:setPortWorkers portName %s not registered\n",
+            portName);
+        return asynError;
+    }
+    if((pport->attributes&(ASYN_CANBLOCK|ASYN_MULTIDEVICE))
+    != (ASYN_CANBLOCK|ASYN_MULTIDEVICE)) {
+        printf("asynManager:setPortWorkers %s is not a "
+            "multiDevice, canBlock port\n",portName);
+        return asynError;
+    }
+    if(pport->attributes&ASYN_SHAREDTHREAD) {
+        printf("asynManager:setPortWorkers %s uses the shared port thread pool\n",
+            portName);
+        return asynError;
+    }
+    /*Device requests run by different workers do not hold synchronousLock,
+     *so lockPort does not exclude them. Only drivers that allow this may
+     *have more than one worker*/
+    if(numWorkers>1 && !(pport->attributes&ASYN_REENTRANT)) {
+        printf("asynManager:setPortWorkers %s was not registered with "
+            "ASYN_REENTRANT\n",portName);
+        return asynError;
+    }
+    epicsMutexMustLock(pport->asynManagerLock);
+    if(numWorkers<pport->numWorkers) {
+        printf("asynManager:setPortWorkers %s already has %d workers\n",
+            portName,pport->numWorkers);
+        epicsMutexUnlock(pport->asynManagerLock);
+        return asynError;
+    }
+    for(i=pport->numWorkers; i<numWorkers; i++) {
+        epicsSnprintf(threadName,sizeof(threadName),"%.50s_w%d",portName,i);
+        if(!epicsThreadCreate(threadName,pport->threadPriority,
+            pport->threadStackSize,(EPICSTHREADFUNC)portThread,pport)) {
+            printf("asynManager:setPortWorkers %s epicsThreadCreate failed\n",
+                portName);
+            break;
+        }
+        pport->numWorkers++;
+    }
+    epicsMutexUnlock(pport->asynManagerLock);
+    return (pport->numWorkers==numWorkers) ? asynSuccess : asynError;
+}
+
+static asynStatus setPortPoolThreads(int numThreads)
+{
+    portPool *ppool;
+    int      status;
+
+    if(!pasynBase) asynInit();
+    ppool = &pasynBase->portPool;
+    epicsMutexMustLock(ppool->lock);
+    if(numThreads<ppool->numThreads) {
+        printf("asynManager:setPortPoolThreads already has %d threads\n",
+            ppool->numThreads);
+        epicsMutexUnlock(ppool->lock);
+        return asynError;
+    }
+    status = startPortPoolThreads(numThreads);
+    epicsMutexUnlock(ppool->lock);
+    return status ? asynError : asynSuccess;
+}
+
+static asynStatus getRequestStats(asynUser *pasynUser,asynRequestStats *pstats)
+{
+    userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
+    port     *pport = puserPvt->pport;
+    dpCommon *pdpCommon = findDpCommon(puserPvt);
+
+    if(!pport) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                "asynManager:getRequestStats not connected");
+        return asynError;
+    }
+    epicsMutexMustLock(pport->asynManagerLock);
+    *pstats = pdpCommon->stats;
+    epicsMutexUnlock(pport->asynManagerLock);
+    return asynSuccess;
+}
+
+static asynStatus resetRequestStats(asynUser *pasynUser)
+{
+    userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
+    port     *pport = puserPvt->pport;
+    dpCommon *pdpCommon = findDpCommon(puserPvt);
+    device   *pdevice;
+
+    if(!pport) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                "asynManager:resetRequestStats not connected");
+        return asynError;
+    }
+    epicsMutexMustLock(pport->asynManagerLock);
+    memset(&pdpCommon->stats,0,sizeof(asynRequestStats));
+    if(pdpCommon==&pport->dpc) {
+        pdevice = (device *)ellFirst(&pport->deviceList);
+        while(pdevice) {
+            memset(&pdevice->dpc.stats,0,sizeof(asynRequestStats));
+            pdevice = (device *)ellNext(&pdevice->node);
+        }
+    }
+    epicsMutexUnlock(pport->asynManagerLock);
+    return asynSuccess;
+}
+
+static asynStatus registerInterface(const char *portName,
+    asynInterface *pasynInterface)
+{
+    port          *pport = locatePort(portName);
+    interfaceNode *pinterfaceNode;
+
+    if(!pport) {
+       printf("asynManager:registerInterface portName %s not registered\n",
+          portName);
+       return asynError;
     }
     epicsMutexMustLock(pport->asynManagerLock);
     if(strcmp(pasynInterface->interfaceType,asynLockPortNotifyType)==0) {
@@ -2160,7 +2942,10 @@ static asynStatus enable(asynUser *pasynUser,int yesNo)
             "asynManager:enable not connected");
         return asynError;
     }
+    epicsMutexMustLock(pport->asynManagerLock);
     pdpCommon->enabled = (yesNo ? 1 : 0);
+    if(pport->attributes&ASYN_CANBLOCK) updateReadyAll(pdpCommon);
+    epicsMutexUnlock(pport->asynManagerLock);
     exceptionOccurred(pasynUser,asynExceptionEnable);
     return asynSuccess;
 }
@@ -2289,6 +3074,7 @@ static asynStatus registerInterruptSource(const char *portName,
     pinterfaceNode->pinterruptBase = pinterruptBase;
     ellInit(&pinterruptBase->callbackList);
     ellInit(&pinterruptBase->addRemoveList);
+    ellInit(&pinterruptBase->indexEmptyList);
     pinterruptBase->pasynInterface = pinterfaceNode->pasynInterface;
     pinterruptBase->pport = pport;
     *pasynPvt = pinterruptBase;
@@ -2347,6 +3133,7 @@ static interruptNode *createInterruptNode(void *pasynPvt)
         epicsMutexUnlock(pasynBase->lock);
         pinterruptNodePvt->isOnList = 0;
         pinterruptNodePvt->isOnAddRemoveList = 0;
+        pinterruptNodePvt->pindexKey = 0;
         memset(&pinterruptNodePvt->nodePublic,0,sizeof(interruptNode));
     } else {
         epicsMutexUnlock(pasynBase->lock);
@@ -2356,6 +3143,7 @@ static interruptNode *createInterruptNode(void *pasynPvt)
         pinterruptNodePvt->callbackDone = epicsEventMustCreate(epicsEventEmpty);
     }
     pinterruptNodePvt->pinterruptBase = pinterruptBase;
+    pinterruptNodePvt->indexNode.pinterruptNode = &pinterruptNodePvt->nodePublic;
     return(&pinterruptNodePvt->nodePublic);
 }
 
@@ -2379,13 +3167,111 @@ static asynStatus freeInterruptNode(asynUser *pasynUser,interruptNode *pinterrup
     return asynSuccess;
 }
 
+/* The interrupt index maps reason/addr to the users registered with them.
+ * It is only modified while callbackActive is false, so findInterruptUsers
+ * can be called without asynManagerLock between interruptStart/interruptEnd.
+ * Caller of the following must own asynManagerLock. */
+static ELLLIST *interruptIndexBucket(ELLLIST *ptable,int size,int reason,int addr)
+{
+    unsigned int hash = (unsigned int)reason*2654435761u ^ (unsigned int)addr;
+
+    return &ptable[(hash ^ (hash>>16)) & (size-1)];
+}
+
+static interruptIndexKey *interruptIndexFind(interruptBase *pinterruptBase,
+    int reason,int addr)
+{
+    ELLLIST           *pbucket;
+    interruptIndexKey *pkey;
+
+    if(!pinterruptBase->indexTable) return 0;
+    pbucket = interruptIndexBucket(pinterruptBase->indexTable,
+        pinterruptBase->indexTableSize,reason,addr);
+    pkey = (interruptIndexKey *)ellFirst(pbucket);
+    while(pkey) {
+        if(pkey->reason==reason && pkey->addr==addr) return pkey;
+        pkey = (interruptIndexKey *)ellNext(&pkey->node);
+    }
+    return 0;
+}
+
+static void interruptIndexResize(interruptBase *pinterruptBase,int newSize)
+{
+    ELLLIST           *pnewTable;
+    interruptIndexKey *pkey;
+    int               i;
+
+    pnewTable = callocMustSucceed(newSize,sizeof(ELLLIST),
+        "asynManager:interruptIndexResize");
+    for(i=0; i<newSize; i++) ellInit(&pnewTable[i]);
+    for(i=0; i<pinterruptBase->indexTableSize; i++) {
+        ELLLIST *pbucket = &pinterruptBase->indexTable[i];
+        while((pkey = (interruptIndexKey *)ellFirst(pbucket))) {
+            ellDelete(pbucket,&pkey->node);
+            ellAdd(interruptIndexBucket(pnewTable,newSize,pkey->reason,pkey->addr),
+                &pkey->node);
+        }
+    }
+    free(pinterruptBase->indexTable);
+    pinterruptBase->indexTable = pnewTable;
+    pinterruptBase->indexTableSize = newSize;
+}
+
+static void interruptIndexAdd(interruptBase *pinterruptBase,
+    interruptNodePvt *pinterruptNodePvt,int reason,int addr)
+{
+    interruptIndexKey *pkey = interruptIndexFind(pinterruptBase,reason,addr);
+
+    if(!pkey) {
+        if(!pinterruptBase->indexTable) {
+            interruptIndexResize(pinterruptBase,INTERRUPT_INDEX_INITIAL_SIZE);
+        } else if(pinterruptBase->indexNumKeys >= 2*pinterruptBase->indexTableSize) {
+            interruptIndexResize(pinterruptBase,2*pinterruptBase->indexTableSize);
+        }
+        pkey = callocMustSucceed(1,sizeof(interruptIndexKey),
+            "asynManager:interruptIndexAdd");
+        pkey->reason = reason;
+        pkey->addr = addr;
+        ellInit(&pkey->userList);
+        ellAdd(interruptIndexBucket(pinterruptBase->indexTable,
+            pinterruptBase->indexTableSize,reason,addr),&pkey->node);
+        pinterruptBase->indexNumKeys++;
+    }
+    ellAdd(&pkey->userList,&pinterruptNodePvt->indexNode.node);
+    pinterruptNodePvt->pindexKey = pkey;
+}
+
+static void interruptIndexRemove(interruptBase *pinterruptBase,
+    interruptNodePvt *pinterruptNodePvt)
+{
+    interruptIndexKey *pkey = pinterruptNodePvt->pindexKey;
+
+    if(!pkey) return;
+    ellDelete(&pkey->userList,&pinterruptNodePvt->indexNode.node);
+    pinterruptNodePvt->pindexKey = 0;
+    if(ellCount(&pkey->userList)==0) {
+        ellDelete(interruptIndexBucket(pinterruptBase->indexTable,
+            pinterruptBase->indexTableSize,pkey->reason,pkey->addr),&pkey->node);
+        pinterruptBase->indexNumKeys--;
+        free(pkey);
+    }
+}
+
 static asynStatus addInterruptUser(asynUser *pasynUser,
                                    interruptNode*pinterruptNode)
 {
     interruptNodePvt *pinterruptNodePvt = interruptNodeToPvt(pinterruptNode);
     interruptBase    *pinterruptBase = pinterruptNodePvt->pinterruptBase;
     port             *pport = pinterruptBase->pport;
+    int              addr = -1;
 
+    /* The address source can call back into the driver,
+     * so it is called before asynManagerLock is taken */
+    if(pport->interruptAddrSource) {
+        pport->interruptAddrSource(pport->interruptAddrPvt,pasynUser,&addr);
+    } else {
+        getAddr(pasynUser,&addr);
+    }
     epicsMutexMustLock(pport->asynManagerLock);
     if(pinterruptNodePvt->isOnList) {
         epicsMutexUnlock(pport->asynManagerLock);
@@ -2409,6 +3295,7 @@ static asynStatus addInterruptUser(asynUser *pasynUser,
     }
     ellAdd(&pinterruptBase->callbackList,&pinterruptNode->node);
     pinterruptNodePvt->isOnList = TRUE;
+    interruptIndexAdd(pinterruptBase,pinterruptNodePvt,pasynUser->reason,addr);
     epicsMutexUnlock(pport->asynManagerLock);
     return asynSuccess;
 }
@@ -2443,6 +3330,7 @@ static asynStatus removeInterruptUser(asynUser *pasynUser,
     }
     ellDelete(&pinterruptBase->callbackList,&pinterruptNode->node);
     pinterruptNodePvt->isOnList = FALSE;
+    interruptIndexRemove(pinterruptBase,pinterruptNodePvt);
     epicsMutexUnlock(pport->asynManagerLock);
     return asynSuccess;
 }
@@ -2484,6 +3372,36 @@ static asynStatus interruptEnd(void *pasynPvt)
     return asynSuccess;
 }
 
+static asynStatus findInterruptUsers(void *pasynPvt,int reason,int addr,
+    ELLLIST **plist)
+{
+    interruptBase     *pinterruptBase = (interruptBase *)pasynPvt;
+    interruptIndexKey *pkey;
+
+    /* No lock needed: the index is not modified while callbackActive */
+    pkey = interruptIndexFind(pinterruptBase,reason,addr);
+    *plist = pkey ? &pkey->userList : &pinterruptBase->indexEmptyList;
+    return asynSuccess;
+}
+
+static asynStatus registerInterruptAddrSource(asynUser *pasynUser,
+    void *pPvt, interruptAddrCallback callback)
+{
+    userPvt *puserPvt = asynUserToUserPvt(pasynUser);
+    port    *pport = puserPvt->pport;
+
+    if(!pport) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+            "asynManager:registerInterruptAddrSource not connected to device");
+        return asynError;
+    }
+    epicsMutexMustLock(pport->asynManagerLock);
+    pport->interruptAddrSource = callback;
+    pport->interruptAddrPvt = pPvt;
+    epicsMutexUnlock(pport->asynManagerLock);
+    return asynSuccess;
+}
+
 /* Time stamp functions */
 
 static void defaultTimeStampSource(void *userPvt, epicsTimeStamp *pTimeStamp)
@@ -2727,18 +3645,10 @@ static asynStatus setTraceFile(asynUser *pasynUser,FILE *fp)
 {
     userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
     tracePvt *ptracePvt  = findTracePvt(puserPvt);
+    FILE     *oldFp = 0;
 
     epicsMutexMustLock(pasynBase->lockTrace);
-    if(ptracePvt->type==traceFileFP) {
-        int status;
-
-        errno = 0;
-        status = fclose(ptracePvt->fp);
-        if(status) {
-            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
-                "asynManager:setTraceFile fclose error %s",strerror(errno));
-        }
-    }
+    if(ptracePvt->type==traceFileFP) oldFp = ptracePvt->fp;
     if(fp==0) {
         ptracePvt->type = traceFileErrlog; ptracePvt->fp = 0;
     } else if(fp==stdout) {
@@ -2748,6 +3658,18 @@ static asynStatus setTraceFile(asynUser *pasynUser,FILE *fp)
     } else {
         ptracePvt->type = traceFileFP; ptracePvt->fp = fp;
     }
+    if(oldFp) {
+        int status;
+
+        /* Asynchronous trace messages may still refer to the old file*/
+        traceFlushAsync();
+        errno = 0;
+        status = fclose(oldFp);
+        if(status) {
+            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                "asynManager:setTraceFile fclose error %s",strerror(errno));
+        }
+    }
     if(puserPvt->pport) exceptionOccurred(pasynUser,asynExceptionTraceFile);
     epicsMutexUnlock(pasynBase->lockTrace);
     return asynSuccess;
@@ -2794,22 +3716,446 @@ static size_t getTraceIOTruncateSize(asynUser *pasynUser)
     return ptracePvt->traceTruncateSize;
 }
 
-static size_t printThread(FILE *fp)
+static int traceOutputV(traceOutput *pout,const char *pformat,va_list pvar)
 {
-    size_t nout = 0;
-    unsigned int threadPriority = epicsThreadGetPrioritySelf();
-    epicsThreadId threadId = epicsThreadGetIdSelf();
-    if(fp) {
-        nout = fprintf(fp,"[%s,%p,%u] ",epicsThreadGetNameSelf(),
-                       (void*)threadId,threadPriority);
-    } else {
-        nout = errlogPrintf("[%s,%p,%u] ",epicsThreadGetNameSelf(),
-                            (void*)threadId,threadPriority);
+    int    nout;
+    size_t room;
+
+    if(!pout->buffer) {
+        if(pout->fp) return vfprintf(pout->fp,pformat,pvar);
+        return errlogVprintf(pformat,pvar);
     }
+    room = pout->size - pout->len;
+    nout = epicsVsnprintf(pout->buffer + pout->len,room,pformat,pvar);
+    if(nout<0) return 0;
+    pout->len += ((size_t)nout<room) ? (size_t)nout : room - 1;
     return nout;
 }
 
-static size_t printTime(FILE *fp)
+static int traceOutputPrintf(traceOutput *pout,const char *pformat,...)
+{
+    va_list pvar;
+    int     nout;
+
+    va_start(pvar,pformat);
+    nout = traceOutputV(pout,pformat,pvar);
+    va_end(pvar);
+    return nout;
+}
+
+static int traceOutputEscaped(traceOutput *pout,tracePvt *ptracePvt,
+    const char *buffer,size_t len)
+{
+    int    nout;
+    size_t room;
+
+    if(!pout->buffer) {
+        if(pout->fp) return epicsStrPrintEscaped(pout->fp,buffer,len);
+        nout = epicsStrSnPrintEscaped(ptracePvt->traceBuffer,
+            ptracePvt->traceBufferSize,buffer,len);
+        errlogPrintf("%s",ptracePvt->traceBuffer);
+        return nout;
+    }
+    room = pout->size - pout->len;
+    nout = epicsStrSnPrintEscaped(pout->buffer + pout->len,room,buffer,len);
+    if(nout<0) return 0;
+    pout->len += ((size_t)nout<room) ? (size_t)nout : room - 1;
+    return nout;
+}
+
+#ifdef TRACE_USE_MUTEX
+static int traceAsyncEnabled(traceAsync *ptraceAsync)
+{
+    return ptraceAsync->enabled;
+}
+static void traceAsyncSetEnabled(traceAsync *ptraceAsync,int yesNo)
+{
+    ptraceAsync->enabled = yesNo;
+}
+static size_t traceRingFree(traceRing *pring)
+{
+    size_t used;
+
+    epicsMutexMustLock(pring->lock);
+    used = pring->used;
+    epicsMutexUnlock(pring->lock);
+    return pring->size - used;
+}
+static void traceRingSetUsed(traceRing *pring,size_t used)
+{
+    pring->used = used;
+}
+#else
+static int traceAsyncEnabled(traceAsync *ptraceAsync)
+{
+    int enabled = epicsAtomicGetIntT(&ptraceAsync->enabled);
+    epicsAtomicReadMemoryBarrier();
+    return enabled;
+}
+/*The ring must be complete before another thread sees enabled*/
+static void traceAsyncSetEnabled(traceAsync *ptraceAsync,int yesNo)
+{
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetIntT(&ptraceAsync->enabled,yesNo);
+}
+static size_t traceRingFree(traceRing *pring)
+{
+    return pring->size - epicsAtomicGetSizeT(&pring->used);
+}
+/*Must be called with pring->lock held*/
+static void traceRingSetUsed(traceRing *pring,size_t used)
+{
+    epicsAtomicSetSizeT(&pring->used,used);
+}
+#endif
+
+static void traceRingCopyIn(traceRing *pring,const void *pdata,size_t len)
+{
+    size_t first = pring->size - pring->head;
+
+    if(first>len) first = len;
+    memcpy(pring->buffer + pring->head,pdata,first);
+    memcpy(pring->buffer,(const char *)pdata + first,len - first);
+    pring->head = (pring->head + len)%pring->size;
+}
+
+static void traceRingCopyOut(traceRing *pring,void *pdata,size_t len)
+{
+    size_t first = pring->size - pring->tail;
+
+    if(first>len) first = len;
+    if(pdata) {
+        memcpy(pdata,pring->buffer + pring->tail,first);
+        memcpy((char *)pdata + first,pring->buffer,len - first);
+    }
+    pring->tail = (pring->tail + len)%pring->size;
+}
+
+/* For overflow block, wait until the ring has room for the longest message
+ * or for TRACE_BLOCK_TIMEOUT. No lock is held, so other threads can still
+ * queue messages to this ring and to the others*/
+static void traceWaitSpace(traceRing *pring)
+{
+    traceAsync *ptraceAsync = &pasynBase->traceAsync;
+    double     waited = 0.0;
+
+    while(traceRingFree(pring) < sizeof(traceRecord) + TRACE_MESSAGE_SIZE
+    && waited<TRACE_BLOCK_TIMEOUT) {
+        epicsEventSignal(ptraceAsync->notify);
+        epicsEventWaitWithTimeout(pring->spaceAvailable,0.1);
+        waited += 0.1;
+    }
+}
+
+/* Queue the message formatted in pring->message. If there is no room it is
+ * dropped and counted, unless overflow is dropOld.
+ * Must be called with pring->formatLock held*/
+static void traceQueue(traceRing *pring,traceOutput *pout)
+{
+    traceAsync  *ptraceAsync = &pasynBase->traceAsync;
+    traceRecord record;
+    size_t      need;
+    BOOL        wasEmpty;
+
+    record.fp = pout->fp;
+    record.len = pout->len;
+    need = sizeof(record) + record.len;
+    epicsMutexMustLock(pring->lock);
+    while(pring->size - pring->used < need) {
+        if(ptraceAsync->overflow==asynTraceOverflowDropOld && pring->used>0) {
+            traceRecord old;
+
+            traceRingCopyOut(pring,&old,sizeof(old));
+            traceRingCopyOut(pring,0,old.len);
+            traceRingSetUsed(pring,pring->used - sizeof(old) - old.len);
+            pring->nDropped++;
+            continue;
+        }
+        pring->nDropped++;
+        epicsMutexUnlock(pring->lock);
+        return;
+    }
+    wasEmpty = (pring->used==0);
+    traceRingCopyIn(pring,&record,sizeof(record));
+    traceRingCopyIn(pring,pout->buffer,record.len);
+    traceRingSetUsed(pring,pring->used + need);
+    if(pring->used>pring->highWater) pring->highWater = pring->used;
+    pring->nMessages++;
+    epicsMutexUnlock(pring->lock);
+    /*traceWriterThread empties all rings before it waits again*/
+    if(wasEmpty) epicsEventSignal(ptraceAsync->notify);
+}
+
+/* Write all queued messages. Must be called with lockTrace held*/
+static void traceDrain(void)
+{
+    traceAsync  *ptraceAsync = &pasynBase->traceAsync;
+    char        *message = ptraceAsync->message;
+    FILE        *lastFp = 0;
+    unsigned long nDropped = 0;
+    BOOL        more = TRUE;
+    int         i;
+
+    if(!ptraceAsync->ring) return;
+    while(more) {
+        more = FALSE;
+        for(i=0; i<NUMBER_TRACE_RINGS; i++) {
+            traceRing   *pring = &ptraceAsync->ring[i];
+            traceRecord record;
+
+            epicsMutexMustLock(pring->lock);
+            if(pring->used==0) {
+                epicsMutexUnlock(pring->lock);
+                continue;
+            }
+            traceRingCopyOut(pring,&record,sizeof(record));
+            traceRingCopyOut(pring,message,record.len);
+            traceRingSetUsed(pring,pring->used - sizeof(record) - record.len);
+            epicsMutexUnlock(pring->lock);
+            if(ptraceAsync->overflow==asynTraceOverflowBlock)
+                epicsEventSignal(pring->spaceAvailable);
+            more = TRUE;
+            message[record.len] = 0;
+            if(record.fp) {
+                if(lastFp && lastFp!=record.fp) fflush(lastFp);
+                fwrite(message,1,record.len,record.fp);
+                lastFp = record.fp;
+            } else {
+                errlogPrintf("%s",message);
+            }
+        }
+    }
+    if(lastFp) fflush(lastFp);
+    for(i=0; i<NUMBER_TRACE_RINGS; i++) nDropped += ptraceAsync->ring[i].nDropped;
+    if(nDropped!=ptraceAsync->nDroppedReported) {
+        errlogPrintf("asynTrace: %lu messages dropped\n",
+            nDropped - ptraceAsync->nDroppedReported);
+        ptraceAsync->nDroppedReported = nDropped;
+    }
+}
+
+/* Wait for messages that are being formatted then write all queued messages.
+ * Must be called with lockTrace held*/
+static void traceFlushAsync(void)
+{
+    traceAsync *ptraceAsync = &pasynBase->traceAsync;
+    int        i;
+
+    if(!ptraceAsync->ring) return;
+    for(i=0; i<NUMBER_TRACE_RINGS; i++) {
+        epicsMutexMustLock(ptraceAsync->ring[i].formatLock);
+        epicsMutexUnlock(ptraceAsync->ring[i].formatLock);
+    }
+    traceDrain();
+}
+
+static void traceWriterThread(void *arg)
+{
+    traceAsync *ptraceAsync = &pasynBase->traceAsync;
+
+    while(1) {
+        epicsEventMustWait(ptraceAsync->notify);
+        epicsMutexMustLock(pasynBase->lockTrace);
+        traceDrain();
+        epicsMutexUnlock(pasynBase->lockTrace);
+    }
+}
+
+static asynStatus setTraceAsync(int yesNo,size_t bufferSize,
+    asynTraceOverflow overflow)
+{
+    traceAsync *ptraceAsync;
+    int        i;
+
+    if(!pasynBase) asynInit();
+    ptraceAsync = &pasynBase->traceAsync;
+    if(overflow<asynTraceOverflowDropNew || overflow>asynTraceOverflowBlock) {
+        printf("asynManager:setTraceAsync illegal overflow %d\n",(int)overflow);
+        return asynError;
+    }
+    if(bufferSize && bufferSize<2*TRACE_MESSAGE_SIZE) {
+        printf("asynManager:setTraceAsync bufferSize must be at least %d\n",
+            2*TRACE_MESSAGE_SIZE);
+        return asynError;
+    }
+    epicsMutexMustLock(pasynBase->lockTrace);
+    if(yesNo && !ptraceAsync->ring) {
+        traceRing *pring;
+
+        if(!bufferSize) bufferSize = DEFAULT_TRACE_ASYNC_BUFFER_SIZE;
+        pring = callocMustSucceed(NUMBER_TRACE_RINGS,sizeof(traceRing),
+            "asynManager:setTraceAsync");
+        for(i=0; i<NUMBER_TRACE_RINGS; i++) {
+            pring[i].formatLock = epicsMutexMustCreate();
+            pring[i].lock = epicsMutexMustCreate();
+            pring[i].spaceAvailable = epicsEventMustCreate(epicsEventEmpty);
+            pring[i].buffer = callocMustSucceed(bufferSize,sizeof(char),
+                "asynManager:setTraceAsync");
+            pring[i].size = bufferSize;
+        }
+        ptraceAsync->bufferSize = bufferSize;
+        ptraceAsync->notify = epicsEventMustCreate(epicsEventEmpty);
+        ptraceAsync->ring = pring;
+        epicsThreadCreate("asynTrace",epicsThreadPriorityLow,
+            epicsThreadGetStackSize(epicsThreadStackSmall),
+            traceWriterThread,0);
+    } else if(bufferSize && bufferSize!=ptraceAsync->bufferSize
+    && ptraceAsync->ring) {
+        printf("asynManager:setTraceAsync bufferSize can not be changed "
+            "and remains %lu\n",(unsigned long)ptraceAsync->bufferSize);
+    }
+    ptraceAsync->overflow = overflow;
+    traceAsyncSetEnabled(ptraceAsync,(yesNo ? TRUE : FALSE));
+    if(!yesNo) traceFlushAsync();
+    epicsMutexUnlock(pasynBase->lockTrace);
+    return asynSuccess;
+}
+
+/* Sets the file of the port pasynUser is connected to, or the file used by
+ * all other ports if it is not connected*/
+static asynStatus setTraceBinaryFile(asynUser *pasynUser,
+    const char *fileName,size_t size)
+{
+    userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
+    port     *pport = puserPvt->pport;
+    asynTraceBinaryFile *pfile;
+
+    if(!pasynBase) asynInit();
+    if(pport) {
+        epicsMutexMustLock(pport->asynManagerLock);
+        if(!pport->traceBinaryFile)
+            pport->traceBinaryFile = asynTraceBinaryCreate();
+        pfile = pport->traceBinaryFile;
+        epicsMutexUnlock(pport->asynManagerLock);
+    } else {
+        pfile = pasynBase->traceBinaryFile;
+    }
+    if(!fileName || strlen(fileName)==0) {
+        asynTraceBinaryClose(pfile);
+        return asynSuccess;
+    }
+    if(!size) size = DEFAULT_TRACE_BINARY_SIZE;
+    if(asynTraceBinaryOpen(pfile,fileName,size)) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+            "asynManager:setTraceBinaryFile can not open %s",fileName);
+        return asynError;
+    }
+    return asynSuccess;
+}
+
+/* Store the data of printIO in the binary trace file of the port or, if the
+ * port has none, in the default file.
+ * Returns FALSE if neither file is open. pvar has then been used, the
+ * caller prints message, which has TRACE_BINARY_MESSAGE_SIZE characters*/
+static BOOL traceBinaryIO(asynUser *pasynUser,int reason,
+    asynTraceIODirection direction,const char *buffer,size_t nBytes,size_t len,
+    char *message,const char *pformat,va_list pvar)
+{
+    userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
+    port     *pport = puserPvt->pport;
+    const char *portName = pport ? pport->portName : "";
+    asynTraceBinaryRecord record;
+    epicsTimeStamp now;
+    int      nout;
+    int      addr = -1;
+
+    epicsTimeGetCurrent(&now);
+    if(pport) getAddr(pasynUser,&addr);
+    nout = epicsVsnprintf(message,TRACE_BINARY_MESSAGE_SIZE,pformat,pvar);
+    if(nout<0) nout = 0;
+    if(nout>=TRACE_BINARY_MESSAGE_SIZE) nout = TRACE_BINARY_MESSAGE_SIZE - 1;
+    message[nout] = 0;
+    memset(&record,0,sizeof(record));
+    record.secPastEpoch = now.secPastEpoch;
+    record.nsec = now.nsec;
+    record.addr = addr;
+    record.reason = pasynUser->reason;
+    record.traceReason = reason;
+    record.direction = direction;
+    record.nBytes = (epicsUInt32)nBytes;
+    record.len = (epicsUInt32)len;
+    record.portNameLen = (epicsUInt16)strlen(portName);
+    record.messageLen = (epicsUInt16)nout;
+    if(pport && pport->traceBinaryFile
+    && asynTraceBinaryWrite(pport->traceBinaryFile,&record,
+        portName,message,buffer)) return TRUE;
+    return asynTraceBinaryWrite(pasynBase->traceBinaryFile,&record,
+        portName,message,buffer) ? TRUE : FALSE;
+}
+
+static void reportTraceAsync(FILE *fp)
+{
+    traceAsync    *ptraceAsync = &pasynBase->traceAsync;
+    unsigned long nMessages = 0, nDropped = 0;
+    size_t        used = 0, highWater = 0;
+    int           i;
+
+    if(!ptraceAsync->ring) return;
+    for(i=0; i<NUMBER_TRACE_RINGS; i++) {
+        traceRing *pring = &ptraceAsync->ring[i];
+
+        epicsMutexMustLock(pring->lock);
+        nMessages += pring->nMessages;
+        nDropped += pring->nDropped;
+        used += pring->used;
+        if(pring->highWater>highWater) highWater = pring->highWater;
+        epicsMutexUnlock(pring->lock);
+    }
+    fprintf(fp,"asynTrace asynchronous:%s overflow:%s bufferSize %lu\n",
+        (ptraceAsync->enabled ? "Yes" : "No"),
+        ((ptraceAsync->overflow==asynTraceOverflowDropOld) ? "dropOld" :
+         (ptraceAsync->overflow==asynTraceOverflowBlock) ? "block" : "dropNew"),
+        (unsigned long)ptraceAsync->bufferSize);
+    fprintf(fp,"    messages %lu dropped %lu queued bytes %lu highWater %lu\n",
+        nMessages,nDropped,(unsigned long)used,(unsigned long)highWater);
+}
+
+/* Start a trace message. It is either written while holding lockTrace or,
+ * for asynchronous trace, formatted into a traceRing while holding its
+ * formatLock. Returns the traceRing or 0*/
+static traceRing *traceBegin(asynUser *pasynUser,traceOutput *pout)
+{
+    traceAsync *ptraceAsync = &pasynBase->traceAsync;
+    traceRing  *pring;
+
+    /*ring is never freed and is set before enabled*/
+    if(!traceAsyncEnabled(ptraceAsync)) {
+        epicsMutexMustLock(pasynBase->lockTrace);
+        pout->fp = getTraceFile(pasynUser);
+        pout->buffer = 0;
+        return 0;
+    }
+    pring = ptraceAsync->ring + threadHash()%NUMBER_TRACE_RINGS;
+    if(ptraceAsync->overflow==asynTraceOverflowBlock) traceWaitSpace(pring);
+    epicsMutexMustLock(pring->formatLock);
+    pout->fp = getTraceFile(pasynUser);
+    pout->buffer = pring->message;
+    pout->size = sizeof(pring->message);
+    pout->len = 0;
+    return pring;
+}
+
+static void traceEnd(traceRing *pring,traceOutput *pout)
+{
+    if(!pring) {
+        fflush(pout->fp);
+        epicsMutexUnlock(pasynBase->lockTrace);
+        return;
+    }
+    traceQueue(pring,pout);
+    epicsMutexUnlock(pring->formatLock);
+}
+
+static size_t printThread(traceOutput *pout)
+{
+    unsigned int threadPriority = epicsThreadGetPrioritySelf();
+    epicsThreadId threadId = epicsThreadGetIdSelf();
+
+    return traceOutputPrintf(pout,"[%s,%p,%u] ",epicsThreadGetNameSelf(),
+                             (void*)threadId,threadPriority);
+}
+
+static size_t printTime(traceOutput *pout)
 {
     epicsTimeStamp now;
     char nowText[40];
@@ -2823,44 +4169,28 @@ static size_t printTime(FILE *fp)
     nowText[0] = 0;
     epicsTimeToStrftime(nowText,sizeof(nowText),
          "%Y/%m/%d %H:%M:%S.%03f",&now);
-    if(fp) {
-        return fprintf(fp,"%s ",nowText);
-    } else {
-        return errlogPrintf("%s ",nowText);
-    }
+    return traceOutputPrintf(pout,"%s ",nowText);
 }
 
-static size_t printPort(FILE *fp, asynUser *pasynUser)
+static size_t printPort(traceOutput *pout, asynUser *pasynUser)
 {
     userPvt *puserPvt = asynUserToUserPvt(pasynUser);
     port    *pport = puserPvt->pport;
     int addr;
-    size_t nout = 0;
 
     if(!pport) {
-        return nout;
+        return 0;
     }
 
     getAddr(pasynUser, &addr);
-    if(fp) {
-        nout = fprintf(fp,"[%s,%d,%d] ",pport->portName, addr, pasynUser->reason);
-    } else {
-        nout = errlogPrintf("[%s,%d,%d] ",pport->portName, addr, pasynUser->reason);
-    }
-    return nout;
+    return traceOutputPrintf(pout,"[%s,%d,%d] ",pport->portName, addr, pasynUser->reason);
 }
 
-static size_t printSource(FILE *fp, const char *file, int line)
+static size_t printSource(traceOutput *pout, const char *file, int line)
 {
-    int      nout = 0;
     file = asynStripPath(file);
 
-    if(fp) {
-        nout = fprintf(fp,"[%s:%d] ", file, line);
-    } else {
-        nout = errlogPrintf("[%s:%d] ", file, line);
-    }
-    return nout;
+    return traceOutputPrintf(pout,"[%s:%d] ", file, line);
 }
 
 static int tracePrint(asynUser *pasynUser,int reason, const char *pformat, ...)
@@ -2895,23 +4225,18 @@ static int traceVprintSource(asynUser *pasynUser,int reason, const char *file, i
     userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
     tracePvt *ptracePvt  = findTracePvt(puserPvt);
     int      nout = 0;
-    FILE     *fp;
+    traceOutput out;
+    traceRing *pring;
 
     file = asynStripPath(file);
     if(!(reason & ptracePvt->traceMask)) return 0;
-    epicsMutexMustLock(pasynBase->lockTrace);
-    fp = getTraceFile(pasynUser);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_TIME) nout += (int)printTime(fp);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_PORT) nout += (int)printPort(fp, pasynUser);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_SOURCE) nout += (int)printSource(fp, file, line);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_THREAD) nout += (int)printThread(fp);
-    if(fp) {
-        nout += vfprintf(fp,pformat,pvar);
-    } else {
-        nout += errlogVprintf(pformat,pvar);
-    }
-    fflush(fp);
-    epicsMutexUnlock(pasynBase->lockTrace);
+    pring = traceBegin(pasynUser,&out);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_TIME) nout += (int)printTime(&out);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_PORT) nout += (int)printPort(&out, pasynUser);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_SOURCE) nout += (int)printSource(&out, file, line);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_THREAD) nout += (int)printThread(&out);
+    nout += traceOutputV(&out,pformat,pvar);
+    traceEnd(pring,&out);
     return nout;
 }
 
@@ -2947,83 +4272,79 @@ static int traceVprintIO(asynUser *pasynUser,int reason,
 
 static int traceVprintIOSource(asynUser *pasynUser,int reason,
     const char *buffer, size_t len, const char *file, int line, const char *pformat, va_list pvar)
+{
+    return traceVprintIODirection(pasynUser, reason, asynTraceIOUnknown,
+        buffer, len, file, line, pformat, pvar);
+}
+
+static int tracePrintIODirectionSource(asynUser *pasynUser,int reason,
+    asynTraceIODirection direction,
+    const char *buffer, size_t len, const char *file, int line, const char *pformat, ...)
+{
+    va_list  pvar;
+    int      nout = 0;
+
+    va_start(pvar,pformat);
+    nout = traceVprintIODirection(pasynUser, reason, direction, buffer, len, file, line, pformat, pvar);
+    va_end(pvar);
+    return nout;
+}
+
+static int traceVprintIODirection(asynUser *pasynUser,int reason,
+    asynTraceIODirection direction,
+    const char *buffer, size_t len, const char *file, int line, const char *pformat, va_list pvar)
 {
     userPvt  *puserPvt = asynUserToUserPvt(pasynUser);
     tracePvt *ptracePvt  = findTracePvt(puserPvt);
     int      nout = 0;
-    FILE     *fp;
+    traceOutput out;
+    traceRing *pring;
     int traceMask,traceIOMask;
     size_t traceTruncateSize,nBytes;
+    char message[TRACE_BINARY_MESSAGE_SIZE];
+    BOOL formatted = FALSE;
 
     traceMask = ptracePvt->traceMask;
     traceIOMask = ptracePvt->traceIOMask;
     traceTruncateSize = ptracePvt->traceTruncateSize;
     if(!(reason&traceMask)) return 0;
-    epicsMutexMustLock(pasynBase->lockTrace);
-    fp = getTraceFile(pasynUser);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_TIME) nout += (int)printTime(fp);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_PORT) nout += (int)printPort(fp, pasynUser);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_SOURCE) nout += (int)printSource(fp, file, line);
-    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_THREAD) nout += (int)printThread(fp);
-    if(fp) {
-        nout += vfprintf(fp,pformat,pvar);
-    } else {
-        nout += errlogVprintf(pformat,pvar);
-    }
     nBytes = (len<traceTruncateSize) ? len : traceTruncateSize;
+    if(traceIOMask&ASYN_TRACEIO_BINARY) {
+        if(traceBinaryIO(pasynUser,reason,direction,buffer,nBytes,len,
+            message,pformat,pvar)) return 0;
+        formatted = TRUE;
+    }
+    pring = traceBegin(pasynUser,&out);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_TIME) nout += (int)printTime(&out);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_PORT) nout += (int)printPort(&out, pasynUser);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_SOURCE) nout += (int)printSource(&out, file, line);
+    if (ptracePvt->traceInfoMask & ASYN_TRACEINFO_THREAD) nout += (int)printThread(&out);
+    if(formatted) nout += traceOutputPrintf(&out,"%s",message);
+    else nout += traceOutputV(&out,pformat,pvar);
     if((traceIOMask&ASYN_TRACEIO_ASCII) && (nBytes>0)) {
-       if(fp) {
-           nout += fprintf(fp,"%.*s\n",(int)nBytes,buffer);
-       } else {
-           nout += errlogPrintf("%.*s\n",(int)nBytes,buffer);
-       }
+        nout += traceOutputPrintf(&out,"%.*s\n",(int)nBytes,buffer);
     }
     if(traceIOMask&ASYN_TRACEIO_ESCAPE) {
         if(nBytes>0) {
-            if(fp) {
-                nout += epicsStrPrintEscaped(fp,buffer,nBytes);
-                nout += fprintf(fp,"\n");
-            } else {
-                nout += epicsStrSnPrintEscaped(ptracePvt->traceBuffer,
-                                               ptracePvt->traceBufferSize,
-                                               buffer,
-                                               nBytes);
-                errlogPrintf("%s\n",ptracePvt->traceBuffer);
-            }
+            nout += traceOutputEscaped(&out,ptracePvt,buffer,nBytes);
+            nout += traceOutputPrintf(&out,"\n");
         }
     }
     if((traceIOMask&ASYN_TRACEIO_HEX) && (traceTruncateSize>0)) {
         size_t i;
         for(i=0; i<nBytes; i++) {
             if(i%20 == 0) {
-                if(fp) {
-                    nout += fprintf(fp,"\n");
-                } else {
-                    nout += errlogPrintf("\n");
-                }
-            }
-            if(fp) {
-                nout += fprintf(fp,"%2.2x ",(unsigned char)buffer[i]);
-            } else {
-                nout += errlogPrintf("%2.2x ",(unsigned char)buffer[i]);
+                nout += traceOutputPrintf(&out,"\n");
             }
+            nout += traceOutputPrintf(&out,"%2.2x ",(unsigned char)buffer[i]);
         }
-        if(fp) {
-            nout += fprintf(fp,"\n");
-        } else {
-            nout += errlogPrintf("\n");
-        }
+        nout += traceOutputPrintf(&out,"\n");
     }
     /* If the traceIOMask is 0 or traceTruncateSize <=0 we need to output a newline */
     if((traceIOMask == 0) || (traceTruncateSize <=0)) {
-        if(fp) {
-            nout += fprintf(fp,"\n");
-        } else {
-            nout += errlogPrintf("\n");
-        }
+        nout += traceOutputPrintf(&out,"\n");
     }
-    fflush(fp);
-    epicsMutexUnlock(pasynBase->lockTrace);
+    traceEnd(pring,&out);
     return nout;
 }
 
@@ -0,0 +1,261 @@
+/* asynTraceBinary.c */
+/***********************************************************************
+* Copyright (c) 2002 The University of Chicago, as Operator of Argonne
+* National Laboratory, and the Regents of the University of
+* California, as Operator of Los Alamos National Laboratory, and
+* Berliner Elektronenspeicherring-Gesellschaft m.b.H. (BESSY).
+* asynDriver is distributed subject to a Software License Agreement
+* found in file LICENSE that is included with this distribution.
+***********************************************************************/
+
+/* Circular binary trace capture file.
+ * On Unix the file is memory mapped, so records reach the file even if the
+ * IOC crashes. On other systems the data is kept in memory and written to
+ * the file when it is closed.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#if !defined(vxWorks) && !defined(__rtems__) && !defined(_WIN32)
+#define USE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include <errlog.h>
+#include <cantProceed.h>
+#include <epicsString.h>
+#include <epicsMutex.h>
+
+#include "asynTraceBinary.h"
+
+#define ALIGN(n) (((n) + ASYN_TRACE_BINARY_ALIGN - 1) & ~(size_t)(ASYN_TRACE_BINARY_ALIGN - 1))
+
+struct asynTraceBinaryFile {
+    epicsMutexId          lock;
+    char                  *fileName;
+    asynTraceBinaryHeader *pheader; /*0 if no file is open*/
+    char                  *data;
+    size_t                mapSize;
+};
+
+asynTraceBinaryFile *asynTraceBinaryCreate(void)
+{
+    asynTraceBinaryFile *pfile;
+
+    pfile = callocMustSucceed(1,sizeof(asynTraceBinaryFile),"asynTraceBinaryCreate");
+    pfile->lock = epicsMutexMustCreate();
+    return pfile;
+}
+
+/* Returns the header followed by the data area, or 0*/
+static char *mapFile(const char *fileName,size_t mapSize)
+{
+    char *pmap;
+
+#ifdef USE_MMAP
+    int fd;
+
+    fd = open(fileName,O_RDWR|O_CREAT|O_TRUNC,0644);
+    if(fd<0) {
+        errlogPrintf("asynTraceBinaryOpen %s open error %s\n",
+            fileName,strerror(errno));
+        return 0;
+    }
+    if(ftruncate(fd,(off_t)mapSize)!=0) {
+        errlogPrintf("asynTraceBinaryOpen %s ftruncate error %s\n",
+            fileName,strerror(errno));
+        close(fd);
+        return 0;
+    }
+    pmap = mmap(0,mapSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    close(fd);
+    if(pmap==MAP_FAILED) {
+        errlogPrintf("asynTraceBinaryOpen %s mmap error %s\n",
+            fileName,strerror(errno));
+        return 0;
+    }
+#else
+    FILE *fp = fopen(fileName,"wb");
+
+    if(!fp) {
+        errlogPrintf("asynTraceBinaryOpen %s fopen error %s\n",
+            fileName,strerror(errno));
+        return 0;
+    }
+    fclose(fp);
+    pmap = calloc(1,mapSize);
+    if(!pmap) {
+        errlogPrintf("asynTraceBinaryOpen %s can not allocate %lu bytes\n",
+            fileName,(unsigned long)mapSize);
+        return 0;
+    }
+#endif
+    return pmap;
+}
+
+static void unmapFile(const char *fileName,char *pmap,size_t mapSize)
+{
+#ifdef USE_MMAP
+    msync((void *)pmap,mapSize,MS_SYNC);
+    munmap((void *)pmap,mapSize);
+#else
+    FILE *fp = fopen(fileName,"wb");
+
+    if(!fp || fwrite(pmap,1,mapSize,fp)!=mapSize) {
+        errlogPrintf("asynTraceBinaryClose %s write error %s\n",
+            fileName,strerror(errno));
+    }
+    if(fp) fclose(fp);
+    free(pmap);
+#endif
+}
+
+int asynTraceBinaryOpen(asynTraceBinaryFile *pfile,const char *fileName,
+    size_t dataSize)
+{
+    asynTraceBinaryHeader *pheader;
+    size_t                headerSize = ALIGN(sizeof(asynTraceBinaryHeader));
+    size_t                mapSize;
+    char                  *pmap;
+
+    dataSize = ALIGN(dataSize);
+    if(dataSize<1024 || dataSize>0x7fffffff) {
+        errlogPrintf("asynTraceBinaryOpen %s illegal size %lu\n",
+            fileName,(unsigned long)dataSize);
+        return -1;
+    }
+    mapSize = headerSize + dataSize;
+    /* Close first, the new file may replace the old one*/
+    asynTraceBinaryClose(pfile);
+    pmap = mapFile(fileName,mapSize);
+    if(!pmap) return -1;
+    memset(pmap,0,headerSize);
+    pheader = (asynTraceBinaryHeader *)pmap;
+    strcpy(pheader->magic,ASYN_TRACE_BINARY_MAGIC);
+    pheader->byteOrder = ASYN_TRACE_BINARY_BYTE_ORDER;
+    pheader->version = ASYN_TRACE_BINARY_VERSION;
+    pheader->headerSize = (epicsUInt32)headerSize;
+    pheader->dataSize = (epicsUInt32)dataSize;
+    epicsMutexMustLock(pfile->lock);
+    pfile->fileName = epicsStrDup(fileName);
+    pfile->mapSize = mapSize;
+    pfile->data = pmap + headerSize;
+    pfile->pheader = pheader;
+    epicsMutexUnlock(pfile->lock);
+    return 0;
+}
+
+/* Discard the oldest records until there are size free bytes*/
+static void reclaim(asynTraceBinaryFile *pfile,epicsUInt32 size)
+{
+    asynTraceBinaryHeader *pheader = pfile->pheader;
+
+    while(pheader->dataSize - pheader->used < size) {
+        asynTraceBinaryRecord *pold =
+            (asynTraceBinaryRecord *)(pfile->data + pheader->tail);
+
+        if(pold->size>=sizeof(asynTraceBinaryRecord) && pold->traceReason)
+            pheader->nOverwritten++;
+        pheader->used -= pold->size;
+        pheader->tail += pold->size;
+        if(pheader->tail>=pheader->dataSize) pheader->tail = 0;
+    }
+}
+
+int asynTraceBinaryWrite(asynTraceBinaryFile *pfile,
+    asynTraceBinaryRecord *precord, const char *portName,
+    const char *message, const char *data)
+{
+    asynTraceBinaryHeader *pheader;
+    epicsUInt32           size;
+    char                  *pnext;
+
+    epicsMutexMustLock(pfile->lock);
+    pheader = pfile->pheader;
+    if(!pheader) {
+        epicsMutexUnlock(pfile->lock);
+        return 0;
+    }
+    size = (epicsUInt32)ALIGN(sizeof(asynTraceBinaryRecord)
+        + precord->portNameLen + precord->messageLen + precord->nBytes);
+    if(size>pheader->dataSize) {
+        pheader->nDropped++;
+        epicsMutexUnlock(pfile->lock);
+        return 1;
+    }
+    if(pheader->head + size > pheader->dataSize) {
+        /* Pad to the end of the data area and wrap*/
+        asynTraceBinaryRecord *ppad =
+            (asynTraceBinaryRecord *)(pfile->data + pheader->head);
+        epicsUInt32 padSize = pheader->dataSize - pheader->head;
+
+        reclaim(pfile,padSize);
+        memset(ppad,0,(padSize<sizeof(asynTraceBinaryRecord)) ?
+            padSize : sizeof(asynTraceBinaryRecord));
+        ppad->magic = ASYN_TRACE_BINARY_RECORD_MAGIC;
+        ppad->size = padSize;
+        pheader->used += padSize;
+        pheader->head = 0;
+    }
+    reclaim(pfile,size);
+    precord->magic = ASYN_TRACE_BINARY_RECORD_MAGIC;
+    precord->size = size;
+    pnext = pfile->data + pheader->head;
+    memcpy(pnext,precord,sizeof(asynTraceBinaryRecord));
+    pnext += sizeof(asynTraceBinaryRecord);
+    memcpy(pnext,portName,precord->portNameLen);
+    pnext += precord->portNameLen;
+    memcpy(pnext,message,precord->messageLen);
+    pnext += precord->messageLen;
+    memcpy(pnext,data,precord->nBytes);
+    pheader->used += size;
+    pheader->head += size;
+    if(pheader->head>=pheader->dataSize) pheader->head = 0;
+    pheader->nRecords++;
+    epicsMutexUnlock(pfile->lock);
+    return 1;
+}
+
+void asynTraceBinaryClose(asynTraceBinaryFile *pfile)
+{
+    char   *fileName;
+    char   *pmap;
+    size_t mapSize;
+
+    epicsMutexMustLock(pfile->lock);
+    fileName = pfile->fileName;
+    pmap = (char *)pfile->pheader;
+    mapSize = pfile->mapSize;
+    pfile->fileName = 0;
+    pfile->pheader = 0;
+    pfile->data = 0;
+    pfile->mapSize = 0;
+    epicsMutexUnlock(pfile->lock);
+    if(pmap) unmapFile(fileName,pmap,mapSize);
+    free(fileName);
+}
+
+void asynTraceBinaryReport(asynTraceBinaryFile *pfile,FILE *fp,
+    const char *prefix)
+{
+    asynTraceBinaryHeader *pheader;
+
+    epicsMutexMustLock(pfile->lock);
+    pheader = pfile->pheader;
+    if(pheader) {
+        fprintf(fp,"%sasynTrace binary file %s dataSize %lu used %lu\n",
+            prefix,pfile->fileName,(unsigned long)pheader->dataSize,
+            (unsigned long)pheader->used);
+        fprintf(fp,"%s    records %lu overwritten %lu dropped %lu\n",
+            prefix,(unsigned long)pheader->nRecords,
+            (unsigned long)pheader->nOverwritten,
+            (unsigned long)pheader->nDropped);
+    }
+    epicsMutexUnlock(pfile->lock);
+}
@@ -0,0 +1,93 @@
+/* asynTraceBinary.h */
+/***********************************************************************
+* Copyright (c) 2002 The University of Chicago, as Operator of Argonne
+* National Laboratory, and the Regents of the University of
+* California, as Operator of Los Alamos National Laboratory, and
+* Berliner Elektronenspeicherring-Gesellschaft m.b.H. (BESSY).
+* asynDriver is distributed subject to a Software License Agreement
+* found in file LICENSE that is included with this distribution.
+***********************************************************************/
+
+/* Binary trace capture file
+ *
+ * When the traceIO mask of a port or device includes ASYN_TRACEIO_BINARY
+ * asynPrintIO stores the raw bytes in a circular file instead of formatting
+ * them. Each port can have its own file, other ports use a default file.
+ * The file is a asynTraceBinaryHeader followed by a data area of
+ * dataSize bytes. The data area holds a sequence of records starting at
+ * offset tail and ending at offset head, wrapping at dataSize. The oldest
+ * records are overwritten when the data area is full. A record that is
+ * shorter than asynTraceBinaryRecord or has traceReason 0 is padding and is
+ * skipped. All values are in the byte
+ * order of the IOC, byteOrder can be used to detect this.
+ * asynTraceDecode renders the file as text.
+ */
+
+#ifndef ASYNTRACEBINARY_H
+#define ASYNTRACEBINARY_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <epicsTypes.h>
+#include <asynAPI.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif  /* __cplusplus */
+
+#define ASYN_TRACE_BINARY_MAGIC         "asynTRC"
+#define ASYN_TRACE_BINARY_BYTE_ORDER    0x01020304
+#define ASYN_TRACE_BINARY_VERSION       2
+#define ASYN_TRACE_BINARY_RECORD_MAGIC  0x41545243
+#define ASYN_TRACE_BINARY_ALIGN         8
+
+typedef struct asynTraceBinaryHeader {
+    char        magic[8];     /* ASYN_TRACE_BINARY_MAGIC */
+    epicsUInt32 byteOrder;    /* ASYN_TRACE_BINARY_BYTE_ORDER */
+    epicsUInt32 version;      /* ASYN_TRACE_BINARY_VERSION */
+    epicsUInt32 headerSize;   /* offset of the data area */
+    epicsUInt32 dataSize;     /* size of the data area */
+    epicsUInt32 head;         /* offset at which the next record is written */
+    epicsUInt32 tail;         /* offset of the oldest record */
+    epicsUInt32 used;         /* bytes between tail and head */
+    epicsUInt32 nRecords;     /* records written */
+    epicsUInt32 nOverwritten; /* records overwritten by newer records */
+    epicsUInt32 nDropped;     /* records larger than the data area */
+}asynTraceBinaryHeader;
+
+typedef struct asynTraceBinaryRecord {
+    epicsUInt32 magic;        /* ASYN_TRACE_BINARY_RECORD_MAGIC */
+    epicsUInt32 size;         /* size of the record including padding */
+    epicsUInt32 secPastEpoch; /* epicsTimeStamp of the call to asynPrintIO */
+    epicsUInt32 nsec;
+    epicsInt32  addr;
+    epicsInt32  reason;       /* pasynUser->reason */
+    epicsUInt32 traceReason;  /* ASYN_TRACEIO_DEVICE, _FILTER or _DRIVER */
+    epicsUInt32 direction;    /* asynTraceIODirection of the caller */
+    epicsUInt32 nBytes;       /* bytes of data stored */
+    epicsUInt32 len;          /* len passed to asynPrintIO */
+    epicsUInt16 portNameLen;
+    epicsUInt16 messageLen;
+    /* followed by portName, message and nBytes of data */
+}asynTraceBinaryRecord;
+
+/* An asynTraceBinaryFile has its own mutex, so ports that use different
+ * files do not wait for each other. It is created once and never freed.
+ * Open and Close replace the underlying file while other threads may call
+ * Write, which does nothing and returns 0 if no file is open */
+typedef struct asynTraceBinaryFile asynTraceBinaryFile;
+
+ASYN_API asynTraceBinaryFile *asynTraceBinaryCreate(void);
+ASYN_API int asynTraceBinaryOpen(asynTraceBinaryFile *pfile,
+    const char *fileName, size_t dataSize);
+ASYN_API int asynTraceBinaryWrite(asynTraceBinaryFile *pfile,
+    asynTraceBinaryRecord *precord, const char *portName,
+    const char *message, const char *data);
+ASYN_API void asynTraceBinaryClose(asynTraceBinaryFile *pfile);
+ASYN_API void asynTraceBinaryReport(asynTraceBinaryFile *pfile, FILE *fp,
+    const char *prefix);
+
+#ifdef __cplusplus
+}
+#endif  /* __cplusplus */
+#endif  /* ASYNTRACEBINARY_H */
@@ -0,0 +1,207 @@
+/* asynTraceDecode.c */
+/***********************************************************************
+* Copyright (c) 2002 The University of Chicago, as Operator of Argonne
+* National Laboratory, and the Regents of the University of
+* California, as Operator of Los Alamos National Laboratory, and
+* Berliner Elektronenspeicherring-Gesellschaft m.b.H. (BESSY).
+* asynDriver is distributed subject to a Software License Agreement
+* found in file LICENSE that is included with this distribution.
+***********************************************************************/
+
+/* Render a binary trace capture file as asynPrintIO text output.
+ * Usage: asynTraceDecode [-a] [-e] [-x] [-r] [-w] [-n truncateSize] fileName
+ *   -a  ASYN_TRACEIO_ASCII
+ *   -e  ASYN_TRACEIO_ESCAPE (the default if none of -a -e -x are given)
+ *   -x  ASYN_TRACEIO_HEX
+ *   -r  only show records from asynPrintIORead
+ *   -w  only show records from asynPrintIOWrite
+ *   -n  maximum number of bytes of data to show for each record
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#include <epicsTime.h>
+#include <epicsString.h>
+
+#include "asynDriver.h"
+#include "asynTraceBinary.h"
+
+static void usage(void)
+{
+    fprintf(stderr,"usage: asynTraceDecode [-a] [-e] [-x] [-r] [-w] [-n truncateSize] fileName\n");
+}
+
+static const char *directionName(epicsUInt32 direction)
+{
+    switch(direction) {
+    case asynTraceIORead:  return "read";
+    case asynTraceIOWrite: return "write";
+    default:               return "?";
+    }
+}
+
+/* The port name, message and data must fit in the record, which decode
+ * has already checked is inside the data area*/
+static int recordIsValid(const asynTraceBinaryRecord *precord)
+{
+    size_t room = precord->size - sizeof(asynTraceBinaryRecord);
+
+    if(precord->portNameLen>room) return 0;
+    room -= precord->portNameLen;
+    if(precord->messageLen>room) return 0;
+    room -= precord->messageLen;
+    if(precord->nBytes>room || precord->nBytes>precord->len) return 0;
+    return 1;
+}
+
+static void printRecord(const asynTraceBinaryRecord *precord,
+    int traceIOMask,size_t truncateSize)
+{
+    const char     *portName = (const char *)(precord + 1);
+    const char     *message = portName + precord->portNameLen;
+    const char     *buffer = message + precord->messageLen;
+    epicsTimeStamp stamp;
+    char           stampText[40];
+    size_t         nBytes = precord->nBytes;
+
+    if(nBytes>truncateSize) nBytes = truncateSize;
+    stamp.secPastEpoch = precord->secPastEpoch;
+    stamp.nsec = precord->nsec;
+    stampText[0] = 0;
+    epicsTimeToStrftime(stampText,sizeof(stampText),
+         "%Y/%m/%d %H:%M:%S.%03f",&stamp);
+    printf("%s [%.*s,%d,%d,%s] %.*s",stampText,
+        (int)precord->portNameLen,portName,precord->addr,precord->reason,
+        directionName(precord->direction),
+        (int)precord->messageLen,message);
+    if((traceIOMask&ASYN_TRACEIO_ASCII) && (nBytes>0)) {
+        printf("%.*s\n",(int)nBytes,buffer);
+    }
+    if((traceIOMask&ASYN_TRACEIO_ESCAPE) && (nBytes>0)) {
+        epicsStrPrintEscaped(stdout,buffer,nBytes);
+        printf("\n");
+    }
+    if((traceIOMask&ASYN_TRACEIO_HEX) && (nBytes>0)) {
+        size_t i;
+        for(i=0; i<nBytes; i++) {
+            if(i%20 == 0) printf("\n");
+            printf("%2.2x ",(unsigned char)buffer[i]);
+        }
+        printf("\n");
+    }
+    if(traceIOMask==0 || nBytes==0) printf("\n");
+}
+
+/* Print the records of a file read into pfile. Returns 0 or 1 on error*/
+static int decode(const char *fileName,char *pfile,long fileSize,
+    int traceIOMask,size_t truncateSize,int directionMask)
+{
+    asynTraceBinaryHeader *pheader = (asynTraceBinaryHeader *)pfile;
+    char                  *data;
+    epicsUInt32           offset, used;
+
+    if(fileSize<(long)sizeof(asynTraceBinaryHeader)
+    || strcmp(pheader->magic,ASYN_TRACE_BINARY_MAGIC)!=0) {
+        fprintf(stderr,"%s: not an asyn binary trace file\n",fileName);
+        return 1;
+    }
+    if(pheader->byteOrder!=ASYN_TRACE_BINARY_BYTE_ORDER
+    || pheader->version!=ASYN_TRACE_BINARY_VERSION) {
+        fprintf(stderr,"%s: unsupported byte order or version %u\n",
+            fileName,(unsigned)pheader->version);
+        return 1;
+    }
+    if((long)pheader->headerSize + (long)pheader->dataSize > fileSize
+    || pheader->tail>=pheader->dataSize || pheader->used>pheader->dataSize) {
+        fprintf(stderr,"%s: file is truncated or corrupt\n",fileName);
+        return 1;
+    }
+    data = pfile + pheader->headerSize;
+    offset = pheader->tail;
+    used = pheader->used;
+    while(used>0) {
+        asynTraceBinaryRecord *precord = (asynTraceBinaryRecord *)(data + offset);
+
+        if(precord->magic!=ASYN_TRACE_BINARY_RECORD_MAGIC
+        || precord->size==0 || precord->size>used
+        || offset + precord->size > pheader->dataSize) {
+            fprintf(stderr,"%s: corrupt record at offset %u\n",
+                fileName,(unsigned)offset);
+            return 1;
+        }
+        if(precord->size>=sizeof(asynTraceBinaryRecord) && precord->traceReason) {
+            if(!recordIsValid(precord)) {
+                fprintf(stderr,"%s: corrupt record at offset %u\n",
+                    fileName,(unsigned)offset);
+                return 1;
+            }
+            if(!directionMask || (precord->direction<=asynTraceIOWrite
+                && (directionMask & (1<<precord->direction))))
+                printRecord(precord,traceIOMask,truncateSize);
+        }
+        used -= precord->size;
+        offset += precord->size;
+        if(offset>=pheader->dataSize) offset = 0;
+    }
+    if(pheader->nOverwritten || pheader->nDropped) {
+        fprintf(stderr,"%s: %u records overwritten, %u records dropped\n",
+            fileName,(unsigned)pheader->nOverwritten,(unsigned)pheader->nDropped);
+    }
+    return 0;
+}
+
+int main(int argc,char **argv)
+{
+    const char            *fileName = 0;
+    int                   traceIOMask = 0;
+    int                   directionMask = 0;
+    size_t                truncateSize = (size_t)-1;
+    FILE                  *fp;
+    long                  fileSize;
+    char                  *pfile;
+    int                   status;
+    int                   i;
+
+    for(i=1; i<argc; i++) {
+        if(strcmp(argv[i],"-a")==0) traceIOMask |= ASYN_TRACEIO_ASCII;
+        else if(strcmp(argv[i],"-e")==0) traceIOMask |= ASYN_TRACEIO_ESCAPE;
+        else if(strcmp(argv[i],"-x")==0) traceIOMask |= ASYN_TRACEIO_HEX;
+        else if(strcmp(argv[i],"-r")==0) directionMask |= 1<<asynTraceIORead;
+        else if(strcmp(argv[i],"-w")==0) directionMask |= 1<<asynTraceIOWrite;
+        else if(strcmp(argv[i],"-n")==0 && i+1<argc) truncateSize = atol(argv[++i]);
+        else if(argv[i][0]!='-' && !fileName) fileName = argv[i];
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if(!fileName) {
+        usage();
+        return 1;
+    }
+    if(traceIOMask==0) traceIOMask = ASYN_TRACEIO_ESCAPE;
+    fp = fopen(fileName,"rb");
+    if(!fp) {
+        fprintf(stderr,"%s: %s\n",fileName,strerror(errno));
+        return 1;
+    }
+    fseek(fp,0,SEEK_END);
+    fileSize = ftell(fp);
+    rewind(fp);
+    pfile = (fileSize>0) ? malloc(fileSize) : 0;
+    if(!pfile || fread(pfile,1,fileSize,fp)!=(size_t)fileSize) {
+        fprintf(stderr,"%s: read error\n",fileName);
+        free(pfile);
+        fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+    status = decode(fileName,pfile,fileSize,traceIOMask,truncateSize,
+        directionMask);
+    free(pfile);
+    return status;
+}
@@ -9,7 +9,12 @@
  */
 
 #include <vector>
+#include <list>
+#include <algorithm>
+#include <map>
+#include <string>
 #include <memory>
+#include <stdexcept>
 
 #include <stdlib.h>
 #include <string.h>
@@ -19,6 +24,7 @@
 #include <epicsString.h>
 #include <epicsMutex.h>
 #include <epicsThread.h>
+#include <epicsEvent.h>
 #include <cantProceed.h>
 /* NOTE: interruptAccept is define in dbAccess.h if using EPICS IOC, else set it to 1 */
 #ifdef EPICS_LIBCOM_ONLY
@@ -27,36 +33,151 @@
     #include <dbAccess.h>
 #endif
 
-#include "paramVal.h"
 #include "paramErrors.h"
 #include "asynParamType.h"
-#include "ParamListInvalidIndex.h"
-#include "ParamValWrongType.h"
-#include "ParamValNotDefined.h"
 #include "asynPortDriver.h"
 
+#if LT_EPICSBASE(3,15,0,1)
+#define PARAM_READ_USE_MUTEX
+#else
+#include <epicsAtomic.h>
+#endif
+
 static const char *driverName = "asynPortDriver";
 
+/** Iterates over the interrupt clients registered for one reason and address,
+  * using the index maintained by asynManager rather than scanning every client.
+  * Must only be used between pasynManager->interruptStart and interruptEnd.
+  * The clients are indexed with the address returned by asynPortDriver::getAddress,
+  * see interruptAddrSource. */
+class interruptClientIterator {
+public:
+    interruptClientIterator(void *interruptPvt, int reason, int addr)
+        : pindex(0)
+    {
+        ELLLIST *plist;
+
+        pasynManager->findInterruptUsers(interruptPvt, reason, addr, &plist);
+        pindex = (interruptIndexNode *)ellFirst(plist);
+    }
+    interruptNode *next()
+    {
+        if (!pindex) return 0;
+        interruptNode *pnode = pindex->pinterruptNode;
+        pindex = (interruptIndexNode *)ellNext(&pindex->node);
+        return pnode;
+    }
+private:
+    interruptIndexNode *pindex;
+};
+
+/** Gives asynManager the address to index an interrupt client with, so that drivers which
+  * reimplement getAddress find their clients with the addresses they pass to the callbacks */
+static asynStatus interruptAddrSource(void *userPvt, asynUser *pasynUser, int *address)
+{
+    asynPortDriver *pPvt = (asynPortDriver *)userPvt;
+
+    return pPvt->getAddress(pasynUser, address);
+}
+
+/** Optional pool of threads that deliver scalar parameter callbacks without holding the driver lock.
+  * Each thread has its own queue, and a given address and parameter is always handled by the same
+  * thread, so the callbacks for one parameter are delivered in order.
+  * A change to a parameter that is still queued replaces the queued value (coalescing).
+  * A change to any other parameter when the queue is full is discarded and counted as dropped. */
+class callbackDispatcher {
+public:
+    callbackDispatcher(asynPortDriver *pPort, int numThreads, int queueDepth);
+    ~callbackDispatcher();
+    void enqueue(int addr, const asynParamChange *pChange, const epicsTimeStamp *pTimeStamp);
+    void report(FILE *fp, int details);
+private:
+    struct dispatchItem {
+        int addr;
+        asynParamChange change;
+        std::string sval;
+        epicsTimeStamp timeStamp;
+    };
+    typedef std::pair<int, int> dispatchKey;
+    class worker: public epicsThreadRunable {
+    public:
+        worker(callbackDispatcher *pDispatcher, int id);
+        ~worker();
+        void run();
+        callbackDispatcher *pDispatcher;
+        epicsThread *pThread;
+        epicsMutex queueLock;
+        epicsEvent wakeup;
+        std::list<dispatchItem> queue;
+        std::map<dispatchKey, std::list<dispatchItem>::iterator> pending;
+        bool exiting;
+        size_t highWater;
+        unsigned long delivered;
+        unsigned long coalesced;
+        unsigned long dropped;
+    };
+    friend class worker;
+    asynPortDriver *pPort;
+    size_t queueDepth;
+    std::vector<worker*> workers;
+};
+
+/** Index of parameter names, so findParam does not have to compare every name.
+  * Names are ordered ignoring case, as drvInfo strings are matched with epicsStrCaseCmp. */
+class paramNameIndex {
+public:
+    const char *insert(const char *name, int index);
+    const char *find(const char *name, int *index) const;
+private:
+    struct nameLess {
+        bool operator()(const std::string &a, const std::string &b) const
+        {
+            return epicsStrCaseCmp(a.c_str(), b.c_str()) < 0;
+        }
+    };
+    std::map<std::string, int, nameLess> names;
+};
+
+/** Names of the parameters of a port, shared by all of its parameter lists.
+  * Each name is stored once and the lists hold a pointer to it. Names that differ only in case
+  * are the same name, and the copy held is the spelling it was first created with.
+  * The index recorded for a name is the one it was first created with, which is its index
+  * in every list unless the driver creates different parameters in different lists. */
+class paramNameTable {
+public:
+    const char *addName(const char *name, int index);
+    const char *findName(const char *name, int *index);
+private:
+    paramNameIndex nameIndex;
+    epicsMutex nameLock;
+};
+
 /** Class to support parameter library (also called parameter list);
   * set and get values indexed by parameter number (pasynUser->reason)
   * and do asyn callbacks when parameters change.
   * The parameter class supports 3 types of parameters: int, double
-  * and dynamic-length strings. */
+  * and dynamic-length strings.
+  * The values are stored in one dense array per parameter type, and the type, status and
+  * alarms in arrays indexed by parameter number, so a list only needs a few allocations
+  * however many parameters it has. */
 class paramList {
 public:
     paramList(class asynPortDriver *pPort);
     ~paramList();
-    paramVal* getParameter(int index);
     asynStatus createParam(const char *name, asynParamType type, int *index);
     asynStatus getNumParams(int *numParams);
     asynStatus findParam(const char *name, int *index);
     asynStatus getName(int index, const char **name);
+    asynStatus getType(int index, asynParamType *type);
     asynStatus setInteger(int index, int value);
     asynStatus setInteger64(int index, epicsInt64 value);
     asynStatus setUInt32(int index, epicsUInt32 value, epicsUInt32 valueMask, epicsUInt32 interruptMask);
     asynStatus setDouble(int index, double value);
     asynStatus setString(int index, const char *string);
     asynStatus setString(int index, const std::string& string);
+    template <typename epicsType>
+        asynStatus setValues(const int *indices, int first, const epicsType *values,
+                             size_t nValues, int *errorIndex);
     asynStatus getInteger(int index, epicsInt32 *value);
     asynStatus getInteger64(int index, epicsInt64 *value);
     asynStatus getUInt32(int index, epicsUInt32 *value, epicsUInt32 mask);
@@ -74,49 +195,271 @@ public:
     asynStatus getAlarmStatus(int index, int *alarmStatus);
     asynStatus setAlarmSeverity(int index, int alarmSeverity);
     asynStatus getAlarmSeverity(int index, int *alarmSeverity);
+    asynStatus readScalar(int index, epicsInt32 *value, int *alarmStatus, int *alarmSeverity,
+                          epicsTimeStamp *pTimeStamp);
+    asynStatus readScalar(int index, epicsInt64 *value, int *alarmStatus, int *alarmSeverity,
+                          epicsTimeStamp *pTimeStamp);
+    asynStatus readScalar(int index, epicsUInt32 *value, int *alarmStatus, int *alarmSeverity,
+                          epicsTimeStamp *pTimeStamp);
+    asynStatus readScalar(int index, epicsFloat64 *value, int *alarmStatus, int *alarmSeverity,
+                          epicsTimeStamp *pTimeStamp);
+    void beginUpdate();
+    void endUpdate();
     void report(FILE *fp, int details);
 
 private:
+    /** Status and alarms of a parameter, and whether its value has been set */
+    struct paramState {
+        asynStatus status;
+        int alarmStatus;
+        int alarmSeverity;
+        bool defined;
+    };
+    /** Value and interrupt masks of an asynParamUInt32Digital parameter */
+    struct uInt32Value {
+        epicsUInt32 value;
+        epicsUInt32 risingMask;
+        epicsUInt32 fallingMask;
+        epicsUInt32 callbackMask;
+    };
+    /** Marks the values, status and alarms as being written while it exists, see readValue.
+      * Writers are serialized by paramLock. */
+    class sequenceGuard {
+    public:
+        sequenceGuard(int& sequence);
+        ~sequenceGuard();
+    private:
+        int& sequence;
+    };
     asynStatus setFlag(int index);
+    void orderChanges();
+    asynStatus checkType(int index, asynParamType type);
+    int addValue(asynParamType type);
+    void stateChanged(int index);
+    template <typename valueType, typename epicsType>
+        asynStatus setValue(int index, asynParamType type, std::vector<valueType>& typeValues,
+                            const epicsType& value);
+    template <typename valueType, typename epicsType>
+        asynStatus getValue(int index, asynParamType type, const std::vector<valueType>& typeValues,
+                            epicsType *value);
+    template <typename valueType, typename epicsType>
+        asynStatus readValue(int index, asynParamType type, const std::vector<valueType>& typeValues,
+                             epicsType *value, int *alarmStatus, int *alarmSeverity,
+                             epicsTimeStamp *pTimeStamp);
+    template <typename epicsType>
+        static epicsType scalarValue(const epicsType& value) { return value; }
+    static epicsUInt32 scalarValue(const uInt32Value& value) { return value.value; }
+    std::vector<epicsInt32>& valueArray(const epicsInt32 *) { return int32Values; }
+    std::vector<epicsInt64>& valueArray(const epicsInt64 *) { return int64Values; }
+    std::vector<epicsFloat64>& valueArray(const epicsFloat64 *) { return float64Values; }
     asynStatus int32Callback(int command, int addr);
     asynStatus int64Callback(int command, int addr);
     asynStatus uint32Callback(int command, int addr, epicsUInt32 interruptMask);
     asynStatus float64Callback(int command, int addr);
     asynStatus octetCallback(int command, int addr);
-    void registerParameterChange(paramVal *param, int index);
+    asynStatus callCallbacksBatched(int addr);
+    asynStatus deliverChanges(asynParamType type, int addr, const epicsTimeStamp *pTimeStamp);
 
     asynPortDriver *pasynPortDriver;
-    std::vector<unsigned> flags;
-    std::vector<paramVal*> vals;
+    paramNameTable *pNames;
+    std::vector<epicsUInt32> dirty;     // one bit per parameter that has changed since the last callbacks
+    std::vector<unsigned> journal;      // the parameters with their bit set, in the order they changed
+    unsigned long suppressed;           // changes to parameters that were already flagged
+    int sequence;                       // odd while a writer is changing values, see readValue
+    /* Indexed by parameter number */
+    std::vector<const char *> names;    // owned by pNames
+    std::vector<asynParamType> types;
+    std::vector<int> slots;             // index into the value array of the parameter type
+    std::vector<paramState> states;
+    /* Indexed by slot */
+    std::vector<epicsInt32> int32Values;
+    std::vector<epicsInt64> int64Values;
+    std::vector<uInt32Value> uInt32Values;
+    std::vector<epicsFloat64> float64Values;
+    std::vector<std::string> stringValues;
+    std::vector<asynParamChange> changes; // snapshot used by callCallbacksBatched
 
     epicsMutex paramLock; // for protecting writes to internal lists
 };
 
+/** Adds a name to the index, if it is not already there.
+  * \param[in] name The parameter name
+  * \param[in] index The parameter number, recorded if the name is new
+  * \return The copy of the name held by the index */
+const char *paramNameIndex::insert(const char *name, int index)
+{
+    std::map<std::string, int, nameLess>::iterator it = this->names.find(name);
+
+    if (it == this->names.end())
+        it = this->names.insert(std::make_pair(std::string(name), index)).first;
+    return it->first.c_str();
+}
+
+/** Finds a name in the index.
+  * \param[in] name The parameter name
+  * \param[out] index The parameter number recorded for the name
+  * \return The copy of the name held by the index, or NULL if it is not found */
+const char *paramNameIndex::find(const char *name, int *index) const
+{
+    std::map<std::string, int, nameLess>::const_iterator it = this->names.find(name);
+
+    if (it == this->names.end()) return NULL;
+    *index = it->second;
+    return it->first.c_str();
+}
+
+/** Adds a name to the table, if it is not already there.
+  * \param[in] name The parameter name
+  * \param[in] index The parameter number, recorded if the name is new
+  * \return The copy of the name held by the table */
+const char *paramNameTable::addName(const char *name, int index)
+{
+    epicsGuard<epicsMutex> _lock(nameLock);
+    return this->nameIndex.insert(name, index);
+}
+
+/** Finds a name in the table.
+  * \param[in] name The parameter name
+  * \param[out] index The parameter number recorded for the name
+  * \return The copy of the name held by the table, or NULL if it is not found */
+const char *paramNameTable::findName(const char *name, int *index)
+{
+    epicsGuard<epicsMutex> _lock(nameLock);
+    return this->nameIndex.find(name, index);
+}
+
 /** Constructor for paramList class.
   * \param[in] pPort Pointer to asynPortDriver port for this paramList. */
 paramList::paramList(asynPortDriver *pPort)
-    : pasynPortDriver(pPort)
+    : pasynPortDriver(pPort), pNames(pPort->paramNames), suppressed(0), sequence(0)
 {}
 
 /** Destructor for paramList class; frees resources allocated in constructor */
 paramList::~paramList()
+{}
+
+#ifdef PARAM_READ_USE_MUTEX
+paramList::sequenceGuard::sequenceGuard(int& sequence) : sequence(sequence) {}
+paramList::sequenceGuard::~sequenceGuard() {}
+#else
+paramList::sequenceGuard::sequenceGuard(int& sequence) : sequence(sequence)
+{
+    epicsAtomicSetIntT(&this->sequence, this->sequence + 1);
+    epicsAtomicWriteMemoryBarrier();
+}
+
+paramList::sequenceGuard::~sequenceGuard()
 {
-    for (size_t i = 0; i < this->vals.size(); i++)
-        delete this->vals[i];
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetIntT(&this->sequence, this->sequence + 1);
 }
+#endif
 
+/** Makes readValue retry until endUpdate, for changes to data that readValue reads
+  * outside the parameter list, i.e. the timestamp of the port. */
+void paramList::beginUpdate()
+{
+    paramLock.lock();
+#ifndef PARAM_READ_USE_MUTEX
+    epicsAtomicSetIntT(&this->sequence, this->sequence + 1);
+    epicsAtomicWriteMemoryBarrier();
+#endif
+}
+
+void paramList::endUpdate()
+{
+#ifndef PARAM_READ_USE_MUTEX
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetIntT(&this->sequence, this->sequence + 1);
+#endif
+    paramLock.unlock();
+}
+
+/** Flags a parameter for callbacks.
+  * A parameter is only added to the journal once until its callbacks are done,
+  * further changes are counted as suppressed. */
 asynStatus paramList::setFlag(int index)
 {
-    size_t i;
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    epicsUInt32& word = this->dirty[index >> 5];
+    epicsUInt32 bit = 1u << (index & 31);
 
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    /* See if we have already set the flag for this parameter */
-    for (i=0; i<flags.size(); i++) if (flags[i] == (unsigned)index) return asynSuccess;
-    /* If not found add a flag */
-    this->flags.push_back((unsigned)index);
+    if (word & bit) {
+        this->suppressed++;
+        return asynSuccess;
+    }
+    word |= bit;
+    this->journal.push_back((unsigned)index);
     return asynSuccess;
 }
 
+/** Orders the journal of flagged parameters by index.
+  * A short journal is sorted, a long one is rebuilt by scanning the bitset.
+  * The bits are cleared by the callers as each parameter is handled. */
+void paramList::orderChanges()
+{
+    size_t nWords = this->dirty.size();
+    size_t word;
+    unsigned index;
+    epicsUInt32 bits;
+
+    if (this->journal.size() < nWords) {
+        std::sort(this->journal.begin(), this->journal.end());
+        return;
+    }
+    this->journal.clear();
+    for (word=0; word<nWords; word++) {
+        for (bits=this->dirty[word], index=(unsigned)word*32; bits; bits>>=1, index++) {
+            if (bits & 1) this->journal.push_back(index);
+        }
+    }
+}
+
+/** Checks that a parameter exists and has the expected type.
+  * \return Returns asynParamBadIndex if the index is not valid or asynParamWrongType if the parameter type is not type. */
+asynStatus paramList::checkType(int index, asynParamType type)
+{
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    if (this->types[index] != type) return asynParamWrongType;
+    return asynSuccess;
+}
+
+/** Adds an element for a new parameter to the value array of its type.
+  * \return The slot of the new element, or -1 for types that have no value in the parameter library */
+int paramList::addValue(asynParamType type)
+{
+    switch (type) {
+        case asynParamInt32:
+            this->int32Values.push_back(0);
+            return (int)this->int32Values.size()-1;
+        case asynParamInt64:
+            this->int64Values.push_back(0);
+            return (int)this->int64Values.size()-1;
+        case asynParamUInt32Digital: {
+            uInt32Value value = {0, 0, 0, 0};
+            this->uInt32Values.push_back(value);
+            return (int)this->uInt32Values.size()-1;
+        }
+        case asynParamFloat64:
+            this->float64Values.push_back(0.);
+            return (int)this->float64Values.size()-1;
+        case asynParamOctet:
+            this->stringValues.resize(this->stringValues.size()+1);
+            return (int)this->stringValues.size()-1;
+        default:
+            return -1;
+    }
+}
+
+/** Flags a parameter whose status or alarm has changed. */
+void paramList::stateChanged(int index)
+{
+    // We need to do callbacks on all bits if the status has changed
+    if (this->types[index] == asynParamUInt32Digital)
+        this->uInt32Values[this->slots[index]].callbackMask = 0xFFFFFFFF;
+    setFlag(index);
+}
+
 /** Adds a new parameter to the parameter library.
   * \param[in] name The name of this parameter
   * \param[in] type The type of this parameter
@@ -128,15 +471,18 @@ asynStatus paramList::setFlag(int index)
 asynStatus paramList::createParam(const char *name, asynParamType type, int *index)
 {
     //static const char *functionName = "createParam";
+    paramState state = {asynSuccess, 0, 0, false};
 
     epicsGuard<epicsMutex> _lock(paramLock);
     if (this->findParam(name, index) == asynSuccess) return asynParamAlreadyExists;
 
-    paramVal *param = new paramVal(name, type);
-
-    vals.push_back(param);
-    flags.reserve(vals.size());
-    *index = (int)vals.size()-1;
+    *index = (int)this->types.size();
+    this->names.push_back(this->pNames->addName(name, *index));
+    this->types.push_back(type);
+    this->slots.push_back(addValue(type));
+    this->states.push_back(state);
+    this->dirty.resize((this->types.size()+31)/32, 0);
+    this->journal.reserve(this->types.size());
     return asynSuccess;
 }
 
@@ -144,7 +490,7 @@ asynStatus paramList::createParam(const char *name, asynParamType type, int *ind
   * \param[out] numParams Number of parameters */
 asynStatus paramList::getNumParams(int *numParams)
 {
-    *numParams = (int)this->vals.size();
+    *numParams = (int)this->types.size();
     return asynSuccess;
 }
 
@@ -155,22 +501,44 @@ asynStatus paramList::getNumParams(int *numParams)
   * \return Returns asynParamNotFound if name is not found in the parameter list. */
 asynStatus paramList::findParam(const char *name, int *index)
 {
-    for (int i=0; i<(int)this->vals.size(); i++) {
-        if (this->vals[i]->nameEquals(name)) {
-            *index = i;
+    int hint = -1;
+    const char *pName = this->pNames->findName(name, &hint);
+    size_t i;
+
+    *index = -1;
+    if (!pName) return asynParamNotFound;
+    if (hint >= 0 && (size_t)hint < this->names.size() && this->names[hint] == pName) {
+        *index = hint;
+        return asynSuccess;
+    }
+    /* The parameters of this list were created in a different order from another list */
+    for (i=0; i<this->names.size(); i++) {
+        if (this->names[i] == pName) {
+            *index = (int)i;
             return asynSuccess;
         }
     }
-    *index=-1;
     return asynParamNotFound;
 }
 
-void paramList::registerParameterChange(paramVal *param,int index)
+/** Sets the value of a scalar parameter and flags it for callbacks if it has changed.
+  * Must be called with paramLock held. */
+template <typename valueType, typename epicsType>
+asynStatus paramList::setValue(int index, asynParamType type, std::vector<valueType>& typeValues,
+                               const epicsType& value)
 {
-    if(param->hasValueChanged()){
+    asynStatus status = checkType(index, type);
+    if (status) return status;
+
+    valueType& current = typeValues[this->slots[index]];
+    paramState& state = this->states[index];
+    if (!state.defined || (current != value)) {
+        sequenceGuard _seq(this->sequence);
+        state.defined = true;
+        current = value;
         setFlag(index);
-        param->resetValueChanged();
     }
+    return asynSuccess;
 }
 
 /** Sets the value for an integer in the parameter library.
@@ -180,18 +548,7 @@ void paramList::registerParameterChange(paramVal *param,int index)
 asynStatus paramList::setInteger(int index, int value)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    try{
-        getParameter(index)->setInteger(value);
-        registerParameterChange(getParameter(index), index);
-    }
-    catch (ParamValWrongType&) {
-        return asynParamWrongType;
-    }
-    catch (ParamListInvalidIndex&){
-        return asynParamBadIndex;
-    }
-
-    return asynSuccess;
+    return setValue(index, asynParamInt32, this->int32Values, (epicsInt32)value);
 }
 
 /** Sets the value for a 64-bit integer in the parameter library.
@@ -201,18 +558,7 @@ asynStatus paramList::setInteger(int index, int value)
 asynStatus paramList::setInteger64(int index, epicsInt64 value)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    try{
-        getParameter(index)->setInteger64(value);
-        registerParameterChange(getParameter(index), index);
-    }
-    catch (ParamValWrongType&) {
-        return asynParamWrongType;
-    }
-    catch (ParamListInvalidIndex&){
-        return asynParamBadIndex;
-    }
-
-    return asynSuccess;
+    return setValue(index, asynParamInt64, this->int64Values, value);
 }
 
 /** Sets the value for a UInt32 in the parameter library.
@@ -223,18 +569,35 @@ asynStatus paramList::setInteger64(int index, epicsInt64 value)
   * \return Returns asynParamBadIndex if the index is not valid or asynParamWrongType if the parameter type is not asynParamUInt32Digital. */
 asynStatus paramList::setUInt32(int index, epicsUInt32 value, epicsUInt32 valueMask, epicsUInt32 interruptMask)
 {
+    epicsUInt32 newValue;
+    bool changed = false;
+
     epicsGuard<epicsMutex> _lock(paramLock);
-    try {
-        getParameter(index)->setUInt32(value, valueMask, interruptMask);
-        registerParameterChange(getParameter(index), index);
+    asynStatus status = checkType(index, asynParamUInt32Digital);
+    if (status) return status;
+
+    uInt32Value& current = this->uInt32Values[this->slots[index]];
+    paramState& state = this->states[index];
+    sequenceGuard _seq(this->sequence);
+    if (!state.defined) {
+        /* Start from a known value, the value has always changed if it became defined */
+        current.value = 0;
+        state.defined = true;
+        changed = true;
     }
-    catch (ParamValWrongType&) {
-        return asynParamWrongType;
+    /* Clear bits covered by mask and insert bits from value */
+    newValue = (current.value & ~valueMask) | (value & valueMask);
+    if (current.value != newValue) {
+        /* Set the bits in the callback mask that have changed */
+        current.callbackMask |= (current.value ^ newValue);
+        current.value = newValue;
+        changed = true;
     }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
+    if (interruptMask) {
+        current.callbackMask |= interruptMask;
+        changed = true;
     }
-
+    if (changed) setFlag(index);
     return asynSuccess;
 }
 
@@ -245,19 +608,7 @@ asynStatus paramList::setUInt32(int index, epicsUInt32 value, epicsUInt32 valueM
 asynStatus paramList::setDouble(int index, double value)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    try
-    {
-        getParameter(index)->setDouble(value);
-        registerParameterChange(getParameter(index), index);
-    }
-    catch (ParamValWrongType&)
-    {
-        return asynParamWrongType;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return asynSuccess;
+    return setValue(index, asynParamFloat64, this->float64Values, (epicsFloat64)value);
 }
 
 /** Sets the value for a string in the parameter library.
@@ -267,18 +618,7 @@ asynStatus paramList::setDouble(int index, double value)
 asynStatus paramList::setString(int index, const char *value)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    try {
-        getParameter(index)->setString(value);
-        registerParameterChange(getParameter(index), index);
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return asynSuccess;
+    return setValue(index, asynParamOctet, this->stringValues, value);
 }
 
 /** Sets the value for a string in the parameter library.
@@ -288,20 +628,129 @@ asynStatus paramList::setString(int index, const char *value)
 asynStatus paramList::setString(int index, const std::string& value)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    try {
-        getParameter(index)->setString(value);
-        registerParameterChange(getParameter(index), index);
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
+    return setValue(index, asynParamOctet, this->stringValues, value);
+}
+
+static asynParamType bulkParamType(const epicsInt32 *) { return asynParamInt32; }
+static asynParamType bulkParamType(const epicsInt64 *) { return asynParamInt64; }
+static asynParamType bulkParamType(const epicsFloat64 *) { return asynParamFloat64; }
+
+/** Sets the values of several parameters of the same type in the parameter library.
+  * All the indices and types are checked before any value is set, so either all
+  * the values are set or none are.
+  * \param[in] indices The parameter numbers, or NULL for the parameters first to first+nValues-1
+  * \param[in] first The first parameter number if indices is NULL
+  * \param[in] values The values to set
+  * \param[in] nValues The number of values
+  * \param[out] errorIndex The parameter number that caused an error
+  * \return Returns asynParamBadIndex if an index is not valid or asynParamWrongType if the type of a parameter
+  * does not match epicsType. */
+template <typename epicsType>
+asynStatus paramList::setValues(const int *indices, int first, const epicsType *values,
+                                size_t nValues, int *errorIndex)
+{
+    asynParamType type = bulkParamType(values);
+    std::vector<epicsType>& typeValues = valueArray(values);
+    size_t i;
+
+    epicsGuard<epicsMutex> _lock(paramLock);
+    size_t nParams = this->types.size();
+    for (i=0; i<nValues; i++) {
+        int index = indices ? indices[i] : first + (int)i;
+        *errorIndex = index;
+        if (index < 0 || (size_t)index >= nParams) return asynParamBadIndex;
+        if (this->types[index] != type) return asynParamWrongType;
     }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
+    for (i=0; i<nValues; i++) {
+        int index = indices ? indices[i] : first + (int)i;
+        epicsType& current = typeValues[this->slots[index]];
+        paramState& state = this->states[index];
+        if (state.defined && (current == values[i])) continue;
+        sequenceGuard _seq(this->sequence);
+        state.defined = true;
+        current = values[i];
+        setFlag(index);
     }
     return asynSuccess;
 }
 
+/** Returns the value of a scalar parameter.
+  * \return Returns asynParamBadIndex if the index is not valid, asynParamWrongType if the parameter type is not type,
+  * asynParamUndefined if the value has not been defined, or else the status of the parameter. */
+template <typename valueType, typename epicsType>
+asynStatus paramList::getValue(int index, asynParamType type, const std::vector<valueType>& typeValues,
+                               epicsType *value)
+{
+    asynStatus status = checkType(index, type);
+    if (status) return status;
+    if (!this->states[index].defined) return asynParamUndefined;
+    *value = typeValues[this->slots[index]];
+    return this->states[index].status;
+}
+
+/** Reads the value, status and alarms of a scalar parameter and the timestamp of the port
+  * without waiting for paramLock.
+  * The reader retries if a writer changed the parameter list or, with setTimeStamp or updateTimeStamp,
+  * the timestamp while it was reading, and takes paramLock if that keeps happening. This must not be used for octet parameters,
+  * or while parameters are being created.
+  * \return Returns asynParamBadIndex if the index is not valid, asynParamWrongType if the parameter type is not type,
+  * asynParamUndefined if the value has not been defined, or else the status of the parameter. */
+template <typename valueType, typename epicsType>
+asynStatus paramList::readValue(int index, asynParamType type, const std::vector<valueType>& typeValues,
+                                epicsType *value, int *alarmStatus, int *alarmSeverity,
+                                epicsTimeStamp *pTimeStamp)
+{
+    asynStatus status = checkType(index, type);
+    if (status) return status;
+    const valueType& current = typeValues[this->slots[index]];
+    const paramState& state = this->states[index];
+
+#ifndef PARAM_READ_USE_MUTEX
+    for (int tries=0; tries<100; tries++) {
+        int sequence = epicsAtomicGetIntT(&this->sequence);
+        if (sequence & 1) continue;
+        epicsAtomicReadMemoryBarrier();
+        *value = scalarValue(current);
+        status = state.defined ? state.status : asynParamUndefined;
+        *alarmStatus = state.alarmStatus;
+        *alarmSeverity = state.alarmSeverity;
+        pasynPortDriver->getTimeStamp(pTimeStamp);
+        epicsAtomicReadMemoryBarrier();
+        if (epicsAtomicGetIntT(&this->sequence) == sequence) return status;
+    }
+#endif
+    epicsGuard<epicsMutex> _lock(paramLock);
+    *value = scalarValue(current);
+    *alarmStatus = state.alarmStatus;
+    *alarmSeverity = state.alarmSeverity;
+    pasynPortDriver->getTimeStamp(pTimeStamp);
+    return state.defined ? state.status : asynParamUndefined;
+}
+
+asynStatus paramList::readScalar(int index, epicsInt32 *value, int *alarmStatus, int *alarmSeverity,
+                                 epicsTimeStamp *pTimeStamp)
+{
+    return readValue(index, asynParamInt32, this->int32Values, value, alarmStatus, alarmSeverity, pTimeStamp);
+}
+
+asynStatus paramList::readScalar(int index, epicsInt64 *value, int *alarmStatus, int *alarmSeverity,
+                                 epicsTimeStamp *pTimeStamp)
+{
+    return readValue(index, asynParamInt64, this->int64Values, value, alarmStatus, alarmSeverity, pTimeStamp);
+}
+
+asynStatus paramList::readScalar(int index, epicsUInt32 *value, int *alarmStatus, int *alarmSeverity,
+                                 epicsTimeStamp *pTimeStamp)
+{
+    return readValue(index, asynParamUInt32Digital, this->uInt32Values, value, alarmStatus, alarmSeverity, pTimeStamp);
+}
+
+asynStatus paramList::readScalar(int index, epicsFloat64 *value, int *alarmStatus, int *alarmSeverity,
+                                 epicsTimeStamp *pTimeStamp)
+{
+    return readValue(index, asynParamFloat64, this->float64Values, value, alarmStatus, alarmSeverity, pTimeStamp);
+}
+
 /** Returns the value for an integer from the parameter library.
   * \param[in] index The parameter number
   * \param[out] value Address of value to get.
@@ -309,24 +758,8 @@ asynStatus paramList::setString(int index, const std::string& value)
   * or asynParamUndefined if the value has not been defined. */
 asynStatus paramList::getInteger(int index, epicsInt32 *value)
 {
-    asynStatus status;
     *value = 0;
-
-    try {
-        paramVal *pVal = getParameter(index);
-        *value = pVal->getInteger();
-        status = pVal->getStatus();
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamValNotDefined&){
-        return asynParamUndefined;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return status;
+    return getValue(index, asynParamInt32, this->int32Values, value);
 }
 
 /** Returns the value for a 64-bit integer from the parameter library.
@@ -336,24 +769,8 @@ asynStatus paramList::getInteger(int index, epicsInt32 *value)
   * or asynParamUndefined if the value has not been defined. */
 asynStatus paramList::getInteger64(int index, epicsInt64 *value)
 {
-    asynStatus status;
     *value = 0;
-
-    try {
-        paramVal *pVal = getParameter(index);
-        *value = pVal->getInteger64();
-        status = pVal->getStatus();
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamValNotDefined&){
-        return asynParamUndefined;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return status;
+    return getValue(index, asynParamInt64, this->int64Values, value);
 }
 
 /** Returns the value for a UInt32 from the parameter library.
@@ -364,24 +781,12 @@ asynStatus paramList::getInteger64(int index, epicsInt64 *value)
   * or asynParamUndefined if the value has not been defined. */
 asynStatus paramList::getUInt32(int index, epicsUInt32 *value, epicsUInt32 mask)
 {
-    asynStatus status;
     *value = 0;
-
-    try {
-        paramVal *pVal = getParameter(index);
-        *value = pVal->getUInt32(mask);
-        status = pVal->getStatus();
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamValNotDefined&){
-        return asynParamUndefined;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return status;
+    asynStatus status = checkType(index, asynParamUInt32Digital);
+    if (status) return status;
+    if (!this->states[index].defined) return asynParamUndefined;
+    *value = this->uInt32Values[this->slots[index]].value & mask;
+    return this->states[index].status;
 }
 
 /** Returns the value for a double from the parameter library.
@@ -391,24 +796,8 @@ asynStatus paramList::getUInt32(int index, epicsUInt32 *value, epicsUInt32 mask)
   * or asynParamUndefined if the value has not been defined. */
 asynStatus paramList::getDouble(int index, double *value)
 {
-    asynStatus status;
     *value = 0.;
-
-    try {
-        paramVal *pVal = getParameter(index);
-        *value = pVal->getDouble();
-        status = pVal->getStatus();
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamValNotDefined&){
-        return asynParamUndefined;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return status;
+    return getValue(index, asynParamFloat64, this->float64Values, value);
 }
 
 /** Returns the status for a parameter in the parameter library.
@@ -417,8 +806,8 @@ asynStatus paramList::getDouble(int index, double *value)
   * \return Returns asynParamBadIndex if the index is not valid */
 asynStatus paramList::getStatus(int index, asynStatus *status)
 {
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    *status = this->vals[index]->getStatus();
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    *status = this->states[index].status;
     return asynSuccess;
 }
 
@@ -429,9 +818,12 @@ asynStatus paramList::getStatus(int index, asynStatus *status)
 asynStatus paramList::setStatus(int index, asynStatus status)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    this->vals[index]->setStatus(status);
-    registerParameterChange(getParameter(index), index);
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    if (this->states[index].status != status) {
+        sequenceGuard _seq(this->sequence);
+        this->states[index].status = status;
+        stateChanged(index);
+    }
     return asynSuccess;
 }
 
@@ -441,8 +833,8 @@ asynStatus paramList::setStatus(int index, asynStatus status)
   * \return Returns asynParamBadIndex if the index is not valid */
 asynStatus paramList::getAlarmStatus(int index,  int *alarmStatus)
 {
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    *alarmStatus = this->vals[index]->getAlarmStatus();
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    *alarmStatus = this->states[index].alarmStatus;
     return asynSuccess;
 }
 
@@ -453,9 +845,12 @@ asynStatus paramList::getAlarmStatus(int index,  int *alarmStatus)
 asynStatus paramList::setAlarmStatus(int index, int alarmStatus)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    this->vals[index]->setAlarmStatus(alarmStatus);
-    registerParameterChange(getParameter(index), index);
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    if (this->states[index].alarmStatus != alarmStatus) {
+        sequenceGuard _seq(this->sequence);
+        this->states[index].alarmStatus = alarmStatus;
+        stateChanged(index);
+    }
     return asynSuccess;
 }
 
@@ -465,8 +860,8 @@ asynStatus paramList::setAlarmStatus(int index, int alarmStatus)
   * \return Returns asynParamBadIndex if the index is not valid */
 asynStatus paramList::getAlarmSeverity(int index,  int *alarmSeverity)
 {
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    *alarmSeverity = this->vals[index]->getAlarmSeverity();
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    *alarmSeverity = this->states[index].alarmSeverity;
     return asynSuccess;
 }
 
@@ -477,9 +872,12 @@ asynStatus paramList::getAlarmSeverity(int index,  int *alarmSeverity)
 asynStatus paramList::setAlarmSeverity(int index, int alarmSeverity)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    this->vals[index]->setAlarmSeverity(alarmSeverity);
-    registerParameterChange(getParameter(index), index);
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    if (this->states[index].alarmSeverity != alarmSeverity) {
+        sequenceGuard _seq(this->sequence);
+        this->states[index].alarmSeverity = alarmSeverity;
+        stateChanged(index);
+    }
     return asynSuccess;
 }
 
@@ -492,18 +890,19 @@ asynStatus paramList::setAlarmSeverity(int index, int alarmSeverity)
 asynStatus paramList::setUInt32Interrupt(int index, epicsUInt32 mask, interruptReason reason)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    if (this->vals[index]->type != asynParamUInt32Digital) return asynParamWrongType;
+    asynStatus status = checkType(index, asynParamUInt32Digital);
+    if (status) return status;
+    uInt32Value& current = this->uInt32Values[this->slots[index]];
     switch (reason) {
       case interruptOnZeroToOne:
-        this->vals[index]->uInt32RisingMask = mask;
+        current.risingMask = mask;
         break;
       case interruptOnOneToZero:
-        this->vals[index]->uInt32FallingMask = mask;
+        current.fallingMask = mask;
         break;
       case interruptOnBoth:
-        this->vals[index]->uInt32RisingMask = mask;
-        this->vals[index]->uInt32FallingMask = mask;
+        current.risingMask = mask;
+        current.fallingMask = mask;
         break;
     }
     return asynSuccess;
@@ -517,10 +916,11 @@ asynStatus paramList::setUInt32Interrupt(int index, epicsUInt32 mask, interruptR
 asynStatus paramList::clearUInt32Interrupt(int index, epicsUInt32 mask)
 {
     epicsGuard<epicsMutex> _lock(paramLock);
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    if (this->vals[index]->type != asynParamUInt32Digital) return asynParamWrongType;
-    this->vals[index]->uInt32RisingMask &= ~mask;
-    this->vals[index]->uInt32FallingMask &= ~mask;
+    asynStatus status = checkType(index, asynParamUInt32Digital);
+    if (status) return status;
+    uInt32Value& current = this->uInt32Values[this->slots[index]];
+    current.risingMask &= ~mask;
+    current.fallingMask &= ~mask;
     return asynSuccess;
 }
 
@@ -532,17 +932,18 @@ asynStatus paramList::clearUInt32Interrupt(int index, epicsUInt32 mask)
   * or asynParamWrongType if the parameter type is not asynParamUInt32Digital */
 asynStatus paramList::getUInt32Interrupt(int index, epicsUInt32 *mask, interruptReason reason)
 {
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    if (this->vals[index]->type != asynParamUInt32Digital) return asynParamWrongType;
+    asynStatus status = checkType(index, asynParamUInt32Digital);
+    if (status) return status;
+    const uInt32Value& current = this->uInt32Values[this->slots[index]];
     switch (reason) {
       case interruptOnZeroToOne:
-        *mask = this->vals[index]->uInt32RisingMask;
+        *mask = current.risingMask;
         break;
       case interruptOnOneToZero:
-        *mask = this->vals[index]->uInt32FallingMask;
+        *mask = current.fallingMask;
         break;
       case interruptOnBoth:
-        *mask = this->vals[index]->uInt32RisingMask | this->vals[index]->uInt32FallingMask;
+        *mask = current.risingMask | current.fallingMask;
         break;
     }
     return asynSuccess;
@@ -556,26 +957,13 @@ asynStatus paramList::getUInt32Interrupt(int index, epicsUInt32 *mask, interrupt
   * or asynParamUndefined if the value has not been defined. */
 asynStatus paramList::getString(int index, int maxChars, char *value)
 {
-    asynStatus status=asynSuccess;
-
-    try {
-        if (maxChars > 0) {
-            paramVal *pVal = getParameter(index);
-            status = pVal->getStatus();
-            strncpy(value, pVal->getString().c_str(), maxChars-1);
-            value[maxChars-1] = '\0';
-        }
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamValNotDefined&){
-        return asynParamUndefined;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return status;
+    if (maxChars <= 0) return asynSuccess;
+    asynStatus status = checkType(index, asynParamOctet);
+    if (status) return status;
+    if (!this->states[index].defined) return asynParamUndefined;
+    strncpy(value, this->stringValues[this->slots[index]].c_str(), maxChars-1);
+    value[maxChars-1] = '\0';
+    return this->states[index].status;
 }
 
 /** Returns the value for a string from the parameter library.
@@ -585,23 +973,7 @@ asynStatus paramList::getString(int index, int maxChars, char *value)
   * or asynParamUndefined if the value has not been defined. */
 asynStatus paramList::getString(int index, std::string& value)
 {
-    asynStatus status=asynSuccess;
-
-    try {
-        paramVal *pVal = getParameter(index);
-        status = pVal->getStatus();
-        value = pVal->getString();
-    }
-    catch (ParamValWrongType&){
-        return asynParamWrongType;
-    }
-    catch (ParamValNotDefined&){
-        return asynParamUndefined;
-    }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    return status;
+    return getValue(index, asynParamOctet, this->stringValues, &value);
 }
 
 /** Returns the name of a parameter from the parameter library.
@@ -610,8 +982,19 @@ asynStatus paramList::getString(int index, std::string& value)
   * \return Returns asynParamBadIndex if the index is not valid */
 asynStatus paramList::getName(int index, const char **value)
 {
-    if (index < 0 || (size_t)index >= this->vals.size()) return asynParamBadIndex;
-    *value = (const char *)this->vals[index]->getName();
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    *value = this->names[index];
+    return asynSuccess;
+}
+
+/** Returns the type of a parameter from the parameter library.
+  * \param[in] index The parameter number
+  * \param[out] type Address of the type to get.
+  * \return Returns asynParamBadIndex if the index is not valid */
+asynStatus paramList::getType(int index, asynParamType *type)
+{
+    if (index < 0 || (size_t)index >= this->types.size()) return asynParamBadIndex;
+    *type = this->types[index];
     return asynSuccess;
 }
 
@@ -635,8 +1018,8 @@ asynStatus paramList::int32Callback(int command, int addr)
     getAlarmSeverity(command, &alarmSeverity);
     if (!pInterfaces->int32InterruptPvt) return asynParamNotFound;
     pasynManager->interruptStart(pInterfaces->int32InterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(pInterfaces->int32InterruptPvt, command, addr);
+    while ((pnode = clients.next())) {
         asynInt32Interrupt *pInterrupt = (asynInt32Interrupt *) pnode->drvPvt;
         this->pasynPortDriver->getAddress(pInterrupt->pasynUser, &address);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -653,7 +1036,6 @@ asynStatus paramList::int32Callback(int command, int addr)
                                  pInterrupt->pasynUser,
                                  value);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(pInterfaces->int32InterruptPvt);
     return asynSuccess;
@@ -679,8 +1061,8 @@ asynStatus paramList::int64Callback(int command, int addr)
     getAlarmSeverity(command, &alarmSeverity);
     if (!pInterfaces->int64InterruptPvt) return asynParamNotFound;
     pasynManager->interruptStart(pInterfaces->int64InterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(pInterfaces->int64InterruptPvt, command, addr);
+    while ((pnode = clients.next())) {
         asynInt64Interrupt *pInterrupt = (asynInt64Interrupt *) pnode->drvPvt;
         this->pasynPortDriver->getAddress(pInterrupt->pasynUser, &address);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -697,7 +1079,6 @@ asynStatus paramList::int64Callback(int command, int addr)
                                  pInterrupt->pasynUser,
                                  value);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(pInterfaces->int64InterruptPvt);
     return asynSuccess;
@@ -723,8 +1104,8 @@ asynStatus paramList::uint32Callback(int command, int addr, epicsUInt32 interrup
     getAlarmSeverity(command, &alarmSeverity);
     if (!pInterfaces->uInt32DigitalInterruptPvt) return asynParamNotFound;
     pasynManager->interruptStart(pInterfaces->uInt32DigitalInterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(pInterfaces->uInt32DigitalInterruptPvt, command, addr);
+    while ((pnode = clients.next())) {
         asynUInt32DigitalInterrupt *pInterrupt = (asynUInt32DigitalInterrupt *) pnode->drvPvt;
         this->pasynPortDriver->getAddress(pInterrupt->pasynUser, &address);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -742,7 +1123,6 @@ asynStatus paramList::uint32Callback(int command, int addr, epicsUInt32 interrup
                                  pInterrupt->pasynUser,
                                  pInterrupt->mask & value);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(pInterfaces->uInt32DigitalInterruptPvt);
     return asynSuccess;
@@ -768,8 +1148,8 @@ asynStatus paramList::float64Callback(int command, int addr)
     getAlarmSeverity(command, &alarmSeverity);
     if (!pInterfaces->float64InterruptPvt) return asynParamNotFound;
     pasynManager->interruptStart(pInterfaces->float64InterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(pInterfaces->float64InterruptPvt, command, addr);
+    while ((pnode = clients.next())) {
         asynFloat64Interrupt *pInterrupt = (asynFloat64Interrupt *) pnode->drvPvt;
         this->pasynPortDriver->getAddress(pInterrupt->pasynUser, &address);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -786,7 +1166,6 @@ asynStatus paramList::float64Callback(int command, int addr)
                                  pInterrupt->pasynUser,
                                  value);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(pInterfaces->float64InterruptPvt);
     return asynSuccess;
@@ -807,14 +1186,14 @@ asynStatus paramList::octetCallback(int command, int addr)
     asynStatus status=asynSuccess;
 
     /* Pass octet interrupts */
-    value = (char *)getParameter(command)->getString().c_str();
+    value = (char *)this->stringValues[this->slots[command]].c_str();
     getStatus(command, &status);
     getAlarmStatus(command, &alarmStatus);
     getAlarmSeverity(command, &alarmSeverity);
     if (!pInterfaces->octetInterruptPvt) return asynParamNotFound;
     pasynManager->interruptStart(pInterfaces->octetInterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(pInterfaces->octetInterruptPvt, command, addr);
+    while ((pnode = clients.next())) {
         asynOctetInterrupt *pInterrupt = (asynOctetInterrupt *) pnode->drvPvt;
         this->pasynPortDriver->getAddress(pInterrupt->pasynUser, &address);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -831,7 +1210,6 @@ asynStatus paramList::octetCallback(int command, int addr)
                                  pInterrupt->pasynUser,
                                  value, strlen(value)+1, ASYN_EOM_END);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(pInterfaces->octetInterruptPvt);
     return asynSuccess;
@@ -852,38 +1230,40 @@ asynStatus paramList::callCallbacks(int addr)
 
     if (!interruptAccept) return asynSuccess;
 
-    try {
-        for (size_t i = 0; i < this->flags.size(); i++)
-        {
-            index = this->flags[i];
-            paramVal *param(getParameter(index));
-            if (!param->isDefined()) continue;
-            switch(param->type) {
-                case asynParamInt32:
-                    status = int32Callback(index, addr);
-                    break;
-                case asynParamInt64:
-                    status = int64Callback(index, addr);
-                    break;
-                case asynParamUInt32Digital:
-                    status = uint32Callback(index, addr, this->vals[index]->uInt32CallbackMask);
-                    this->vals[index]->uInt32CallbackMask = 0;
-                    break;
-                case asynParamFloat64:
-                    status = float64Callback(index, addr);
-                    break;
-                case asynParamOctet:
-                    status = octetCallback(index, addr);
-                    break;
-                default:
-                    break;
+    if (pasynPortDriver->batchCallbacks || !pasynPortDriver->bulkClients.empty() ||
+        pasynPortDriver->pDispatcher)
+        return callCallbacksBatched(addr);
+
+    orderChanges();
+    for (size_t i = 0; i < this->journal.size(); i++)
+    {
+        index = this->journal[i];
+        this->dirty[index >> 5] &= ~(1u << (index & 31));
+        if (!this->states[index].defined) continue;
+        switch(this->types[index]) {
+            case asynParamInt32:
+                status = int32Callback(index, addr);
+                break;
+            case asynParamInt64:
+                status = int64Callback(index, addr);
+                break;
+            case asynParamUInt32Digital: {
+                uInt32Value& current = this->uInt32Values[this->slots[index]];
+                status = uint32Callback(index, addr, current.callbackMask);
+                current.callbackMask = 0;
+                break;
             }
+            case asynParamFloat64:
+                status = float64Callback(index, addr);
+                break;
+            case asynParamOctet:
+                status = octetCallback(index, addr);
+                break;
+            default:
+                break;
         }
     }
-    catch (ParamListInvalidIndex&) {
-        return asynParamBadIndex;
-    }
-    flags.clear();
+    this->journal.clear();
     return status;
 }
 
@@ -892,6 +1272,315 @@ asynStatus paramList::callCallbacks()
     return callCallbacks(0);
 }
 
+/** Batched version of callCallbacks, used if asynPortDriver::setBatchCallbacks was called,
+  * if there are any bulk callback clients, or if there is a callback dispatcher.
+  * Takes a snapshot of all changed parameters, then calls the clients of each interface
+  * with a single interruptStart/interruptEnd, and finally calls the bulk callback clients
+  * with the complete set. If there is a callback dispatcher the snapshot is queued to it instead
+  * of calling the interface clients directly. Must be called with paramLock held.
+  * \param[in] addr A client will be called if addr matches the asyn address registered for that client. */
+asynStatus paramList::callCallbacksBatched(int addr)
+{
+    static const asynParamType scalarTypes[] = {asynParamInt32, asynParamInt64, asynParamUInt32Digital,
+                                                asynParamFloat64, asynParamOctet};
+    bool hasType[asynParamOctet+1] = {false};
+    asynStatus status = asynSuccess;
+    asynStatus deliverStatus;
+    epicsTimeStamp timeStamp;
+    size_t i;
+
+    this->pasynPortDriver->getTimeStamp(&timeStamp);
+    this->changes.clear();
+    orderChanges();
+    for (i = 0; i < this->journal.size(); i++) {
+        int index = this->journal[i];
+        this->dirty[index >> 5] &= ~(1u << (index & 31));
+        int slot = this->slots[index];
+        const paramState& state = this->states[index];
+        asynParamChange change;
+
+        if (!state.defined) continue;
+        change.index = index;
+        change.type = this->types[index];
+        change.status = state.status;
+        change.alarmStatus = state.alarmStatus;
+        change.alarmSeverity = state.alarmSeverity;
+        change.interruptMask = 0;
+        switch (change.type) {
+            case asynParamInt32:
+                change.value.ival = this->int32Values[slot];
+                break;
+            case asynParamInt64:
+                change.value.i64val = this->int64Values[slot];
+                break;
+            case asynParamUInt32Digital:
+                change.value.uival = this->uInt32Values[slot].value;
+                change.interruptMask = this->uInt32Values[slot].callbackMask;
+                this->uInt32Values[slot].callbackMask = 0;
+                break;
+            case asynParamFloat64:
+                change.value.dval = this->float64Values[slot];
+                break;
+            case asynParamOctet:
+                change.value.sval = this->stringValues[slot].c_str();
+                break;
+            default:
+                continue;
+        }
+        hasType[change.type] = true;
+        this->changes.push_back(change);
+    }
+    this->journal.clear();
+
+    if (pasynPortDriver->pDispatcher) {
+        for (i = 0; i < this->changes.size(); i++) {
+            pasynPortDriver->pDispatcher->enqueue(addr, &this->changes[i], &timeStamp);
+        }
+    } else {
+        for (i = 0; i < sizeof(scalarTypes)/sizeof(scalarTypes[0]); i++) {
+            if (!hasType[scalarTypes[i]]) continue;
+            deliverStatus = deliverChanges(scalarTypes[i], addr, &timeStamp);
+            if (deliverStatus) status = deliverStatus;
+        }
+    }
+
+    if (!this->changes.empty()) {
+        for (i = 0; i < pasynPortDriver->bulkClients.size(); i++) {
+            pasynPortDriver->bulkClients[i].callback(pasynPortDriver->bulkClients[i].userPvt, addr,
+                                                     &this->changes[0], this->changes.size(), &timeStamp);
+        }
+    }
+    return status;
+}
+
+static void setCallbackInfo(asynUser *pasynUser, const asynParamChange *pChange, const epicsTimeStamp *pTimeStamp)
+{
+    pasynUser->auxStatus = pChange->status;
+    pasynUser->alarmStatus = pChange->alarmStatus;
+    pasynUser->alarmSeverity = pChange->alarmSeverity;
+    pasynUser->timestamp = *pTimeStamp;
+}
+
+/** Returns the interruptPvt of the interface used for callbacks of a scalar parameter type, or NULL. */
+static void *scalarInterruptPvt(asynStandardInterfaces *pInterfaces, asynParamType type)
+{
+    switch (type) {
+        case asynParamInt32:         return pInterfaces->int32InterruptPvt;
+        case asynParamInt64:         return pInterfaces->int64InterruptPvt;
+        case asynParamUInt32Digital: return pInterfaces->uInt32DigitalInterruptPvt;
+        case asynParamFloat64:       return pInterfaces->float64InterruptPvt;
+        case asynParamOctet:         return pInterfaces->octetInterruptPvt;
+        default:                     return NULL;
+    }
+}
+
+/** Calls the registered clients for one changed parameter.
+  * Must be called between interruptStart and interruptEnd on interruptPvt. */
+static void deliverChange(asynPortDriver *pPort, void *interruptPvt, const asynParamChange *pChange,
+                          int addr, const epicsTimeStamp *pTimeStamp)
+{
+    interruptNode *pnode;
+    int address;
+
+    interruptClientIterator clients(interruptPvt, pChange->index, addr);
+    while ((pnode = clients.next())) {
+        switch (pChange->type) {
+            case asynParamInt32: {
+                asynInt32Interrupt *pInterrupt = (asynInt32Interrupt *)pnode->drvPvt;
+                pPort->getAddress(pInterrupt->pasynUser, &address);
+                if ((pChange->index != pInterrupt->pasynUser->reason) || (address != addr)) break;
+                setCallbackInfo(pInterrupt->pasynUser, pChange, pTimeStamp);
+                pInterrupt->callback(pInterrupt->userPvt, pInterrupt->pasynUser, pChange->value.ival);
+                break;
+            }
+            case asynParamInt64: {
+                asynInt64Interrupt *pInterrupt = (asynInt64Interrupt *)pnode->drvPvt;
+                pPort->getAddress(pInterrupt->pasynUser, &address);
+                if ((pChange->index != pInterrupt->pasynUser->reason) || (address != addr)) break;
+                setCallbackInfo(pInterrupt->pasynUser, pChange, pTimeStamp);
+                pInterrupt->callback(pInterrupt->userPvt, pInterrupt->pasynUser, pChange->value.i64val);
+                break;
+            }
+            case asynParamUInt32Digital: {
+                asynUInt32DigitalInterrupt *pInterrupt = (asynUInt32DigitalInterrupt *)pnode->drvPvt;
+                pPort->getAddress(pInterrupt->pasynUser, &address);
+                if ((pChange->index != pInterrupt->pasynUser->reason) || (address != addr) ||
+                    !(pInterrupt->mask & pChange->interruptMask)) break;
+                setCallbackInfo(pInterrupt->pasynUser, pChange, pTimeStamp);
+                pInterrupt->callback(pInterrupt->userPvt, pInterrupt->pasynUser,
+                                     pInterrupt->mask & pChange->value.uival);
+                break;
+            }
+            case asynParamFloat64: {
+                asynFloat64Interrupt *pInterrupt = (asynFloat64Interrupt *)pnode->drvPvt;
+                pPort->getAddress(pInterrupt->pasynUser, &address);
+                if ((pChange->index != pInterrupt->pasynUser->reason) || (address != addr)) break;
+                setCallbackInfo(pInterrupt->pasynUser, pChange, pTimeStamp);
+                pInterrupt->callback(pInterrupt->userPvt, pInterrupt->pasynUser, pChange->value.dval);
+                break;
+            }
+            case asynParamOctet: {
+                asynOctetInterrupt *pInterrupt = (asynOctetInterrupt *)pnode->drvPvt;
+                pPort->getAddress(pInterrupt->pasynUser, &address);
+                if ((pChange->index != pInterrupt->pasynUser->reason) || (address != addr)) break;
+                setCallbackInfo(pInterrupt->pasynUser, pChange, pTimeStamp);
+                pInterrupt->callback(pInterrupt->userPvt, pInterrupt->pasynUser,
+                                     (char *)pChange->value.sval, strlen(pChange->value.sval)+1, ASYN_EOM_END);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+/** Calls the registered clients of one interface for all parameters of that type in the snapshot
+  * taken by callCallbacksBatched.
+  * \param[in] type The parameter type, which selects the interface.
+  * \param[in] addr A client will be called if addr matches the asyn address registered for that client.
+  * \param[in] pTimeStamp The timestamp for the callbacks. */
+asynStatus paramList::deliverChanges(asynParamType type, int addr, const epicsTimeStamp *pTimeStamp)
+{
+    ELLLIST *pclientList;
+    void *interruptPvt = scalarInterruptPvt(this->pasynPortDriver->getAsynStdInterfaces(), type);
+
+    if (!interruptPvt) return asynParamNotFound;
+    pasynManager->interruptStart(interruptPvt, &pclientList);
+    for (size_t i = 0; i < this->changes.size(); i++) {
+        if (this->changes[i].type != type) continue;
+        deliverChange(this->pasynPortDriver, interruptPvt, &this->changes[i], addr, pTimeStamp);
+    }
+    pasynManager->interruptEnd(interruptPvt);
+    return asynSuccess;
+}
+
+/** Constructor for the callbackDispatcher class.
+  * \param[in] pPortIn The asynPortDriver whose callbacks are dispatched.
+  * \param[in] numThreads The number of dispatcher threads.
+  * \param[in] queueDepthIn The maximum number of queued callbacks per thread. */
+callbackDispatcher::callbackDispatcher(asynPortDriver *pPortIn, int numThreads, int queueDepthIn)
+    : pPort(pPortIn), queueDepth(queueDepthIn)
+{
+    for (int i=0; i<numThreads; i++) {
+        workers.push_back(new worker(this, i));
+    }
+}
+
+/** Destructor for the callbackDispatcher class; stops the threads, discarding any queued callbacks. */
+callbackDispatcher::~callbackDispatcher()
+{
+    for (size_t i=0; i<workers.size(); i++) {
+        delete workers[i];
+    }
+}
+
+/** Queues a changed parameter for delivery by one of the dispatcher threads.
+  * \param[in] addr The asyn address for the callbacks.
+  * \param[in] pChange The changed parameter. An octet value is copied.
+  * \param[in] pTimeStamp The timestamp for the callbacks. */
+void callbackDispatcher::enqueue(int addr, const asynParamChange *pChange, const epicsTimeStamp *pTimeStamp)
+{
+    dispatchKey key(addr, pChange->index);
+    worker *pWorker = workers[((unsigned)addr*31u + (unsigned)pChange->index) % workers.size()];
+    std::map<dispatchKey, std::list<dispatchItem>::iterator>::iterator it;
+    dispatchItem *pItem;
+    epicsUInt32 interruptMask = 0;
+
+    {
+        epicsGuard<epicsMutex> _lock(pWorker->queueLock);
+        it = pWorker->pending.find(key);
+        if (it != pWorker->pending.end()) {
+            /* Replace the value that has not been delivered yet */
+            pItem = &*it->second;
+            interruptMask = pItem->change.interruptMask;
+            pWorker->coalesced++;
+        } else if (pWorker->queue.size() >= queueDepth) {
+            pWorker->dropped++;
+            return;
+        } else {
+            pWorker->queue.push_back(dispatchItem());
+            pWorker->pending[key] = --pWorker->queue.end();
+            pItem = &pWorker->queue.back();
+            if (pWorker->queue.size() > pWorker->highWater) pWorker->highWater = pWorker->queue.size();
+        }
+        pItem->addr = addr;
+        pItem->change = *pChange;
+        pItem->change.interruptMask |= interruptMask;
+        if (pChange->type == asynParamOctet) pItem->sval = pChange->value.sval;
+        pItem->timeStamp = *pTimeStamp;
+    }
+    pWorker->wakeup.signal();
+}
+
+/** Reports the queue statistics of each dispatcher thread.
+  * \param[in] fp The file pointer on which report information will be written
+  * \param[in] details The level of report detail desired. */
+void callbackDispatcher::report(FILE *fp, int details)
+{
+    fprintf(fp, "  Callback dispatcher: %d threads, queue depth %d\n",
+            (int)workers.size(), (int)queueDepth);
+    for (size_t i=0; i<workers.size(); i++) {
+        worker *pWorker = workers[i];
+        epicsGuard<epicsMutex> _lock(pWorker->queueLock);
+        fprintf(fp, "    Thread %d: queued=%d, high water=%d, delivered=%lu, coalesced=%lu, dropped=%lu\n",
+                (int)i, (int)pWorker->queue.size(), (int)pWorker->highWater,
+                pWorker->delivered, pWorker->coalesced, pWorker->dropped);
+    }
+}
+
+callbackDispatcher::worker::worker(callbackDispatcher *pDispatcherIn, int id)
+    : pDispatcher(pDispatcherIn), exiting(false), highWater(0), delivered(0), coalesced(0), dropped(0)
+{
+    char threadName[64];
+
+    epicsSnprintf(threadName, sizeof(threadName), "%.50s_cb%d", pDispatcher->pPort->portName, id);
+    pThread = new epicsThread(*this, threadName, epicsThreadGetStackSize(epicsThreadStackMedium),
+                              epicsThreadPriorityMedium);
+    pThread->start();
+}
+
+callbackDispatcher::worker::~worker()
+{
+    {
+        epicsGuard<epicsMutex> _lock(queueLock);
+        exiting = true;
+    }
+    wakeup.signal();
+    pThread->exitWait();
+    delete pThread;
+}
+
+void callbackDispatcher::worker::run()
+{
+    asynStandardInterfaces *pInterfaces = pDispatcher->pPort->getAsynStdInterfaces();
+    ELLLIST *pclientList;
+    void *interruptPvt;
+    dispatchItem item;
+
+    while (1) {
+        {
+            epicsGuard<epicsMutex> _lock(queueLock);
+            while (queue.empty() && !exiting) {
+                epicsGuardRelease<epicsMutex> _unlock(_lock);
+                wakeup.wait();
+            }
+            if (exiting) break;
+            item = queue.front();
+            pending.erase(dispatchKey(item.addr, item.change.index));
+            queue.pop_front();
+        }
+        if (item.change.type == asynParamOctet) item.change.value.sval = item.sval.c_str();
+        interruptPvt = scalarInterruptPvt(pInterfaces, item.change.type);
+        if (interruptPvt) {
+            pasynManager->interruptStart(interruptPvt, &pclientList);
+            deliverChange(pDispatcher->pPort, interruptPvt, &item.change, item.addr, &item.timeStamp);
+            pasynManager->interruptEnd(interruptPvt);
+        }
+        epicsGuard<epicsMutex> _lock(queueLock);
+        delivered++;
+    }
+}
+
 /** Reports on status of the paramList
   * \param[in] fp The file pointer on which report information will be written
   * \param[in] details The level of report detail desired. Prints the number of parameters in the list,
@@ -899,25 +1588,56 @@ asynStatus paramList::callCallbacks()
  */
 void paramList::report(FILE *fp, int details)
 {
-    fprintf(fp, "Number of parameters is: %u\n", (unsigned)this->vals.size() );
-    for (int i=0; i<(int)this->vals.size(); i++)
+    static const char *typeNames[] = {NULL, "asynInt32", "asynInt64", "asynUInt32Digital", "asynFloat64", "string",
+                                      "asynInt8Array", "asynInt16Array", "asynInt32Array", "asynInt64Array",
+                                      "asynFloat32Array", "asynFloat64Array", NULL};
+
+    fprintf(fp, "Number of parameters is: %u\n", (unsigned)this->types.size() );
+    fprintf(fp, "Changes to parameters already flagged for callbacks: %lu\n", this->suppressed);
+    for (int i=0; i<(int)this->types.size(); i++)
     {
-        this->vals[i]->report(i, fp, details);
+        asynParamType type = this->types[i];
+        const paramState& state = this->states[i];
+        const char *name = this->names[i];
+        int slot = this->slots[i];
+
+        if (((unsigned)type >= sizeof(typeNames)/sizeof(typeNames[0])) || !typeNames[type]) {
+            fprintf(fp, "Parameter %d is undefined, name=%s\n", i, name);
+            continue;
+        }
+        if (!state.defined) {
+            fprintf(fp, "Parameter %d type=%s, name=%s, value is undefined\n", i, typeNames[type], name);
+            continue;
+        }
+        switch (type) {
+            case asynParamInt32:
+                fprintf(fp, "Parameter %d type=asynInt32, name=%s, value=%d, status=%d\n",
+                    i, name, this->int32Values[slot], state.status);
+                break;
+            case asynParamInt64:
+                fprintf(fp, "Parameter %d type=asynInt64, name=%s, value=%lld, status=%d\n",
+                    i, name, (long long)this->int64Values[slot], state.status);
+                break;
+            case asynParamUInt32Digital:
+                fprintf(fp, "Parameter %d type=asynUInt32Digital, name=%s, value=0x%x, status=%d, risingMask=0x%x, fallingMask=0x%x, callbackMask=0x%x\n",
+                    i, name, this->uInt32Values[slot].value, state.status, this->uInt32Values[slot].risingMask,
+                    this->uInt32Values[slot].fallingMask, this->uInt32Values[slot].callbackMask);
+                break;
+            case asynParamFloat64:
+                fprintf(fp, "Parameter %d type=asynFloat64, name=%s, value=%g, status=%d\n",
+                    i, name, this->float64Values[slot], state.status);
+                break;
+            case asynParamOctet:
+                fprintf(fp, "Parameter %d type=string, name=%s, value=%s, status=%d\n",
+                    i, name, this->stringValues[slot].c_str(), state.status);
+                break;
+            default:
+                fprintf(fp, "Parameter %d type=%s, name=%s, status=%d\n", i, typeNames[type], name, state.status);
+                break;
+        }
     }
 }
 
-/** Get a parameter from the list by index
- *  \param[in] index The index of the desired parameter in the list
- *  \return The parameter associated with the input index
- *  \throws ParamListInvalidIndex if the index is outside the list
- *  boundaries
- */
-paramVal* paramList::getParameter(int index)
-{
-    if (index < 0 || (size_t)index >= this->vals.size()) throw ParamListInvalidIndex("paramList::getParameter invalid index");
-    return this->vals[index];
-}
-
 callbackThread::callbackThread(asynPortDriver *portDriver) :
     pThread(new epicsThread(*this, "asynPortDriverCallback", epicsThreadGetStackSize(epicsThreadStackMedium), epicsThreadPriorityMedium)),
     pPortDriver(portDriver)
@@ -1010,6 +1730,13 @@ asynStatus asynPortDriver::createParam(int list, const char *name, asynParamType
 
     paramList *pList=getParamList(list);
     if (!pList) return asynParamInvalidList;
+    if (this->paramsFixed) {
+        /* Readers without the driver lock may be using the parameter vectors */
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+            "%s:%s: port=%s error adding parameter %s to list %d, lock-free reads have been enabled\n",
+            driverName, functionName, portName, name, list);
+        return asynError;
+    }
     status = pList->createParam(name, type, index);
     if (status == asynParamAlreadyExists) {
         asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
@@ -1102,8 +1829,7 @@ asynStatus asynPortDriver::getParamType(int list, int index, asynParamType *type
 {
     paramList *pList=getParamList(list);
     if (!pList) return asynParamInvalidList;
-    *type = pList->getParameter(index)->type;
-    return asynSuccess;
+    return pList->getType(index, type);
 }
 
 /** Reports errors when setting parameters.
@@ -1523,6 +2249,151 @@ asynStatus asynPortDriver::setDoubleParam(int list, int index, double value)
     return status;
 }
 
+template <typename epicsType>
+asynStatus asynPortDriver::setParamValues(int list, const int *indices, int first,
+                                          const epicsType *values, size_t nValues,
+                                          const char *functionName)
+{
+    asynStatus status;
+    int errorIndex = -1;
+
+    paramList *pList=getParamList(list);
+    if (!pList)
+        status = asynParamInvalidList;
+    else
+        status = pList->setValues(indices, first, values, nValues, &errorIndex);
+    if (status) reportSetParamErrors(status, errorIndex, list, functionName);
+    return status;
+}
+
+/** Sets the values of a range of integer parameters in the parameter library.
+  * Calls setIntegerParams(0, first, values, nValues) i.e. for parameter list 0.
+  * \param[in] first The first parameter number
+  * \param[in] values The values for parameters first to first+nValues-1
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setIntegerParams(int first, const epicsInt32 *values, size_t nValues)
+{
+    return this->setIntegerParams(0, first, values, nValues);
+}
+
+/** Sets the values of a range of integer parameters in the parameter library.
+  * This is faster than calling setIntegerParam for each parameter. All the parameters
+  * are checked first, and if any is not valid no value is set.
+  * \param[in] list The parameter list number.  Must be < maxAddr passed to asynPortDriver::asynPortDriver.
+  * \param[in] first The first parameter number
+  * \param[in] values The values for parameters first to first+nValues-1
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setIntegerParams(int list, int first, const epicsInt32 *values, size_t nValues)
+{
+    return setParamValues(list, 0, first, values, nValues, "setIntegerParams");
+}
+
+/** Sets the values of several integer parameters in the parameter library.
+  * Calls setIntegerParams(0, indices, values, nValues) i.e. for parameter list 0.
+  * \param[in] indices The parameter numbers
+  * \param[in] values The values, values[i] is for parameter indices[i]
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setIntegerParams(const int *indices, const epicsInt32 *values, size_t nValues)
+{
+    return this->setIntegerParams(0, indices, values, nValues);
+}
+
+/** Sets the values of several integer parameters in the parameter library.
+  * This is faster than calling setIntegerParam for each parameter. All the parameters
+  * are checked first, and if any is not valid no value is set.
+  * \param[in] list The parameter list number.  Must be < maxAddr passed to asynPortDriver::asynPortDriver.
+  * \param[in] indices The parameter numbers
+  * \param[in] values The values, values[i] is for parameter indices[i]
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setIntegerParams(int list, const int *indices, const epicsInt32 *values, size_t nValues)
+{
+    return setParamValues(list, indices, 0, values, nValues, "setIntegerParams");
+}
+
+/** Sets the values of a range of 64-bit integer parameters in the parameter library.
+  * Calls setInteger64Params(0, first, values, nValues) i.e. for parameter list 0.
+  * \param[in] first The first parameter number
+  * \param[in] values The values for parameters first to first+nValues-1
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setInteger64Params(int first, const epicsInt64 *values, size_t nValues)
+{
+    return this->setInteger64Params(0, first, values, nValues);
+}
+
+/** Sets the values of a range of 64-bit integer parameters in the parameter library.
+  * See setIntegerParams.
+  * \param[in] list The parameter list number.  Must be < maxAddr passed to asynPortDriver::asynPortDriver.
+  * \param[in] first The first parameter number
+  * \param[in] values The values for parameters first to first+nValues-1
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setInteger64Params(int list, int first, const epicsInt64 *values, size_t nValues)
+{
+    return setParamValues(list, 0, first, values, nValues, "setInteger64Params");
+}
+
+/** Sets the values of several 64-bit integer parameters in the parameter library.
+  * Calls setInteger64Params(0, indices, values, nValues) i.e. for parameter list 0.
+  * \param[in] indices The parameter numbers
+  * \param[in] values The values, values[i] is for parameter indices[i]
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setInteger64Params(const int *indices, const epicsInt64 *values, size_t nValues)
+{
+    return this->setInteger64Params(0, indices, values, nValues);
+}
+
+/** Sets the values of several 64-bit integer parameters in the parameter library.
+  * See setIntegerParams.
+  * \param[in] list The parameter list number.  Must be < maxAddr passed to asynPortDriver::asynPortDriver.
+  * \param[in] indices The parameter numbers
+  * \param[in] values The values, values[i] is for parameter indices[i]
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setInteger64Params(int list, const int *indices, const epicsInt64 *values, size_t nValues)
+{
+    return setParamValues(list, indices, 0, values, nValues, "setInteger64Params");
+}
+
+/** Sets the values of a range of double parameters in the parameter library.
+  * Calls setDoubleParams(0, first, values, nValues) i.e. for parameter list 0.
+  * \param[in] first The first parameter number
+  * \param[in] values The values for parameters first to first+nValues-1
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setDoubleParams(int first, const epicsFloat64 *values, size_t nValues)
+{
+    return this->setDoubleParams(0, first, values, nValues);
+}
+
+/** Sets the values of a range of double parameters in the parameter library.
+  * See setIntegerParams.
+  * \param[in] list The parameter list number.  Must be < maxAddr passed to asynPortDriver::asynPortDriver.
+  * \param[in] first The first parameter number
+  * \param[in] values The values for parameters first to first+nValues-1
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setDoubleParams(int list, int first, const epicsFloat64 *values, size_t nValues)
+{
+    return setParamValues(list, 0, first, values, nValues, "setDoubleParams");
+}
+
+/** Sets the values of several double parameters in the parameter library.
+  * Calls setDoubleParams(0, indices, values, nValues) i.e. for parameter list 0.
+  * \param[in] indices The parameter numbers
+  * \param[in] values The values, values[i] is for parameter indices[i]
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setDoubleParams(const int *indices, const epicsFloat64 *values, size_t nValues)
+{
+    return this->setDoubleParams(0, indices, values, nValues);
+}
+
+/** Sets the values of several double parameters in the parameter library.
+  * See setIntegerParams.
+  * \param[in] list The parameter list number.  Must be < maxAddr passed to asynPortDriver::asynPortDriver.
+  * \param[in] indices The parameter numbers
+  * \param[in] values The values, values[i] is for parameter indices[i]
+  * \param[in] nValues The number of values */
+asynStatus asynPortDriver::setDoubleParams(int list, const int *indices, const epicsFloat64 *values, size_t nValues)
+{
+    return setParamValues(list, indices, 0, values, nValues, "setDoubleParams");
+}
+
 /** Sets the value for a string in the parameter library.
   * Calls setStringParam(0, index, value) i.e. for parameter list 0.
   * \param[in] index The parameter number
@@ -1808,6 +2679,211 @@ asynStatus asynPortDriver::callParamCallbacks(int list, int addr)
     return status;
 }
 
+/** Selects batched delivery of parameter callbacks.
+  * When enabled, callParamCallbacks takes a snapshot of all changed parameters in the list,
+  * and then calls the clients of each interface type with a single interruptStart/interruptEnd.
+  * Clients are then called grouped by interface type, rather than in the order in which the
+  * parameters were changed.
+  * Batched delivery is always used when there are bulk callback clients.
+  * \param[in] enable 1 to enable batched delivery, 0 to disable it. */
+asynStatus asynPortDriver::setBatchCallbacks(int enable)
+{
+    this->lock();
+    this->batchCallbacks = enable;
+    this->unlock();
+    return asynSuccess;
+}
+
+/** Selects reading of scalar parameters without the driver lock.
+  * When enabled, reads through the asynInt32, asynInt64, asynUInt32Digital and asynFloat64 interfaces
+  * return the value in the parameter library without calling lock(), so clients such as device support
+  * and asynPortClient do not wait for a driver thread that holds the lock. A read that overlaps a change
+  * to the parameter list is retried, so it never returns a partly written value.
+  * The timestamp is read in the same check, so it must be changed with setTimeStamp or updateTimeStamp.
+  * readInt32, readInt64, readUInt32Digital and readFloat64 are then not called, so this must only be
+  * enabled by drivers that do not reimplement them, and only after all parameters have been created.
+  * Once they have been enabled createParam returns asynError, even after they are disabled again,
+  * because a read may still be using the parameter library.
+  * \param[in] enable 1 to enable reads without the driver lock, 0 to disable them. */
+asynStatus asynPortDriver::setLockFreeReads(int enable)
+{
+    this->lock();
+    this->lockFreeReads = enable;
+    if (enable) this->paramsFixed = 1;
+    this->unlock();
+    return asynSuccess;
+}
+
+/** Returns 1 if setLockFreeReads has enabled reads without the driver lock, else 0. */
+int asynPortDriver::getLockFreeReads()
+{
+    return this->lockFreeReads;
+}
+
+/** Reads a scalar parameter from the parameter library without the driver lock.
+  * Sets the alarm status, severity and timestamp in pasynUser as readInt32 and friends do.
+  * \param[in] pasynUser pasynUser structure that encodes the reason and address.
+  * \param[out] value Address of the value to read.
+  * \param[in] functionName The name of the read function, for error messages.
+  * \param[out] function The parameter number.
+  * \param[out] paramName The parameter name. */
+template <typename epicsType>
+asynStatus asynPortDriver::readScalarParam(asynUser *pasynUser, epicsType *value, const char *functionName,
+                                           int *function, const char **paramName)
+{
+    int addr;
+    asynStatus status;
+
+    *value = 0;
+    status = parseAsynUser(pasynUser, function, &addr, paramName);
+    if (status != asynSuccess) return status;
+    status = getParamList(addr)->readScalar(*function, value, &pasynUser->alarmStatus,
+                                            &pasynUser->alarmSeverity, &pasynUser->timestamp);
+    if (status)
+        epicsSnprintf(pasynUser->errorMessage, pasynUser->errorMessageSize,
+                  "%s:%s: status=%d, function=%d, name=%s",
+                  driverName, functionName, status, *function, *paramName);
+    return status;
+}
+
+/** Reads an asynParamInt32 parameter without the driver lock; see setLockFreeReads.
+  * \param[in] pasynUser pasynUser structure that encodes the reason and address.
+  * \param[out] value Address of the value to read. */
+asynStatus asynPortDriver::readParamLockFree(asynUser *pasynUser, epicsInt32 *value)
+{
+    int function;
+    const char *paramName;
+    static const char *functionName = "readInt32";
+    asynStatus status = readScalarParam(pasynUser, value, functionName, &function, &paramName);
+
+    if (status == asynSuccess)
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
+              "%s:%s: function=%d, name=%s, value=%d\n",
+              driverName, functionName, function, paramName, *value);
+    return status;
+}
+
+/** Reads an asynParamInt64 parameter without the driver lock; see setLockFreeReads.
+  * \param[in] pasynUser pasynUser structure that encodes the reason and address.
+  * \param[out] value Address of the value to read. */
+asynStatus asynPortDriver::readParamLockFree(asynUser *pasynUser, epicsInt64 *value)
+{
+    int function;
+    const char *paramName;
+    static const char *functionName = "readInt64";
+    asynStatus status = readScalarParam(pasynUser, value, functionName, &function, &paramName);
+
+    if (status == asynSuccess)
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
+              "%s:%s: function=%d, name=%s, value=%lld\n",
+              driverName, functionName, function, paramName, (long long)*value);
+    return status;
+}
+
+/** Reads an asynParamUInt32Digital parameter without the driver lock; see setLockFreeReads.
+  * \param[in] pasynUser pasynUser structure that encodes the reason and address.
+  * \param[out] value Address of the value to read.
+  * \param[in] mask Mask value to use when reading the value. */
+asynStatus asynPortDriver::readParamLockFree(asynUser *pasynUser, epicsUInt32 *value, epicsUInt32 mask)
+{
+    int function;
+    const char *paramName;
+    static const char *functionName = "readUInt32Digital";
+    asynStatus status = readScalarParam(pasynUser, value, functionName, &function, &paramName);
+
+    *value &= mask;
+    if (status == asynSuccess)
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
+              "%s:%s: function=%d, name=%s, value=%u, mask=%u\n",
+              driverName, functionName, function, paramName, *value, mask);
+    return status;
+}
+
+/** Reads an asynParamFloat64 parameter without the driver lock; see setLockFreeReads.
+  * \param[in] pasynUser pasynUser structure that encodes the reason and address.
+  * \param[out] value Address of the value to read. */
+asynStatus asynPortDriver::readParamLockFree(asynUser *pasynUser, epicsFloat64 *value)
+{
+    int function;
+    const char *paramName;
+    static const char *functionName = "readFloat64";
+    asynStatus status = readScalarParam(pasynUser, value, functionName, &function, &paramName);
+
+    if (status == asynSuccess)
+        asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
+              "%s:%s: function=%d, name=%s, value=%f\n",
+              driverName, functionName, function, paramName, *value);
+    return status;
+}
+
+/** Delivers scalar parameter callbacks from a pool of dispatcher threads rather than from the thread
+  * that calls callParamCallbacks.
+  * The callbacks are then called without the driver lock held, so a slow client does not block the driver.
+  * Each thread receives copies of the changed values. If a parameter changes again before its callback
+  * has been delivered the queued value is replaced. A change to another parameter when the queue is full
+  * is discarded and counted as dropped; callbacks for that parameter resume with its next change.
+  * The coalesced and dropped counts are shown by report() with details>=1.
+  * Array, genericPointer and enum callbacks are not affected.
+  * \param[in] numThreads The number of dispatcher threads; 0 disables the dispatcher.
+  * \param[in] queueDepth The number of callbacks per thread that are queued in order of change. */
+asynStatus asynPortDriver::setCallbackDispatcher(int numThreads, int queueDepth)
+{
+    callbackDispatcher *pOld;
+    static const char *functionName = "setCallbackDispatcher";
+
+    if ((numThreads < 0) || ((numThreads > 0) && (queueDepth < 1))) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+            "%s:%s: port=%s invalid numThreads=%d or queueDepth=%d\n",
+            driverName, functionName, portName, numThreads, queueDepth);
+        return asynError;
+    }
+    this->lock();
+    pOld = this->pDispatcher;
+    this->pDispatcher = (numThreads > 0) ? new callbackDispatcher(this, numThreads, queueDepth) : 0;
+    this->unlock();
+    /* Delete without the lock, the dispatcher threads may be calling clients that need it */
+    delete pOld;
+    return asynSuccess;
+}
+
+/** Registers a callback that receives all parameters that changed in each call to callParamCallbacks.
+  * The callback is called once per parameter list after the standard interface clients have been called,
+  * with the driver locked. It must not block or call callParamCallbacks.
+  * \param[in] callback The function to call.
+  * \param[in] userPvt Pointer passed to the callback. */
+asynStatus asynPortDriver::registerParamBulkCallback(asynParamBulkCallback callback, void *userPvt)
+{
+    paramBulkClient client;
+
+    if (!callback) return asynError;
+    client.callback = callback;
+    client.userPvt = userPvt;
+    this->lock();
+    this->bulkClients.push_back(client);
+    this->unlock();
+    return asynSuccess;
+}
+
+/** Cancels a callback registered with registerParamBulkCallback.
+  * \param[in] callback The function passed to registerParamBulkCallback.
+  * \param[in] userPvt The userPvt passed to registerParamBulkCallback.
+  * \return Returns asynError if the callback was not registered. */
+asynStatus asynPortDriver::cancelParamBulkCallback(asynParamBulkCallback callback, void *userPvt)
+{
+    asynStatus status = asynError;
+
+    this->lock();
+    for (size_t i = 0; i < this->bulkClients.size(); i++) {
+        if ((this->bulkClients[i].callback == callback) && (this->bulkClients[i].userPvt == userPvt)) {
+            this->bulkClients.erase(this->bulkClients.begin() + i);
+            status = asynSuccess;
+            break;
+        }
+    }
+    this->unlock();
+    return status;
+}
+
 /** Calls paramList::report(fp, details) for each parameter list that the driver supports.
   * \param[in] fp The file pointer on which report information will be written
   * \param[in] details The level of report detail desired; always report details on address 0; >=2 report all addresses */
@@ -1843,7 +2919,8 @@ asynStatus writeArray(asynUser *pasynUser, epicsType *value, size_t nElements)
 
 template <typename epicsType, typename interruptType>
 asynStatus asynPortDriver::doCallbacksArray(epicsType *value, size_t nElements,
-                                            int reason, int address, void *interruptPvt)
+                                            int reason, int address, void *interruptPvt,
+                                            asynArrayBuffer *pBuffer)
 {
     ELLLIST *pclientList;
     interruptNode *pnode;
@@ -1854,11 +2931,11 @@ asynStatus asynPortDriver::doCallbacksArray(epicsType *value, size_t nElements,
     int addr;
 
     pasynManager->interruptStart(interruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
+    interruptClientIterator clients(interruptPvt, reason, address);
     getParamStatus(address, reason, &status);
     getParamAlarmStatus(address, reason, &alarmStatus);
     getParamAlarmSeverity(address, reason, &alarmSeverity);
-    while (pnode) {
+    while ((pnode = clients.next())) {
         interruptType *pInterrupt = (interruptType *)pnode->drvPvt;
         this->getAddress(pInterrupt->pasynUser, &addr);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -1871,11 +2948,12 @@ asynStatus asynPortDriver::doCallbacksArray(epicsType *value, size_t nElements,
             pInterrupt->pasynUser->alarmSeverity = alarmSeverity;
             /* Set the timestamp for the callback */
             pInterrupt->pasynUser->timestamp = timeStamp;
+            pInterrupt->pasynUser->arrayBuffer = pBuffer;
             pInterrupt->callback(pInterrupt->userPvt,
                                  pInterrupt->pasynUser,
                                  value, nElements);
+            pInterrupt->pasynUser->arrayBuffer = 0;
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(interruptPvt);
     return asynSuccess;
@@ -1910,6 +2988,9 @@ void reportInterrupt(FILE *fp, void *interruptPvt, const char *interruptTypeStri
 
 /** Returns the asyn address associated with a pasynUser structure.
   * Derived classes rarely need to reimplement this function.
+  * It is also called when a client registers for callbacks, and the callbacks for an address
+  * go to the clients for which it returned that address, so it must return the same address
+  * for a pasynUser as long as it is registered.
   * \param[in] pasynUser pasynUser structure that encodes the reason and address.
   * \param[out] address Returned address.
   * \return Returns asynError if the address is > maxAddr value passed to asynPortDriver::asynPortDriver. */
@@ -1962,6 +3043,7 @@ extern "C" {static asynStatus readInt32(void *drvPvt, asynUser *pasynUser,
     asynPortDriver *pPvt = (asynPortDriver *)drvPvt;
     asynStatus status;
 
+    if (pPvt->getLockFreeReads()) return pPvt->readParamLockFree(pasynUser, value);
     pPvt->lock();
     status = pPvt->readInt32(pasynUser, value);
     pPvt->unlock();
@@ -2089,6 +3171,7 @@ extern "C" {static asynStatus readInt64(void *drvPvt, asynUser *pasynUser,
     asynPortDriver *pPvt = (asynPortDriver *)drvPvt;
     asynStatus status;
 
+    if (pPvt->getLockFreeReads()) return pPvt->readParamLockFree(pasynUser, value);
     pPvt->lock();
     status = pPvt->readInt64(pasynUser, value);
     pPvt->unlock();
@@ -2121,11 +3204,11 @@ asynStatus asynPortDriver::readInt64(asynUser *pasynUser, epicsInt64 *value)
     if (status)
         epicsSnprintf(pasynUser->errorMessage, pasynUser->errorMessageSize,
                   "%s:%s: status=%d, function=%d, name=%s, value=%lld",
-                  driverName, functionName, status, function, paramName, *value);
+                  driverName, functionName, status, function, paramName, (long long)*value);
     else
         asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
               "%s:%s: function=%d, name=%s, value=%lld\n",
-              driverName, functionName, function, paramName, *value);
+              driverName, functionName, function, paramName, (long long)*value);
     return status;
 }
 
@@ -2168,11 +3251,11 @@ asynStatus asynPortDriver::writeInt64(asynUser *pasynUser, epicsInt64 value)
     if (status)
         epicsSnprintf(pasynUser->errorMessage, pasynUser->errorMessageSize,
                   "%s:%s: status=%d, function=%d, name=%s, value=%lld",
-                  driverName, functionName, status, function, paramName, value);
+                  driverName, functionName, status, function, paramName, (long long)value);
     else
         asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
               "%s:%s: function=%d, name=%s, value=%lld\n",
-              driverName, functionName, function, paramName, value);
+              driverName, functionName, function, paramName, (long long)value);
     return status;
 }
 
@@ -2205,7 +3288,7 @@ asynStatus asynPortDriver::getBounds64(asynUser *pasynUser,
     *high = 65535;
     asynPrint(pasynUser, ASYN_TRACEIO_DRIVER,
               "%s::getBounds64,low=%lld, high=%lld\n",
-              driverName, *low, *high);
+              driverName, (long long)*low, (long long)*high);
     return asynSuccess;
 }
 
@@ -2216,6 +3299,7 @@ extern "C" {static asynStatus readUInt32Digital(void *drvPvt, asynUser *pasynUse
     asynPortDriver *pPvt = (asynPortDriver *)drvPvt;
     asynStatus status;
 
+    if (pPvt->getLockFreeReads()) return pPvt->readParamLockFree(pasynUser, value, mask);
     pPvt->lock();
     status = pPvt->readUInt32Digital(pasynUser, value, mask);
     pPvt->unlock();
@@ -2440,6 +3524,7 @@ extern "C" {static asynStatus readFloat64(void *drvPvt, asynUser *pasynUser,
     asynPortDriver *pPvt = (asynPortDriver *)drvPvt;
     asynStatus status;
 
+    if (pPvt->getLockFreeReads()) return pPvt->readParamLockFree(pasynUser, value);
     pPvt->lock();
     status = pPvt->readFloat64(pasynUser, value);
     pPvt->unlock();
@@ -2670,7 +3755,7 @@ asynStatus asynPortDriver::flushOctet(asynUser *pasynUser)
         nbytesTransfered = 0;
         readOctet(pasynUser, buffer, sizeof(buffer), &nbytesTransfered, 0);
         if (nbytesTransfered==0) break;
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE,
+        asynPrintIORead(pasynUser, ASYN_TRACEIO_DEVICE,
             buffer, nbytesTransfered, "%s:%s\n", driverName, functionName);
     }
     pasynUser->timeout = savetimeout;
@@ -2847,7 +3932,7 @@ asynStatus asynPortDriver::doCallbacksInt8Array(epicsInt8 *value,
                                 size_t nElements, int reason, int addr)
 {
     return doCallbacksArray<epicsInt8, asynInt8ArrayInterrupt>(value, nElements, reason, addr,
-                                        this->asynStdInterfaces.int8ArrayInterruptPvt);
+                                        this->asynStdInterfaces.int8ArrayInterruptPvt, 0);
 }
 
 
@@ -2910,7 +3995,7 @@ asynStatus asynPortDriver::doCallbacksInt16Array(epicsInt16 *value,
                                 size_t nElements, int reason, int addr)
 {
     return doCallbacksArray<epicsInt16, asynInt16ArrayInterrupt>(value, nElements, reason, addr,
-                                        this->asynStdInterfaces.int16ArrayInterruptPvt);
+                                        this->asynStdInterfaces.int16ArrayInterruptPvt, 0);
 }
 
 
@@ -2973,7 +4058,7 @@ asynStatus asynPortDriver::doCallbacksInt32Array(epicsInt32 *value,
                                 size_t nElements, int reason, int addr)
 {
     return doCallbacksArray<epicsInt32, asynInt32ArrayInterrupt>(value, nElements, reason, addr,
-                                        this->asynStdInterfaces.int32ArrayInterruptPvt);
+                                        this->asynStdInterfaces.int32ArrayInterruptPvt, 0);
 }
 
 
@@ -3036,7 +4121,7 @@ asynStatus asynPortDriver::doCallbacksInt64Array(epicsInt64 *value,
                                 size_t nElements, int reason, int addr)
 {
     return doCallbacksArray<epicsInt64, asynInt64ArrayInterrupt>(value, nElements, reason, addr,
-                                        this->asynStdInterfaces.int64ArrayInterruptPvt);
+                                        this->asynStdInterfaces.int64ArrayInterruptPvt, 0);
 }
 
 
@@ -3099,7 +4184,7 @@ asynStatus asynPortDriver::doCallbacksFloat32Array(epicsFloat32 *value,
                                 size_t nElements, int reason, int addr)
 {
     return doCallbacksArray<epicsFloat32, asynFloat32ArrayInterrupt>(value, nElements, reason, addr,
-                                        this->asynStdInterfaces.float32ArrayInterruptPvt);
+                                        this->asynStdInterfaces.float32ArrayInterruptPvt, 0);
 }
 
 
@@ -3162,7 +4247,48 @@ asynStatus asynPortDriver::doCallbacksFloat64Array(epicsFloat64 *value,
                                 size_t nElements, int reason, int addr)
 {
     return doCallbacksArray<epicsFloat64, asynFloat64ArrayInterrupt>(value, nElements, reason, addr,
-                                        this->asynStdInterfaces.float64ArrayInterruptPvt);
+                                        this->asynStdInterfaces.float64ArrayInterruptPvt, 0);
+}
+
+/** Called by driver to do the callbacks to registered clients on the array interface of a parameter
+  * with data in a reference counted buffer.
+  * During the callbacks pasynUser->arrayBuffer is pBuffer, so clients can keep a reference instead of
+  * copying the data. The driver must not modify the data after this call.
+  * \param[in] pBuffer The buffer, which holds at least nElements of the type of the parameter.
+  * \param[in] nElements Number of elements in the array.
+  * \param[in] reason A client will be called if reason matches pasynUser->reason registered for that client.
+  * \param[in] addr A client will be called if addr matches the asyn address registered for that client. */
+asynStatus asynPortDriver::doCallbacksArrayBuffer(asynArrayBuffer *pBuffer,
+                                size_t nElements, int reason, int addr)
+{
+    asynParamType type;
+    void *value = asynArrayBufferData(pBuffer);
+    asynStatus status;
+
+    status = getParamType(addr, reason, &type);
+    if (status) return status;
+    switch (type) {
+        case asynParamInt8Array:
+            return doCallbacksArray<epicsInt8, asynInt8ArrayInterrupt>((epicsInt8 *)value, nElements,
+                reason, addr, this->asynStdInterfaces.int8ArrayInterruptPvt, pBuffer);
+        case asynParamInt16Array:
+            return doCallbacksArray<epicsInt16, asynInt16ArrayInterrupt>((epicsInt16 *)value, nElements,
+                reason, addr, this->asynStdInterfaces.int16ArrayInterruptPvt, pBuffer);
+        case asynParamInt32Array:
+            return doCallbacksArray<epicsInt32, asynInt32ArrayInterrupt>((epicsInt32 *)value, nElements,
+                reason, addr, this->asynStdInterfaces.int32ArrayInterruptPvt, pBuffer);
+        case asynParamInt64Array:
+            return doCallbacksArray<epicsInt64, asynInt64ArrayInterrupt>((epicsInt64 *)value, nElements,
+                reason, addr, this->asynStdInterfaces.int64ArrayInterruptPvt, pBuffer);
+        case asynParamFloat32Array:
+            return doCallbacksArray<epicsFloat32, asynFloat32ArrayInterrupt>((epicsFloat32 *)value, nElements,
+                reason, addr, this->asynStdInterfaces.float32ArrayInterruptPvt, pBuffer);
+        case asynParamFloat64Array:
+            return doCallbacksArray<epicsFloat64, asynFloat64ArrayInterrupt>((epicsFloat64 *)value, nElements,
+                reason, addr, this->asynStdInterfaces.float64ArrayInterruptPvt, pBuffer);
+        default:
+            return asynParamWrongType;
+    }
 }
 
 /* asynGenericPointer interface methods */
@@ -3231,8 +4357,8 @@ asynStatus asynPortDriver::doCallbacksGenericPointer(void *genericPointer, int r
     getParamAlarmStatus(address, reason, &alarmStatus);
     getParamAlarmSeverity(address, reason, &alarmSeverity);
     pasynManager->interruptStart(this->asynStdInterfaces.genericPointerInterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(this->asynStdInterfaces.genericPointerInterruptPvt, reason, address);
+    while ((pnode = clients.next())) {
         asynGenericPointerInterrupt *pInterrupt = (asynGenericPointerInterrupt *)pnode->drvPvt;
         this->getAddress(pInterrupt->pasynUser, &addr);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -3249,7 +4375,6 @@ asynStatus asynPortDriver::doCallbacksGenericPointer(void *genericPointer, int r
                                  pInterrupt->pasynUser,
                                  genericPointer);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(this->asynStdInterfaces.genericPointerInterruptPvt);
     return asynSuccess;
@@ -3377,8 +4502,8 @@ asynStatus asynPortDriver::doCallbacksEnum(char *strings[], int values[], int se
     int addr;
 
     pasynManager->interruptStart(this->asynStdInterfaces.enumInterruptPvt, &pclientList);
-    pnode = (interruptNode *)ellFirst(pclientList);
-    while (pnode) {
+    interruptClientIterator clients(this->asynStdInterfaces.enumInterruptPvt, reason, address);
+    while ((pnode = clients.next())) {
         asynEnumInterrupt *pInterrupt = (asynEnumInterrupt *)pnode->drvPvt;
         this->getAddress(pInterrupt->pasynUser, &addr);
         /* If this is not a multi-device then address is -1, change to 0 */
@@ -3389,7 +4514,6 @@ asynStatus asynPortDriver::doCallbacksEnum(char *strings[], int values[], int se
                                  pInterrupt->pasynUser,
                                  strings, values, severities, nElements);
         }
-        pnode = (interruptNode *)ellNext(&pnode->node);
     }
     pasynManager->interruptEnd(this->asynStdInterfaces.enumInterruptPvt);
     return asynSuccess;
@@ -3539,6 +4663,7 @@ void asynPortDriver::report(FILE *fp, int details)
             epicsStrPrintEscaped(fp, this->outputEosOctet, this->outputEosLenOctet);
             fprintf(fp, "\n");
         }
+        if (this->pDispatcher) this->pDispatcher->report(fp, details);
         this->reportParams(fp, details);
     }
     if (details >= 3) {
@@ -3564,7 +4689,12 @@ void asynPortDriver::report(FILE *fp, int details)
   * records with TSE=-2 to use this time as their timestamp. */
 asynStatus asynPortDriver::updateTimeStamp()
 {
-    return pasynManager->updateTimeStamp(pasynUserSelf);
+    asynStatus status;
+    int updating = beginTimeStampUpdate();
+
+    status = pasynManager->updateTimeStamp(pasynUserSelf);
+    endTimeStampUpdate(updating);
+    return status;
 }
 
 /** Updates the timestamp for this port in pasynManager, and returns this timestamp.
@@ -3574,7 +4704,9 @@ asynStatus asynPortDriver::updateTimeStamp()
 asynStatus asynPortDriver::updateTimeStamp(epicsTimeStamp *pTimeStamp)
 {
     asynStatus status;
+    int updating = beginTimeStampUpdate();
     status = pasynManager->updateTimeStamp(pasynUserSelf);
+    endTimeStampUpdate(updating);
     if (status == asynSuccess) status = pasynManager->getTimeStamp(pasynUserSelf, pTimeStamp);
     return status;
 }
@@ -3590,7 +4722,28 @@ asynStatus asynPortDriver::getTimeStamp(epicsTimeStamp *pTimeStamp)
   * \param[in] pTimeStamp A pointer to the epicsTimeStamp to set. */
 asynStatus asynPortDriver::setTimeStamp(const epicsTimeStamp *pTimeStamp)
 {
-    return pasynManager->setTimeStamp(pasynUserSelf, pTimeStamp);
+    asynStatus status;
+    int updating = beginTimeStampUpdate();
+
+    status = pasynManager->setTimeStamp(pasynUserSelf, pTimeStamp);
+    endTimeStampUpdate(updating);
+    return status;
+}
+
+/** Makes lock-free reads retry while the timestamp changes, so that they return a value
+  * and timestamp that were current at the same time; see setLockFreeReads.
+  * \return The value to pass to endTimeStampUpdate. */
+int asynPortDriver::beginTimeStampUpdate()
+{
+    if (!this->lockFreeReads) return 0;
+    for (int i=0; i<this->maxAddr; i++) this->params[i]->beginUpdate();
+    return 1;
+}
+
+void asynPortDriver::endTimeStampUpdate(int updating)
+{
+    if (!updating) return;
+    for (int i=this->maxAddr-1; i>=0; i--) this->params[i]->endUpdate();
 }
 
 extern "C" {static asynStatus connect(void *drvPvt, asynUser *pasynUser)
@@ -3822,6 +4975,7 @@ void asynPortDriver::initialize(const char *portNameIn, int maxAddrIn, int inter
 
     if (maxAddrIn < 1) maxAddrIn = 1;
     this->maxAddr = maxAddrIn;
+    this->paramNames = new paramNameTable;
     params.resize(maxAddr);
     for (addr=0; addr<maxAddr; addr++) {
         this->params[addr] = new paramList(this);
@@ -3840,6 +4994,11 @@ void asynPortDriver::initialize(const char *portNameIn, int maxAddrIn, int inter
         throw std::runtime_error(msg);
     }
 
+    batchCallbacks = 0;
+    pDispatcher = 0;
+    lockFreeReads = 0;
+    paramsFixed = 0;
+
     inputEosOctet = epicsStrDup("");
     inputEosLenOctet = 0;
     outputEosOctet = epicsStrDup("");
@@ -3920,6 +5079,9 @@ void asynPortDriver::initialize(const char *portNameIn, int maxAddrIn, int inter
         throw std::runtime_error(msg);
     }
 
+    /* Index interrupt clients with the address returned by getAddress */
+    pasynManager->registerInterruptAddrSource(this->pasynUserSelf, this, interruptAddrSource);
+
     /* Create a thread that waits for interruptAccept and then does all the callbacks once. */
     cbThread = new callbackThread(this);
 }
@@ -3941,11 +5103,13 @@ asynStatus asynPortDriver::createParams()
 asynPortDriver::~asynPortDriver()
 {
     delete cbThread;
+    delete pDispatcher;
     epicsMutexDestroy(this->mutexId);
 
     for (int addr=0; addr<this->maxAddr; addr++) {
         delete this->params[addr];
     }
+    delete this->paramNames;
 
     pasynManager->freeAsynUser(this->pasynUserSelf);
     free(this->inputEosOctet);
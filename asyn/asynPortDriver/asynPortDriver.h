@@ -9,11 +9,13 @@
 #include <epicsThread.h>
 
 #include <asynStandardInterfaces.h>
+#include <asynArrayBuffer.h>
 #include <asynParamSet.h>
 #include <asynParamType.h>
 #include <paramErrors.h>
 
 class paramList;
+class paramNameTable;
 
 ASYN_API void* findAsynPortDriver(const char *portName);
 typedef void (*userTimeStampFunction)(void *userPvt, epicsTimeStamp *pTimeStamp);
@@ -38,7 +40,30 @@ typedef void (*userTimeStampFunction)(void *userPvt, epicsTimeStamp *pTimeStamp)
 #define asynInt64Mask           0x00004000
 #define asynInt64ArrayMask      0x00008000
 
+/** Snapshot of one changed parameter, as passed to an asynParamBulkCallback */
+typedef struct asynParamChange {
+    int index;                  /**< Parameter number */
+    asynParamType type;         /**< Parameter data type */
+    asynStatus status;          /**< Parameter status */
+    int alarmStatus;            /**< Parameter alarm status */
+    int alarmSeverity;          /**< Parameter alarm severity */
+    epicsUInt32 interruptMask;  /**< Bits that changed, only for asynParamUInt32Digital */
+    union {
+        epicsInt32   ival;
+        epicsInt64   i64val;
+        epicsUInt32  uival;
+        epicsFloat64 dval;
+        const char   *sval;     /**< Only valid for the duration of the callback */
+    } value;
+} asynParamChange;
+
+/** Callback that receives all parameters of one parameter list that changed in one call to callParamCallbacks.
+  * It is called with the driver locked. */
+typedef void (*asynParamBulkCallback)(void *userPvt, int addr, const asynParamChange *changes,
+                                      size_t nChanges, const epicsTimeStamp *timeStamp);
+
 class callbackThread;
+class callbackDispatcher;
 
 /** Base class for asyn port drivers; handles most of the bookkeeping for writing an asyn port driver
   * with standard asyn interfaces and a parameter library. */
@@ -114,6 +139,8 @@ public:
                                         size_t nElements);
     virtual asynStatus doCallbacksFloat64Array(epicsFloat64 *value,
                                         size_t nElements, int reason, int addr);
+    asynStatus doCallbacksArrayBuffer(asynArrayBuffer *pBuffer,
+                                        size_t nElements, int reason, int addr);
     virtual asynStatus readGenericPointer(asynUser *pasynUser, void *pointer);
     virtual asynStatus writeGenericPointer(asynUser *pasynUser, void *pointer);
     virtual asynStatus doCallbacksGenericPointer(void *pointer, int reason, int addr);
@@ -172,6 +199,18 @@ public:
     virtual asynStatus getUInt32DigitalInterrupt(int list, int index, epicsUInt32 *mask, interruptReason reason);
     virtual asynStatus setDoubleParam(          int index, double value);
     virtual asynStatus setDoubleParam(int list, int index, double value);
+    virtual asynStatus setIntegerParams(          int first, const epicsInt32 *values, size_t nValues);
+    virtual asynStatus setIntegerParams(int list, int first, const epicsInt32 *values, size_t nValues);
+    virtual asynStatus setIntegerParams(          const int *indices, const epicsInt32 *values, size_t nValues);
+    virtual asynStatus setIntegerParams(int list, const int *indices, const epicsInt32 *values, size_t nValues);
+    virtual asynStatus setInteger64Params(          int first, const epicsInt64 *values, size_t nValues);
+    virtual asynStatus setInteger64Params(int list, int first, const epicsInt64 *values, size_t nValues);
+    virtual asynStatus setInteger64Params(          const int *indices, const epicsInt64 *values, size_t nValues);
+    virtual asynStatus setInteger64Params(int list, const int *indices, const epicsInt64 *values, size_t nValues);
+    virtual asynStatus setDoubleParams(          int first, const epicsFloat64 *values, size_t nValues);
+    virtual asynStatus setDoubleParams(int list, int first, const epicsFloat64 *values, size_t nValues);
+    virtual asynStatus setDoubleParams(          const int *indices, const epicsFloat64 *values, size_t nValues);
+    virtual asynStatus setDoubleParams(int list, const int *indices, const epicsFloat64 *values, size_t nValues);
     virtual asynStatus setStringParam(          int index, const char *value);
     virtual asynStatus setStringParam(int list, int index, const char *value);
     virtual asynStatus setStringParam(          int index, const std::string& value);
@@ -191,6 +230,16 @@ public:
     virtual asynStatus callParamCallbacks();
     virtual asynStatus callParamCallbacks(          int addr);
     virtual asynStatus callParamCallbacks(int list, int addr);
+    virtual asynStatus setBatchCallbacks(int enable);
+    virtual asynStatus setCallbackDispatcher(int numThreads, int queueDepth);
+    virtual asynStatus setLockFreeReads(int enable);
+    int getLockFreeReads();
+    asynStatus readParamLockFree(asynUser *pasynUser, epicsInt32 *value);
+    asynStatus readParamLockFree(asynUser *pasynUser, epicsInt64 *value);
+    asynStatus readParamLockFree(asynUser *pasynUser, epicsUInt32 *value, epicsUInt32 mask);
+    asynStatus readParamLockFree(asynUser *pasynUser, epicsFloat64 *value);
+    virtual asynStatus registerParamBulkCallback(asynParamBulkCallback callback, void *userPvt);
+    virtual asynStatus cancelParamBulkCallback(asynParamBulkCallback callback, void *userPvt);
     virtual asynStatus updateTimeStamp();
     virtual asynStatus updateTimeStamp(epicsTimeStamp *pTimeStamp);
     virtual asynStatus getTimeStamp(epicsTimeStamp *pTimeStamp);
@@ -212,6 +261,7 @@ protected:
 
 private:
     std::vector<paramList*> params;
+    paramNameTable *paramNames;
     paramList *getParamList(int list);
     epicsMutexId mutexId;
     char *inputEosOctet;
@@ -219,9 +269,28 @@ private:
     char *outputEosOctet;
     int outputEosLenOctet;
     callbackThread *cbThread;
+    int batchCallbacks;
+    struct paramBulkClient {
+        asynParamBulkCallback callback;
+        void *userPvt;
+    };
+    std::vector<paramBulkClient> bulkClients;
+    callbackDispatcher *pDispatcher;
+    int lockFreeReads;
+    int paramsFixed;  /* createParam is refused once lock-free reads have been enabled */
     template <typename epicsType, typename interruptType>
         asynStatus doCallbacksArray(epicsType *value, size_t nElements,
-                                    int reason, int address, void *interruptPvt);
+                                    int reason, int address, void *interruptPvt,
+                                    asynArrayBuffer *pBuffer);
+    template <typename epicsType>
+        asynStatus setParamValues(int list, const int *indices, int first,
+                                  const epicsType *values, size_t nValues,
+                                  const char *functionName);
+    template <typename epicsType>
+        asynStatus readScalarParam(asynUser *pasynUser, epicsType *value, const char *functionName,
+                                   int *function, const char **paramName);
+    int beginTimeStampUpdate();
+    void endTimeStampUpdate(int updating);
 
     friend class paramList;
     friend class callbackThread;
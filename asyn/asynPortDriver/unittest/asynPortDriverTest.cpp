@@ -5,6 +5,7 @@
  \*************************************************************************/
 
 #include <stdexcept>
+#include <vector>
 
 #include <string.h>
 
@@ -51,6 +52,17 @@ void int32cb(void *userPvt, asynUser *pasynUser,
     testDiag("int32cb() done");
 }
 
+size_t bulkcount;
+std::vector<asynParamChange> lastChanges;
+
+void bulkcb(void *userPvt, int addr, const asynParamChange *changes,
+            size_t nChanges, const epicsTimeStamp *timeStamp)
+{
+    testDiag("bulkcb() called with %u changes", (unsigned)nChanges);
+    bulkcount++;
+    lastChanges.assign(changes, changes+nChanges);
+}
+
 /* since asyn ports are forever, store them in a global
  * pointer so that valgrind will consider them reachable
  */
@@ -78,6 +90,8 @@ void testA()
 
     testOk1(portA->findParam(0, "int32", &idx2)==asynSuccess);
     testOk1(idx1==idx2);
+    testOk1(portA->findParam(0, "INT32", &idx2)==asynSuccess && idx1==idx2);
+    testOk1(portA->findParam(0, "Int32", &idx2)==asynSuccess && idx1==idx2);
     testOk1(portA->getParamName(0, 0, &name)==asynSuccess);
     testOk1(strcmp(name, "int32")==0);
     testOk1(portA->getParamAlarmSeverity(0, &sevr)==asynSuccess);
@@ -163,16 +177,277 @@ void testA()
         testOk1(lastint32==43);
         testOk1(cbcount==2);
     }
+
+    {
+        testDiag("Batched and bulk callbacks");
+        int idxInt32=-1, idxY=-1;
+        testOk1(portA->findParam(0, "int32", &idxInt32)==asynSuccess);
+        testOk1(portA->findParam(0, "y", &idxY)==asynSuccess);
+
+        asynInt32Client client("portA", -1, "y");
+        testOk1(client.registerInterruptUser(&int32cb)==asynSuccess);
+        testOk1(portA->setBatchCallbacks(1)==asynSuccess);
+        testOk1(portA->registerParamBulkCallback(&bulkcb, 0)==asynSuccess);
+
+        {
+            Guard G(*portA);
+            portA->setIntegerParam(0, idxInt32, 5);
+            portA->setIntegerParam(0, idxY, 77);
+            testOk1(portA->callParamCallbacks()==asynSuccess);
+        }
+
+        testOk1(lastint32==77);
+        testOk1(cbcount==3);
+        testOk1(bulkcount==1);
+        testOk1(lastChanges.size()==2);
+        testOk1(lastChanges.size()==2 && lastChanges[0].index==idxInt32 && lastChanges[0].value.ival==5);
+        testOk1(lastChanges.size()==2 && lastChanges[1].index==idxY && lastChanges[1].value.ival==77);
+
+        testOk1(portA->cancelParamBulkCallback(&bulkcb, 0)==asynSuccess);
+        testOk1(portA->cancelParamBulkCallback(&bulkcb, 0)==asynError);
+        testOk1(portA->setBatchCallbacks(0)==asynSuccess);
+    }
+
+    {
+        testDiag("Bulk setters");
+        int first=-1, idx=-1, idxFloat=-1;
+        const epicsInt32 ivals[3] = {1, 2, 3};
+        const epicsFloat64 dvals[2] = {1.5, 2.5};
+        testOk1(portA->createParam(0, "reg0", asynParamInt32, &first)==asynSuccess);
+        testOk1(portA->createParam(0, "reg1", asynParamInt32, &idx)==asynSuccess);
+        testOk1(portA->createParam(0, "reg2", asynParamInt32, &idx)==asynSuccess);
+        testOk1(portA->findParam(0, "z", &idxFloat)==asynSuccess);
+
+        Guard G(*portA);
+        testOk1(portA->setIntegerParams(0, first, ivals, 3)==asynSuccess);
+        testOk1(portA->getIntegerParam(0, first+2, &ival)==asynSuccess && ival==3);
+        testOk1(portA->setDoubleParams(0, first, dvals, 1)==asynParamWrongType);
+        testOk1(portA->setIntegerParams(0, first+1, ivals, 3)==asynParamBadIndex);
+        // the first parameter is valid, but nothing is set if any is not
+        int indices[2] = {first, idxFloat};
+        testOk1(portA->setIntegerParams(0, indices, ivals+2, 2)==asynParamWrongType);
+        testOk1(portA->getIntegerParam(0, first, &ival)==asynSuccess && ival==1);
+        indices[1] = first+1;
+        testOk1(portA->setIntegerParams(0, indices, ivals+1, 2)==asynSuccess);
+        testOk1(portA->getIntegerParam(0, first, &ival)==asynSuccess && ival==2);
+        testOk1(portA->getIntegerParam(0, first+1, &ival)==asynSuccess && ival==3);
+        testOk1(portA->callParamCallbacks()==asynSuccess);
+    }
+
+    {
+        testDiag("Callback dispatcher");
+        int idxY=-1;
+        testOk1(portA->findParam(0, "y", &idxY)==asynSuccess);
+
+        asynInt32Client client("portA", -1, "y");
+        testOk1(client.registerInterruptUser(&int32cb)==asynSuccess);
+        testOk1(portA->setCallbackDispatcher(1, 10)==asynSuccess);
+
+        {
+            Guard G(*portA);
+            portA->setIntegerParam(0, idxY, 88);
+            testOk1(portA->callParamCallbacks()==asynSuccess);
+        }
+        for (int i=0; i<500 && cbcount<4; i++)
+            epicsThreadSleep(0.01);
+
+        // stops the dispatcher thread, so the callback has completed
+        testOk1(portA->setCallbackDispatcher(0, 0)==asynSuccess);
+        testOk1(cbcount==4);
+        testOk1(lastint32==88);
+        testOk1(portA->setCallbackDispatcher(1, 0)==asynError);
+    }
+}
+
+asynPortDriver *portB;
+
+void testB()
+{
+    portB = new asynPortDriver("portB", 2,
+                               asynDrvUserMask|asynInt32Mask,
+                               asynInt32Mask, ASYN_MULTIDEVICE, 0, 0,
+                               epicsThreadGetStackSize(epicsThreadStackSmall));
+
+    int idx=-1, ival;
+
+    testDiag("Parameter lists with different layouts");
+
+    testOk1(portB->createParam("a", asynParamInt32, &idx)==asynSuccess);
+    testOk1(portB->createParam(1, "b", asynParamInt32, &idx)==asynSuccess && idx==1);
+    testOk1(portB->createParam(0, "c", asynParamFloat64, &idx)==asynSuccess && idx==1);
+    testOk1(portB->createParam(0, "b", asynParamInt32, &idx)==asynSuccess && idx==2);
+    testOk1(portB->findParam(0, "b", &idx)==asynSuccess && idx==2);
+    testOk1(portB->findParam(1, "b", &idx)==asynSuccess && idx==1);
+    testOk1(portB->findParam(1, "c", &idx)==asynParamNotFound);
+
+    testDiag("Names are matched without regard to case");
+    const char *name;
+    testOk1(portB->createParam(0, "MixedCase", asynParamInt32, &idx)==asynSuccess && idx==3);
+    testOk1(portB->findParam(0, "mixedcase", &idx)==asynSuccess && idx==3);
+    testOk1(portB->findParam(0, "MIXEDCASE", &idx)==asynSuccess && idx==3);
+    testOk1(portB->createParam(0, "mixedCASE", asynParamInt32, &idx)==asynError);
+    testOk1(portB->getParamName(0, 3, &name)==asynSuccess && strcmp(name, "MixedCase")==0);
+
+    Guard G(*portB);
+    testOk1(portB->setIntegerParam(0, 2, 10)==asynSuccess);
+    testOk1(portB->setIntegerParam(1, 1, 11)==asynSuccess);
+    testOk1(portB->getIntegerParam(0, 2, &ival)==asynSuccess && ival==10);
+    testOk1(portB->getIntegerParam(1, 1, &ival)==asynSuccess && ival==11);
+    testOk1(portB->getIntegerParam(0, 0, &ival)==asynParamUndefined);
+
+    testDiag("Changes are delivered once, in parameter order");
+    testOk1(portB->registerParamBulkCallback(&bulkcb, 0)==asynSuccess);
+    portB->setIntegerParam(0, 2, 12);
+    portB->setIntegerParam(0, 0, 1);
+    portB->setIntegerParam(0, 2, 13);
+    testOk1(portB->callParamCallbacks()==asynSuccess);
+    testOk1(lastChanges.size()==2);
+    testOk1(lastChanges.size()==2 && lastChanges[0].index==0 && lastChanges[0].value.ival==1);
+    testOk1(lastChanges.size()==2 && lastChanges[1].index==2 && lastChanges[1].value.ival==13);
+
+    testDiag("Reads without the driver lock");
+    testOk1(portB->setLockFreeReads(1)==asynSuccess);
+    testOk1(portB->getLockFreeReads()==1);
+    asynInt32Client clientA("portB", 0, "a");
+    asynInt32Client clientB("portB", 1, "a");
+    epicsInt32 val;
+    testOk1(clientA.read(&val)==asynSuccess && val==1);
+    testOk1(clientB.read(&val)==asynParamUndefined);
+    testOk1(portB->setIntegerParam(0, 0, 5)==asynSuccess);
+    testOk1(clientA.read(&val)==asynSuccess && val==5);
+    testOk1(portB->createParam("late", asynParamInt32, &idx)==asynError);
+
+    testDiag("Reads without the driver lock return the timestamp of the port");
+    asynUser *pasynUser = pasynManager->createAsynUser(0, 0);
+    testOk1(pasynManager->connectDevice(pasynUser, "portB", 0)==asynSuccess);
+    asynInterface *pinterface = pasynManager->findInterface(pasynUser, asynInt32Type, 1);
+    testOk1(pinterface!=NULL);
+    if (pinterface) {
+        asynInt32 *pasynInt32 = (asynInt32 *)pinterface->pinterface;
+        epicsTimeStamp stamp = {1234, 5678};
+        testOk1(portB->setTimeStamp(&stamp)==asynSuccess);
+        pasynUser->reason = 0;
+        testOk1(pasynInt32->read(pinterface->drvPvt, pasynUser, &val)==asynSuccess && val==5);
+        testOk1(pasynUser->timestamp.secPastEpoch==1234 && pasynUser->timestamp.nsec==5678);
+    } else {
+        testSkip(3, "no asynInt32 interface");
+    }
+    pasynManager->disconnect(pasynUser);
+    pasynManager->freeAsynUser(pasynUser);
+
+    testOk1(portB->setLockFreeReads(0)==asynSuccess);
+    testOk1(portB->createParam("late", asynParamInt32, &idx)==asynError);
+}
+
+/** Driver whose clients at address 0 use parameter list 1 and vice versa */
+class swappedPort : public asynPortDriver {
+public:
+    swappedPort(const char *portName)
+        : asynPortDriver(portName, 2, asynDrvUserMask|asynInt32Mask, asynInt32Mask,
+                         ASYN_MULTIDEVICE, 0, 0, epicsThreadGetStackSize(epicsThreadStackSmall))
+    {}
+    virtual asynStatus getAddress(asynUser *pasynUser, int *address)
+    {
+        asynStatus status = asynPortDriver::getAddress(pasynUser, address);
+        if (status == asynSuccess) *address = 1 - *address;
+        return status;
+    }
+};
+
+asynPortDriver *portC;
+
+void testC()
+{
+    portC = new swappedPort("portC");
+
+    int idx=-1;
+
+    testDiag("Callbacks use the address returned by a reimplemented getAddress");
+    testOk1(portC->createParam("x", asynParamInt32, &idx)==asynSuccess);
+
+    asynInt32Client client("portC", 0, "x");
+    testOk1(client.registerInterruptUser(&int32cb)==asynSuccess);
+    size_t before = cbcount;
+    {
+        Guard G(*portC);
+        portC->setIntegerParam(0, idx, 1);
+        portC->setIntegerParam(1, idx, 2);
+        testOk1(portC->callParamCallbacks(0)==asynSuccess);
+        testOk1(portC->callParamCallbacks(1)==asynSuccess);
+    }
+    testOk1(cbcount==before+1);
+    testOk1(lastint32==2);
+}
+
+asynArrayBuffer *lastArrayBuffer;
+epicsInt32 lastArrayValue;
+
+void int32ArrayCb(void *userPvt, asynUser *pasynUser,
+                  epicsInt32 *data, size_t nElements)
+{
+    testDiag("int32ArrayCb() called with %u elements", (unsigned)nElements);
+    cbcount++;
+    lastArrayBuffer = pasynUser->arrayBuffer;
+    if (lastArrayBuffer) asynArrayBufferReserve(lastArrayBuffer);
+    lastArrayValue = nElements ? data[nElements-1] : -1;
+}
+
+asynPortDriver *portD;
+
+void testD()
+{
+    portD = new asynPortDriver("portD", 0,
+                               asynDrvUserMask|asynInt32Mask|asynInt32ArrayMask,
+                               asynInt32ArrayMask, 0, 0, 0,
+                               epicsThreadGetStackSize(epicsThreadStackSmall));
+
+    int idx=-1, scalarIdx=-1;
+
+    testDiag("Array callbacks pass the asynArrayBuffer to the clients");
+    testOk1(portD->createParam("array", asynParamInt32Array, &idx)==asynSuccess);
+    testOk1(portD->createParam("scalar", asynParamInt32, &scalarIdx)==asynSuccess);
+
+    asynInt32ArrayClient client("portD", 0, "array");
+    testOk1(client.registerInterruptUser(&int32ArrayCb)==asynSuccess);
+
+    asynArrayBuffer *pBuffer = asynArrayBufferCreate(4*sizeof(epicsInt32));
+    epicsInt32 *pData = (epicsInt32 *)asynArrayBufferData(pBuffer);
+    for (int i=0; i<4; i++) pData[i] = 10 + i;
+    size_t before = cbcount;
+    {
+        Guard G(*portD);
+        testOk1(portD->doCallbacksArrayBuffer(pBuffer, 4, idx, 0)==asynSuccess);
+    }
+    testOk1(cbcount==before+1);
+    testOk1(lastArrayBuffer==pBuffer);
+    testOk1(lastArrayValue==13);
+    // The client's reference keeps the data after the driver releases it
+    asynArrayBufferRelease(pBuffer);
+    testOk1(((epicsInt32 *)asynArrayBufferData(lastArrayBuffer))[0]==10);
+    asynArrayBufferRelease(lastArrayBuffer);
+
+    epicsInt32 plain[2] = {1, 2};
+    {
+        Guard G(*portD);
+        testOk1(portD->doCallbacksInt32Array(plain, 2, idx, 0)==asynSuccess);
+        testOk1(lastArrayBuffer==0 && lastArrayValue==2);
+        pBuffer = asynArrayBufferCreate(sizeof(epicsInt32));
+        testOk1(portD->doCallbacksArrayBuffer(pBuffer, 1, scalarIdx, 0)==asynParamWrongType);
+        asynArrayBufferRelease(pBuffer);
+    }
 }
 
 } // namespace
 
 MAIN(asynPortDriverTest)
 {
-    testPlan(54);
+    testPlan(152);
     interruptAccept=1;
     try {
         testA();
+        testB();
+        testC();
+        testD();
     } catch(std::exception& e) {
         testAbort("Unhandled C++ exception: %s", e.what());
     }
@@ -1553,7 +1553,7 @@ static void performOctetIO(asynUser * pasynUser)
                                  pasynUser, outptr, nwrite, &nbytesTransfered);
         }
         pasynRec->nawt = (int)nbytesTransfered;
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE, outptr, nbytesTransfered,
+        asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DEVICE, outptr, nbytesTransfered,
            "%s: nwrite=%lu, status=%d, nawt=%lu\n", pasynRec->name, (unsigned long)nwrite,
                     status, (unsigned long)nbytesTransfered);
         if(status != asynSuccess || nbytesTransfered != nwrite) {
@@ -1592,7 +1592,7 @@ static void performOctetIO(asynUser * pasynUser)
             reportError(pasynRec, status,
                 "Error %s", pasynUser->errorMessage);
         } else {
-            asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE, inptr, nbytesTransfered,
+            asynPrintIORead(pasynUser, ASYN_TRACEIO_DEVICE, inptr, nbytesTransfered,
              "%s: inlen=%lu, status=%d, ninp=%lu\n", pasynRec->name, (unsigned long)inlen,
                     status, (unsigned long)nbytesTransfered);
         }
@@ -18,12 +18,25 @@
 
 #include <link.h>
 #include <alarm.h>
+#include <dbCommon.h>
+#include <dbScan.h>
+#include <ellLib.h>
 #include <epicsAssert.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsTimer.h>
 #include <epicsString.h>
 #include <cantProceed.h>
 
 #include "asynEpicsUtils.h"
 
+#if LT_EPICSBASE(3,15,0,1)
+#define RING_USE_MUTEX
+#else
+#include <epicsAtomic.h>
+#endif
+
 static asynStatus parseLink(asynUser *pasynUser, DBLINK *plink,
                    char **port, int *addr, char **userParam);
 static asynStatus parseLinkMask(asynUser *pasynUser, DBLINK *plink,
@@ -33,9 +46,22 @@ static asynStatus parseLinkFree(asynUser *pasynUser,
 static void asynStatusToEpicsAlarm(asynStatus status,
                                    epicsAlarmCondition defaultStat, epicsAlarmCondition *pStat,
                                    epicsAlarmSeverity defaultSevr, epicsAlarmSeverity *pSevr);
+static asynEpicsRing *ringCreate(struct dbCommon *precord, const char *owner,
+                                 int size, size_t elementSize);
+static void *ringPutStart(asynEpicsRing *pring);
+static int  ringPutDone(asynEpicsRing *pring);
+static int  ringGet(asynEpicsRing *pring, void *pelement, int *overflows);
+static int  ringSize(asynEpicsRing *pring);
+static void ringReport(FILE *fp, const char *owner, int details);
+static void ringSetFilter(asynEpicsRing *pring, double maxRate, double deadband,
+                          IOSCANPVT ioScanPvt);
+static int  ringFilter(asynEpicsRing *pring, double value, int status,
+                       int alarmStatus, int alarmSeverity, const void *pelement);
 
 static asynEpicsUtils utils = {
-    parseLink,parseLinkMask,parseLinkFree,asynStatusToEpicsAlarm
+    parseLink,parseLinkMask,parseLinkFree,asynStatusToEpicsAlarm,
+    ringCreate,ringPutStart,ringPutDone,ringGet,ringSize,ringReport,
+    ringSetFilter,ringFilter
 };
 
 asynEpicsUtils *pasynEpicsUtils = &utils;
@@ -264,3 +290,343 @@ static void asynStatusToEpicsAlarm(asynStatus status,
             break;
     }
 }
+
+/* The producers are serialized by putLock, only the consumer works without it.
+ * head and tail count the values put and removed. They are not reduced
+ * modulo the number of slots, so a consumer that was overtaken by the
+ * producer can not mistake a reused slot for the one it was copying.
+ * The number of slots is a power of 2 greater than size, so the slot
+ * the producer writes is never the oldest value in the ring.
+ * The consumer copies the oldest value and then advances tail with
+ * compare and swap. If the producer discarded that value meanwhile the
+ * compare and swap fails and the consumer tries again.
+ */
+struct asynEpicsRing {
+    ELLNODE       node;
+    dbCommon      *precord;
+    const char    *owner;
+    int           size;
+    int           coalesce;  /* only the latest value is kept */
+    unsigned      mask;
+    size_t        elementSize;
+    size_t        slotSize;
+    char          *slots;
+    int           head;      /* written by the producer */
+    int           tail;      /* advanced by the consumer and on overflow by the producer */
+    int           overflows; /* written by the producer, coalesced values if coalesce */
+    int           overflowsReported; /* used by the consumer */
+    int           dropped;   /* ringPutStart discarded the oldest value */
+    int           highWater;
+    unsigned long nPut;
+    /* Filter state, only used by the producer */
+    int           filter;
+    double        minInterval;
+    double        deadband;
+    int           haveLast;
+    double        lastValue;
+    int           lastStatus;
+    int           lastAlarmStatus;
+    int           lastAlarmSeverity;
+    epicsTimeStamp lastTime;
+    unsigned long nFiltered;
+    /* Latest value held back by MAX_RATE, put by the timer when the interval expires */
+    IOSCANPVT     ioScanPvt;
+    epicsTimerId  timer;
+    int           timerActive;
+    int           pending;
+    double        pendingValue;
+    int           pendingStatus;
+    int           pendingAlarmStatus;
+    int           pendingAlarmSeverity;
+    char          *pendingElement;
+    /* Serializes the producers. Without epicsAtomic it also locks out the consumer */
+    epicsMutexId  putLock;
+};
+
+#ifdef RING_USE_MUTEX
+#define RING_LOCK(pring)   epicsMutexMustLock((pring)->putLock)
+#define RING_UNLOCK(pring) epicsMutexUnlock((pring)->putLock)
+static int ringLoad(int *p) { return *p; }
+static void ringStore(int *p, int value) { *p = value; }
+static int ringCas(int *p, int oldValue, int newValue)
+{
+    int value = *p;
+    if (value == oldValue) *p = newValue;
+    return value;
+}
+#else
+#define RING_LOCK(pring)
+#define RING_UNLOCK(pring)
+/* Reads after ringLoad see the writes before the matching ringStore */
+static int ringLoad(int *p)
+{
+    int value = epicsAtomicGetIntT(p);
+    epicsAtomicReadMemoryBarrier();
+    return value;
+}
+static void ringStore(int *p, int value)
+{
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetIntT(p, value);
+}
+static int ringCas(int *p, int oldValue, int newValue)
+{
+    return epicsAtomicCmpAndSwapIntT(p, oldValue, newValue);
+}
+#endif
+
+#define RING_NEXT(n) ((int)((unsigned)(n) + 1))
+#define RING_USED(head, tail) ((unsigned)(head) - (unsigned)(tail))
+
+static ELLLIST ringList = ELLLIST_INIT;
+static epicsMutexId ringListLock;
+static epicsThreadOnceId ringListOnce = EPICS_THREAD_ONCE_INIT;
+
+static epicsTimerQueueId filterTimerQueue;
+static epicsThreadOnceId filterTimerOnce = EPICS_THREAD_ONCE_INIT;
+
+static void ringListInit(void *arg)
+{
+    ringListLock = epicsMutexMustCreate();
+}
+
+static void filterTimerInit(void *arg)
+{
+    filterTimerQueue = epicsTimerQueueAllocate(1, epicsThreadPriorityScanLow);
+}
+
+static asynEpicsRing *ringCreate(struct dbCommon *precord, const char *owner,
+                                 int size, size_t elementSize)
+{
+    asynEpicsRing *pring;
+    unsigned nSlots = 2;
+
+    pring = callocMustSucceed(1, sizeof(*pring), "asynEpicsUtils::ringCreate");
+    if (size < 1) {
+        pring->coalesce = 1;
+        size = 1;
+    }
+    while (nSlots <= (unsigned)size) nSlots <<= 1;
+    pring->slotSize = (elementSize + sizeof(double) - 1) & ~(sizeof(double) - 1);
+    pring->slots = callocMustSucceed(nSlots, pring->slotSize, "asynEpicsUtils::ringCreate");
+    pring->precord = precord;
+    pring->owner = owner;
+    pring->size = size;
+    pring->mask = nSlots - 1;
+    pring->elementSize = elementSize;
+    pring->putLock = epicsMutexMustCreate();
+    epicsThreadOnce(&ringListOnce, ringListInit, 0);
+    epicsMutexMustLock(ringListLock);
+    ellAdd(&ringList, &pring->node);
+    epicsMutexUnlock(ringListLock);
+    return pring;
+}
+
+static void *ringPutStart(asynEpicsRing *pring)
+{
+    int head, tail;
+
+    epicsMutexMustLock(pring->putLock);
+    head = pring->head;
+    pring->dropped = 0;
+    while (1) {
+        tail = ringLoad(&pring->tail);
+        if (RING_USED(head, tail) < (unsigned)pring->size) break;
+        /* Full, discard the oldest value unless the consumer just removed it */
+        if (ringCas(&pring->tail, tail, RING_NEXT(tail)) == tail) {
+            pring->dropped = 1;
+            ringStore(&pring->overflows, pring->overflows + 1);
+            break;
+        }
+    }
+    return pring->slots + ((unsigned)head & pring->mask)*pring->slotSize;
+}
+
+static int ringPutDone(asynEpicsRing *pring)
+{
+    int head = RING_NEXT(pring->head);
+    int used, added;
+
+    ringStore(&pring->head, head);
+    used = (int)RING_USED(head, ringLoad(&pring->tail));
+    if (used > pring->highWater) pring->highWater = used;
+    pring->nPut++;
+    added = !pring->dropped;
+    epicsMutexUnlock(pring->putLock);
+    return added;
+}
+
+static int ringGet(asynEpicsRing *pring, void *pelement, int *overflows)
+{
+    int head, tail;
+
+    RING_LOCK(pring);
+    while (1) {
+        tail = ringLoad(&pring->tail);
+        head = ringLoad(&pring->head);
+        if (tail == head) {
+            RING_UNLOCK(pring);
+            return 0;
+        }
+        memcpy(pelement, pring->slots + ((unsigned)tail & pring->mask)*pring->slotSize,
+               pring->elementSize);
+        if (ringCas(&pring->tail, tail, RING_NEXT(tail)) == tail) break;
+    }
+    if (overflows && pring->coalesce) {
+        *overflows = 0;
+    } else if (overflows) {
+        int total = ringLoad(&pring->overflows);
+        *overflows = total - pring->overflowsReported;
+        pring->overflowsReported = total;
+    }
+    RING_UNLOCK(pring);
+    return 1;
+}
+
+static int ringSize(asynEpicsRing *pring)
+{
+    return pring->size;
+}
+
+static void ringFilterExpire(void *arg);
+
+static void ringSetFilter(asynEpicsRing *pring, double maxRate, double deadband,
+                          IOSCANPVT ioScanPvt)
+{
+    pring->minInterval = (maxRate > 0.0) ? 1.0/maxRate : 0.0;
+    pring->deadband = (deadband > 0.0) ? deadband : 0.0;
+    pring->ioScanPvt = ioScanPvt;
+    if (pring->minInterval > 0.0 && !pring->timer) {
+        epicsThreadOnce(&filterTimerOnce, filterTimerInit, 0);
+        pring->pendingElement = callocMustSucceed(1, pring->elementSize,
+                                                  "asynEpicsUtils::ringSetFilter");
+        pring->timer = epicsTimerQueueCreateTimer(filterTimerQueue, ringFilterExpire, pring);
+    }
+    pring->filter = (pring->minInterval > 0.0) || (pring->deadband > 0.0);
+}
+
+/* The ringFilterXXX functions must be called with putLock held */
+static void ringFilterPass(asynEpicsRing *pring, double value, int status,
+                           int alarmStatus, int alarmSeverity, const epicsTimeStamp *pnow)
+{
+    pring->haveLast = 1;
+    pring->lastValue = value;
+    pring->lastStatus = status;
+    pring->lastAlarmStatus = alarmStatus;
+    pring->lastAlarmSeverity = alarmSeverity;
+    pring->lastTime = *pnow;
+}
+
+static void ringFilterDiscardPending(asynEpicsRing *pring)
+{
+    if (!pring->pending) return;
+    pring->pending = 0;
+    pring->nFiltered++;
+}
+
+static int ringFilter(asynEpicsRing *pring, double value, int status,
+                      int alarmStatus, int alarmSeverity, const void *pelement)
+{
+    epicsTimeStamp now;
+    int pass = 1;
+
+    if (!pring->filter) return 1;
+    epicsTimeGetCurrent(&now);
+    epicsMutexMustLock(pring->putLock);
+    /* The first value and changes of status or alarm are always passed */
+    if (pring->haveLast &&
+        status == pring->lastStatus &&
+        alarmStatus == pring->lastAlarmStatus &&
+        alarmSeverity == pring->lastAlarmSeverity) {
+        double delta = value - pring->lastValue;
+        double elapsed = epicsTimeDiffInSeconds(&now, &pring->lastTime);
+        if (delta < 0.0) delta = -delta;
+        if (pring->deadband > 0.0 && delta <= pring->deadband) {
+            /* The record is already within the deadband of the latest value */
+            ringFilterDiscardPending(pring);
+            pring->nFiltered++;
+            pass = 0;
+        } else if (pring->minInterval > 0.0 && elapsed < pring->minInterval) {
+            /* Hold the latest value back until the interval expires */
+            ringFilterDiscardPending(pring);
+            pring->pending = 1;
+            pring->pendingValue = value;
+            pring->pendingStatus = status;
+            pring->pendingAlarmStatus = alarmStatus;
+            pring->pendingAlarmSeverity = alarmSeverity;
+            memcpy(pring->pendingElement, pelement, pring->elementSize);
+            if (!pring->timerActive) {
+                double delay = pring->minInterval - elapsed;
+                if (delay > pring->minInterval) delay = pring->minInterval;
+                pring->timerActive = 1;
+                epicsTimerStartDelay(pring->timer, delay);
+            }
+            pass = 0;
+        }
+    }
+    if (pass) {
+        ringFilterDiscardPending(pring);
+        ringFilterPass(pring, value, status, alarmStatus, alarmSeverity, &now);
+    }
+    epicsMutexUnlock(pring->putLock);
+    return pass;
+}
+
+static void ringFilterExpire(void *arg)
+{
+    asynEpicsRing *pring = (asynEpicsRing *)arg;
+    epicsTimeStamp now;
+    int added = 0;
+
+    epicsTimeGetCurrent(&now);
+    epicsMutexMustLock(pring->putLock);
+    pring->timerActive = 0;
+    if (pring->pending) {
+        pring->pending = 0;
+        memcpy(ringPutStart(pring), pring->pendingElement, pring->elementSize);
+        added = ringPutDone(pring);
+        ringFilterPass(pring, pring->pendingValue, pring->pendingStatus,
+                       pring->pendingAlarmStatus, pring->pendingAlarmSeverity, &now);
+    }
+    epicsMutexUnlock(pring->putLock);
+    if (added) scanIoRequest(pring->ioScanPvt);
+}
+
+static void ringReport(FILE *fp, const char *owner, int details)
+{
+    asynEpicsRing *pring;
+    int nRings = 0;
+    unsigned long nPut = 0, nOverflows = 0, nCoalesced = 0, nFiltered = 0;
+
+    epicsThreadOnce(&ringListOnce, ringListInit, 0);
+    epicsMutexMustLock(ringListLock);
+    for (pring = (asynEpicsRing *)ellFirst(&ringList); pring;
+         pring = (asynEpicsRing *)ellNext(&pring->node)) {
+        int used;
+
+        if (strcmp(pring->owner, owner) != 0) continue;
+        nRings++;
+        nPut += pring->nPut;
+        if (pring->coalesce) nCoalesced += (unsigned)pring->overflows;
+        else nOverflows += (unsigned)pring->overflows;
+        nFiltered += pring->nFiltered;
+        if (details < 1) continue;
+        used = (int)RING_USED(pring->head, pring->tail);
+        if (pring->coalesce) {
+            fprintf(fp, "    %s COALESCE used %d values %lu coalesced %d\n",
+                    pring->precord->name, used, pring->nPut, pring->overflows);
+        } else {
+            fprintf(fp, "    %s FIFO size %d used %d highWater %d values %lu overflows %d\n",
+                    pring->precord->name, pring->size, used, pring->highWater,
+                    pring->nPut, pring->overflows);
+        }
+        if (pring->filter) {
+            fprintf(fp, "        MAX_RATE %g DEADBAND %g filtered %lu\n",
+                    (pring->minInterval > 0.0) ? 1.0/pring->minInterval : 0.0,
+                    pring->deadband, pring->nFiltered);
+        }
+    }
+    epicsMutexUnlock(ringListLock);
+    fprintf(fp, "    %d records with FIFO, %lu values, %lu overflows, %lu coalesced, %lu filtered\n",
+            nRings, nPut, nOverflows, nCoalesced, nFiltered);
+}
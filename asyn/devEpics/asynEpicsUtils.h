@@ -12,15 +12,33 @@
 #ifndef asynEpicsUtilsH
 #define asynEpicsUtilsH
 
+#include <stdio.h>
 #include <link.h>
 #include <epicsTypes.h>
 #include <alarm.h>
+#include <dbScan.h>
 #include "asynDriver.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
 
+struct dbCommon;
+
+/* Ring buffer (FIFO) for the values that device support receives in interrupt
+ * callbacks. Interrupt callbacks for one record may come from several threads,
+ * so the producers are serialized by a mutex of the ring: ringPutStart takes
+ * it and ringPutDone, which must always follow, releases it. Nothing else may
+ * be locked between the two calls. ringFilter and the timer of maxRate take
+ * the same mutex. There must be only one consumer (record processing), and
+ * only ringGet does not take the mutex, if epicsAtomic is available.
+ * When the ring is full ringPutStart discards the oldest value, so the record
+ * always receives the most recent value.
+ * The device supports take their own devPvtLock as well in the callbacks of
+ * output records and of the averaging ai device supports.
+ */
+typedef struct asynEpicsRing asynEpicsRing;
+
 typedef struct asynEpicsUtils {
     asynStatus (*parseLink)(asynUser *pasynUser, DBLINK *plink,
                 char **port, int *addr, char **userParam);
@@ -31,6 +49,35 @@ typedef struct asynEpicsUtils {
     void       (*asynStatusToEpicsAlarm)(asynStatus status,
                 epicsAlarmCondition defaultStat, epicsAlarmCondition *pStat,
                 epicsAlarmSeverity defaultSevr, epicsAlarmSeverity *pSevr);
+    /* owner identifies the device support for ringReport. If size is 0 the
+     * ring only keeps the latest value, and the values it replaces are
+     * counted as coalesced rather than reported as overflows */
+    asynEpicsRing *(*ringCreate)(struct dbCommon *precord, const char *owner,
+                int size, size_t elementSize);
+    /* Returns the element to fill in. ringPutDone returns 1 if a value was
+     * added, 0 if it replaced the oldest value, i.e. the record does not need
+     * to be processed again */
+    void       *(*ringPutStart)(asynEpicsRing *pring);
+    int         (*ringPutDone)(asynEpicsRing *pring);
+    /* Returns 0 if the ring is empty. If overflows is not null it is set to the
+     * number of values discarded since the previous call */
+    int         (*ringGet)(asynEpicsRing *pring, void *pelement, int *overflows);
+    int         (*ringSize)(asynEpicsRing *pring);
+    /* Report the statistics of all the rings created by owner */
+    void        (*ringReport)(FILE *fp, const char *owner, int details);
+    /* Limit the values passed by ringFilter to maxRate per second, and to
+     * values that differ by more than deadband from the last value passed.
+     * 0 disables each limit. ioScanPvt is scanned when a value that was held
+     * back by maxRate is put in the ring */
+    void        (*ringSetFilter)(asynEpicsRing *pring, double maxRate, double deadband,
+                IOSCANPVT ioScanPvt);
+    /* Called by the producer before ringPutStart with the element it will put.
+     * Returns 0 if the value should not be put now. The first value and changes
+     * of status, alarm status or alarm severity are always passed. The latest
+     * value held back by maxRate is put when the interval expires, unless a
+     * later value replaces it */
+    int         (*ringFilter)(asynEpicsRing *pring, double value, int status,
+                int alarmStatus, int alarmSeverity, const void *pelement);
 } asynEpicsUtils;
 ASYN_API extern asynEpicsUtils *pasynEpicsUtils;
 
@@ -28,6 +28,7 @@
 #include <epicsMutex.h>
 #include <epicsThread.h>
 #include <epicsMath.h>
+#include <epicsString.h>
 #include <cantProceed.h>
 #include <dbCommon.h>
 #include <dbScan.h>
@@ -42,6 +43,8 @@
 #include "asynFloat64SyncIO.h"
 #include "asynEpicsUtils.h"
 #include "asynFloat64.h"
+#include "asynFloat64Array.h"
+#include "asynInt32Array.h"
 #include "devEpicsPvt.h"
 
 #define INIT_OK 0
@@ -60,6 +63,23 @@ typedef struct ringBufferElement {
     epicsAlarmSeverity  alarmSeverity;
 } ringBufferElement;
 
+/* Statistics of the array elements received since the last value.
+ * m2 is the sum of the squared differences from mean */
+typedef struct arrayStatistics {
+    double            n;
+    double            mean;
+    double            m2;
+    double            min;
+    double            max;
+} arrayStatistics;
+
+typedef enum {
+    statisticMean, statisticMin, statisticMax, statisticRMS, statisticStdDev
+} arrayStatistic;
+
+static const char *statisticNames[] = {"MEAN", "MIN", "MAX", "RMS", "STDDEV"};
+#define NUM_STATISTICS (sizeof(statisticNames)/sizeof(statisticNames[0]))
+
 typedef struct devPvt{
     dbCommon          *pr;
     asynUser          *pasynUser;
@@ -69,17 +89,19 @@ typedef struct devPvt{
     void              *registrarPvt;
     int               canBlock;
     epicsMutexId      devPvtLock;
-    ringBufferElement *ringBuffer;
-    int               ringHead;
-    int               ringTail;
-    int               ringSize;
-    int               ringBufferOverflows;
+    asynEpicsRing     *ringBuffer;
     ringBufferElement result;
     asynStatus        lastStatus;
     epicsFloat64      sum;
     interruptCallbackFloat64 interruptCallback;
     int               numAverage;
     int               isAiAverage;
+    int               isArrayAverage;
+    arrayStatistic    statistic;
+    arrayStatistics   stats;
+    asynFloat64Array  *pfloat64Array;
+    asynInt32Array    *pint32Array;
+    void              *arrayPvt;
     int               isIOIntrScan;
     int               asyncProcessingActive;
     CALLBACK          processCallback;
@@ -93,10 +115,13 @@ typedef struct devPvt{
     asynStatus        previousQueueRequestStatus;
 }devPvt;
 
+static long initDevice(dbCommon *pr, DBLINK *plink, userCallback processCallback);
 static long initCommon(dbCommon *pr, DBLINK *plink,
     userCallback processCallback,interruptCallbackFloat64 interruptCallback);
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt);
+static long getIoIntInfoArrayAverage(int cmd, dbCommon *pr, IOSCANPVT *iopvt);
 static long createRingBuffer(dbCommon *pr);
+static long report(int level);
 static void processCallbackInput(asynUser *pasynUser);
 static void processCallbackOutput(asynUser *pasynUser);
 static void outputCallbackCallback(CALLBACK *pcb);
@@ -107,10 +132,16 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
                 epicsFloat64 value);
 static void interruptCallbackAverage(void *drvPvt, asynUser *pasynUser,
                 epicsFloat64 value);
+static void interruptCallbackFloat64ArrayAverage(void *drvPvt, asynUser *pasynUser,
+                epicsFloat64 *value, size_t nelements);
+static void interruptCallbackInt32ArrayAverage(void *drvPvt, asynUser *pasynUser,
+                epicsInt32 *value, size_t nelements);
 
 static long initAi(aiRecord *pai);
 static long initAo(aoRecord *pai);
 static long initAiAverage(aiRecord *pai);
+static long initAiFloat64ArrayAverage(aiRecord *pai);
+static long initAiInt32ArrayAverage(aiRecord *pai);
 static long processAi(aiRecord *pai);
 static long processAo(aoRecord *pai);
 static long processAiAverage(aiRecord *pai);
@@ -126,26 +157,32 @@ typedef struct analogDset { /* analog  dset */
 } analogDset;
 
 analogDset asynAiFloat64 = {
-    6, 0, 0, initAi,        getIoIntInfo, processAi, 0};
+    6, report, 0, initAi,        getIoIntInfo, processAi, 0};
 analogDset asynAoFloat64 = {
     6, 0, 0, initAo,        getIoIntInfo, processAo, 0};
 analogDset asynAiFloat64Average = {
     6, 0, 0, initAiAverage, getIoIntInfo, processAiAverage, 0};
+analogDset asynAiFloat64ArrayAverage = {
+    6, 0, 0, initAiFloat64ArrayAverage, getIoIntInfoArrayAverage, processAiAverage, 0};
+analogDset asynAiInt32ArrayAverage = {
+    6, 0, 0, initAiInt32ArrayAverage, getIoIntInfoArrayAverage, processAiAverage, 0};
 
 epicsExportAddress(dset, asynAiFloat64);
 epicsExportAddress(dset, asynAoFloat64);
 epicsExportAddress(dset, asynAiFloat64Average);
+epicsExportAddress(dset, asynAiFloat64ArrayAverage);
+epicsExportAddress(dset, asynAiInt32ArrayAverage);
 
-static long initCommon(dbCommon *pr, DBLINK *plink,
-    userCallback processCallback,interruptCallbackFloat64 interruptCallback)
+/* Create the devPvt, connect to the device and call drvUserCreate */
+static long initDevice(dbCommon *pr, DBLINK *plink, userCallback processCallback)
 {
     devPvt *pPvt;
     asynStatus status;
     asynUser *pasynUser;
     asynInterface *pasynInterface;
-    static const char *functionName="initCommon";
+    static const char *functionName="initDevice";
 
-    pPvt = callocMustSucceed(1, sizeof(*pPvt), "devAsynFloat64::initCommon");
+    pPvt = callocMustSucceed(1, sizeof(*pPvt), "devAsynFloat64::initDevice");
     pr->dpvt = pPvt;
     pPvt->pr = pr;
     /* Create asynUser */
@@ -189,6 +226,25 @@ static long initCommon(dbCommon *pr, DBLINK *plink,
             goto bad;
         }
     }
+    return INIT_OK;
+bad:
+    recGblSetSevr(pr,LINK_ALARM,INVALID_ALARM);
+    pr->pact=1;
+    return INIT_ERROR;
+}
+
+static long initCommon(dbCommon *pr, DBLINK *plink,
+    userCallback processCallback,interruptCallbackFloat64 interruptCallback)
+{
+    devPvt *pPvt;
+    asynStatus status;
+    asynUser *pasynUser;
+    asynInterface *pasynInterface;
+    static const char *functionName="initCommon";
+
+    if (initDevice(pr, plink, processCallback) != INIT_OK) return INIT_ERROR;
+    pPvt = (devPvt *)pr->dpvt;
+    pasynUser = pPvt->pasynUser;
     /* Get interface asynFloat64 */
     pasynInterface = pasynManager->findInterface(pasynUser, asynFloat64Type, 1);
     if (!pasynInterface) {
@@ -246,14 +302,35 @@ static long createRingBuffer(dbCommon *pr)
     const char *sizeString;
 
     if (!pPvt->ringBuffer) {
-        pPvt->ringSize = DEFAULT_RING_BUFFER_SIZE;
+        int ringSize = DEFAULT_RING_BUFFER_SIZE;
+        double maxRate = 0.0, deadband = 0.0;
         sizeString = asynDbGetInfo(pr, "asyn:FIFO");
-        if (sizeString) pPvt->ringSize = atoi(sizeString);
-        pPvt->ringBuffer = callocMustSucceed(pPvt->ringSize+1, sizeof *pPvt->ringBuffer, "devAsynFloat64::createRingBuffer");
+        if (sizeString) ringSize = atoi(sizeString);
+        if (ringSize < 1) ringSize = 1;
+        /* With asyn:COALESCE only the latest value is kept and the record is
+         * only scanned again once it has processed the previous value */
+        sizeString = asynDbGetInfo(pr, "asyn:COALESCE");
+        if (sizeString && atoi(sizeString)) ringSize = 0;
+        pPvt->ringBuffer = pasynEpicsUtils->ringCreate(pr, driverName, ringSize,
+                                                       sizeof(ringBufferElement));
+        sizeString = asynDbGetInfo(pr, "asyn:MAX_RATE");
+        if (sizeString) maxRate = atof(sizeString);
+        sizeString = asynDbGetInfo(pr, "asyn:DEADBAND");
+        if (sizeString) deadband = atof(sizeString);
+        pasynEpicsUtils->ringSetFilter(pPvt->ringBuffer, maxRate, deadband,
+                                       pPvt->ioScanPvt);
     }
     return asynSuccess;
 }
 
+/* The FIFO statistics of all records that use this device support are
+ * reported by the first dset */
+static long report(int level)
+{
+    pasynEpicsUtils->ringReport(stdout, driverName, level);
+    return 0;
+}
+
 
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
 {
@@ -302,6 +379,24 @@ static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
     return 0;
 }
 
+static long getIoIntInfoArrayAverage(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
+{
+    devPvt *pPvt = (devPvt *)pr->dpvt;
+
+    /* If initArrayAverage failed then pPvt->arrayPvt is NULL, return error */
+    if (!pPvt->arrayPvt) return -1;
+
+    /* The array callbacks are always enabled in any scan mode */
+    if (cmd == 0) {
+        createRingBuffer(pr);
+        pPvt->isIOIntrScan = 1;
+    } else {
+        pPvt->isIOIntrScan = 0;
+    }
+    *iopvt = pPvt->ioScanPvt;
+    return 0;
+}
+
 static void processCallbackInput(asynUser *pasynUser)
 {
     devPvt *pPvt = (devPvt *)pasynUser->userPvt;
@@ -356,6 +451,7 @@ static void interruptCallbackInput(void *drvPvt, asynUser *pasynUser,
 {
     devPvt *pPvt = (devPvt *)drvPvt;
     dbCommon *pr = pPvt->pr;
+    ringBufferElement element;
     ringBufferElement *rp;
     static const char *functionName="interruptCallbackInput";
 
@@ -375,27 +471,22 @@ static void interruptCallbackInput(void *drvPvt, asynUser *pasynUser,
      * Instead we just return.  There will then be nothing in the ring buffer, so the first
      * read will do a read from the driver, which should be OK. */
     if (!interruptAccept) return;
-    epicsMutexLock(pPvt->devPvtLock);
-    rp = &pPvt->ringBuffer[pPvt->ringHead];
-    rp->value = value;
-    rp->time = pasynUser->timestamp;
-    rp->status = pasynUser->auxStatus;
-    rp->alarmStatus = pasynUser->alarmStatus;
-    rp->alarmSeverity = pasynUser->alarmSeverity;
-    pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-    if (pPvt->ringHead == pPvt->ringTail) {
-        /* There was no room in the ring buffer.  In the past we just threw away
-         * the new value.  However, it is better to remove the oldest value from the
-         * ring buffer and add the new one.  That way the final value the record receives
-         * is guaranteed to be the most recent value */
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        pPvt->ringBufferOverflows++;
-    } else {
+    element.value = value;
+    element.time = pasynUser->timestamp;
+    element.status = pasynUser->auxStatus;
+    element.alarmStatus = pasynUser->alarmStatus;
+    element.alarmSeverity = pasynUser->alarmSeverity;
+    /* asyn:MAX_RATE and asyn:DEADBAND drop values before the record is scanned */
+    if (!pasynEpicsUtils->ringFilter(pPvt->ringBuffer, (double)value, element.status,
+                                     element.alarmStatus, element.alarmSeverity,
+                                     &element)) return;
+    rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
+    *rp = element;
+    if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
         /* We only need to request the record to process if we added a new
          * element to the ring buffer, not if we just replaced an element. */
         scanIoRequest(pPvt->ioScanPvt);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
@@ -410,18 +501,14 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
         "%s %s::%s new value=%f\n",
         pr->name, driverName, functionName,value);
     if (!interruptAccept) return;
-    epicsMutexLock(pPvt->devPvtLock);
-    rp = &pPvt->ringBuffer[pPvt->ringHead];
+    rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
     rp->value = value;
     rp->time = pasynUser->timestamp;
     rp->status = pasynUser->auxStatus;
     rp->alarmStatus = pasynUser->alarmStatus;
     rp->alarmSeverity = pasynUser->alarmSeverity;
-    pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-    if (pPvt->ringHead == pPvt->ringTail) {
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        pPvt->ringBufferOverflows++;
-    } else {
+    if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
+        epicsMutexLock(pPvt->devPvtLock);
         /* If this callback was received during asynchronous record processing
          * we must defer calling callbackRequest until end of record processing */
         if (pPvt->asyncProcessingActive) {
@@ -429,8 +516,8 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
         } else {
             callbackRequest(&pPvt->outputCallback);
         }
+        epicsMutexUnlock(pPvt->devPvtLock);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void outputCallbackCallback(CALLBACK *pcb)
@@ -488,7 +575,7 @@ static void interruptCallbackAverage(void *drvPvt, asynUser *pasynUser,
         numToAverage = (int)(pai->sval + 0.5);
         if (numToAverage < 1) numToAverage = 1;
         if (pPvt->numAverage >= numToAverage) {
-            rp = &pPvt->ringBuffer[pPvt->ringHead];
+            rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
             rp->value = pPvt->sum/pPvt->numAverage;
             pPvt->numAverage = 0;
             pPvt->sum = 0.;
@@ -496,16 +583,7 @@ static void interruptCallbackAverage(void *drvPvt, asynUser *pasynUser,
             rp->status = pasynUser->auxStatus;
             rp->alarmStatus = pasynUser->alarmStatus;
             rp->alarmSeverity = pasynUser->alarmSeverity;
-            pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-            if (pPvt->ringHead == pPvt->ringTail) {
-                /* There was no room in the ring buffer.  In the past we just threw away
-                 * the new value.  However, it is better to remove the oldest value from the
-                 * ring buffer and add the new one.  That way the final value the record receives
-                 * is guaranteed to be the most recent value */
-                pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-                pPvt->ringBufferOverflows++;
-            } /* End ring buffer full */
-            else {
+            if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
                 /* We only need to request the record to process if we added a new
                  * element to the ring buffer, not if we just replaced an element. */
                 scanIoRequest(pPvt->ioScanPvt);
@@ -520,28 +598,171 @@ static void interruptCallbackAverage(void *drvPvt, asynUser *pasynUser,
     epicsMutexUnlock(pPvt->devPvtLock);
 }
 
-static int getCallbackValue(devPvt *pPvt)
+static void resetStatistics(arrayStatistics *ps)
 {
-    int ret = 0;
-    static const char *functionName="getCallbackValue";
+    ps->n = 0.;
+    ps->mean = 0.;
+    ps->m2 = 0.;
+    ps->min = 0.;
+    ps->max = 0.;
+}
 
-    epicsMutexLock(pPvt->devPvtLock);
-    if (pPvt->ringTail != pPvt->ringHead) {
-        if (pPvt->ringBufferOverflows > 0) {
-            asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
-                "%s %s::%s warning, %d ring buffer overflows\n",
-                                    pPvt->pr->name, driverName, functionName,pPvt->ringBufferOverflows);
-            pPvt->ringBufferOverflows = 0;
+/* Reduce an array into ps. Each pass uses 4 independent accumulators so that
+ * the compiler can vectorize the loops. The m2 of the array is computed about
+ * its own mean and then combined with ps (Chan et al.) to avoid the loss of
+ * precision of sum(x*x) - n*mean*mean */
+#define REDUCE_ARRAY(FUNCNAME, EPICS_TYPE)                                      \
+static void FUNCNAME(const EPICS_TYPE *pdata, size_t nelements,                 \
+                     arrayStatistics *ps)                                       \
+{                                                                               \
+    double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;                                  \
+    double min0, min1, min2, min3, max0, max1, max2, max3;                      \
+    double n = (double)nelements, mean, m2, delta;                              \
+    size_t i, n4 = nelements & ~(size_t)3;                                      \
+                                                                                \
+    min0 = min1 = min2 = min3 = max0 = max1 = max2 = max3 = (double)pdata[0];   \
+    for (i = 0; i < n4; i += 4) {                                               \
+        double x0 = (double)pdata[i],   x1 = (double)pdata[i+1];                \
+        double x2 = (double)pdata[i+2], x3 = (double)pdata[i+3];                \
+        s0 += x0; s1 += x1; s2 += x2; s3 += x3;                                 \
+        min0 = (x0 < min0) ? x0 : min0; max0 = (x0 > max0) ? x0 : max0;         \
+        min1 = (x1 < min1) ? x1 : min1; max1 = (x1 > max1) ? x1 : max1;         \
+        min2 = (x2 < min2) ? x2 : min2; max2 = (x2 > max2) ? x2 : max2;         \
+        min3 = (x3 < min3) ? x3 : min3; max3 = (x3 > max3) ? x3 : max3;         \
+    }                                                                           \
+    for (; i < nelements; i++) {                                                \
+        double x = (double)pdata[i];                                            \
+        s0 += x;                                                                \
+        min0 = (x < min0) ? x : min0; max0 = (x > max0) ? x : max0;             \
+    }                                                                           \
+    mean = (s0 + s1 + s2 + s3)/n;                                               \
+    min0 = (min1 < min0) ? min1 : min0; min2 = (min3 < min2) ? min3 : min2;     \
+    min0 = (min2 < min0) ? min2 : min0;                                         \
+    max0 = (max1 > max0) ? max1 : max0; max2 = (max3 > max2) ? max3 : max2;     \
+    max0 = (max2 > max0) ? max2 : max0;                                         \
+    s0 = s1 = s2 = s3 = 0.;                                                     \
+    for (i = 0; i < n4; i += 4) {                                               \
+        double d0 = (double)pdata[i]   - mean, d1 = (double)pdata[i+1] - mean;  \
+        double d2 = (double)pdata[i+2] - mean, d3 = (double)pdata[i+3] - mean;  \
+        s0 += d0*d0; s1 += d1*d1; s2 += d2*d2; s3 += d3*d3;                     \
+    }                                                                           \
+    for (; i < nelements; i++) {                                                \
+        double d = (double)pdata[i] - mean;                                     \
+        s0 += d*d;                                                              \
+    }                                                                           \
+    m2 = s0 + s1 + s2 + s3;                                                     \
+    if (ps->n == 0.) {                                                          \
+        ps->n = n;                                                              \
+        ps->mean = mean;                                                        \
+        ps->m2 = m2;                                                            \
+        ps->min = min0;                                                         \
+        ps->max = max0;                                                         \
+        return;                                                                 \
+    }                                                                           \
+    delta = mean - ps->mean;                                                    \
+    ps->m2 += m2 + delta*delta*ps->n*n/(ps->n + n);                             \
+    ps->mean += delta*n/(ps->n + n);                                            \
+    ps->n += n;                                                                 \
+    if (min0 < ps->min) ps->min = min0;                                         \
+    if (max0 > ps->max) ps->max = max0;                                         \
+}
+
+REDUCE_ARRAY(reduceFloat64Array, epicsFloat64)
+REDUCE_ARRAY(reduceInt32Array, epicsInt32)
+
+static double statisticValue(devPvt *pPvt)
+{
+    arrayStatistics *ps = &pPvt->stats;
+
+    switch (pPvt->statistic) {
+        case statisticMin:    return ps->min;
+        case statisticMax:    return ps->max;
+        case statisticRMS:    return sqrt(ps->m2/ps->n + ps->mean*ps->mean);
+        case statisticStdDev: return sqrt(ps->m2/ps->n);
+        default:              return ps->mean;
+    }
+}
+
+/* Called with devPvtLock held after the array has been added to pPvt->stats */
+static void arrayAverageDone(devPvt *pPvt, asynUser *pasynUser)
+{
+    aiRecord *pai = (aiRecord *)pPvt->pr;
+    ringBufferElement *rp;
+    int numToAverage;
+
+    pPvt->numAverage++;
+    /* As for asynFloat64Average SVAL is the number of callbacks to combine when SCAN=I/O Intr */
+    if (pPvt->isIOIntrScan) {
+        numToAverage = (int)(pai->sval + 0.5);
+        if (numToAverage < 1) numToAverage = 1;
+        if (pPvt->numAverage >= numToAverage) {
+            rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
+            rp->value = statisticValue(pPvt);
+            pPvt->numAverage = 0;
+            resetStatistics(&pPvt->stats);
+            rp->time = pasynUser->timestamp;
+            rp->status = pasynUser->auxStatus;
+            rp->alarmStatus = pasynUser->alarmStatus;
+            rp->alarmSeverity = pasynUser->alarmSeverity;
+            if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
+                scanIoRequest(pPvt->ioScanPvt);
+            }
         }
-        pPvt->result = pPvt->ringBuffer[pPvt->ringTail];
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
-            "%s %s::%s from ringBuffer value=%f\n",
-                                            pPvt->pr->name, driverName, functionName, pPvt->result.value);
-        ret = 1;
+    } else {
+        pPvt->result.status |= pasynUser->auxStatus;
+        pPvt->result.alarmStatus = pasynUser->alarmStatus;
+        pPvt->result.alarmSeverity = pasynUser->alarmSeverity;
     }
+}
+
+static void interruptCallbackFloat64ArrayAverage(void *drvPvt, asynUser *pasynUser,
+                epicsFloat64 *value, size_t nelements)
+{
+    devPvt *pPvt = (devPvt *)drvPvt;
+    static const char *functionName="interruptCallbackFloat64ArrayAverage";
+
+    asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+        "%s %s::%s new array nelements=%lu\n",
+        pPvt->pr->name, driverName, functionName, (unsigned long)nelements);
+    if (!interruptAccept || nelements == 0) return;
+    epicsMutexLock(pPvt->devPvtLock);
+    reduceFloat64Array(value, nelements, &pPvt->stats);
+    arrayAverageDone(pPvt, pasynUser);
     epicsMutexUnlock(pPvt->devPvtLock);
-    return ret;
+}
+
+static void interruptCallbackInt32ArrayAverage(void *drvPvt, asynUser *pasynUser,
+                epicsInt32 *value, size_t nelements)
+{
+    devPvt *pPvt = (devPvt *)drvPvt;
+    static const char *functionName="interruptCallbackInt32ArrayAverage";
+
+    asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+        "%s %s::%s new array nelements=%lu\n",
+        pPvt->pr->name, driverName, functionName, (unsigned long)nelements);
+    if (!interruptAccept || nelements == 0) return;
+    epicsMutexLock(pPvt->devPvtLock);
+    reduceInt32Array(value, nelements, &pPvt->stats);
+    arrayAverageDone(pPvt, pasynUser);
+    epicsMutexUnlock(pPvt->devPvtLock);
+}
+
+static int getCallbackValue(devPvt *pPvt)
+{
+    int overflows;
+    static const char *functionName="getCallbackValue";
+
+    if (!pPvt->ringBuffer ||
+        !pasynEpicsUtils->ringGet(pPvt->ringBuffer, &pPvt->result, &overflows)) return 0;
+    if (overflows > 0) {
+        asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
+            "%s %s::%s warning, %d ring buffer overflows\n",
+            pPvt->pr->name, driverName, functionName, overflows);
+    }
+    asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+        "%s %s::%s from ringBuffer value=%f\n",
+        pPvt->pr->name, driverName, functionName, pPvt->result.value);
+    return 1;
 }
 
 static void reportQueueRequestStatus(devPvt *pPvt, asynStatus status)
@@ -705,6 +926,90 @@ static long initAiAverage(aiRecord *pai)
     return INIT_OK;
 }
 
+/* Common part of initAiFloat64ArrayAverage and initAiInt32ArrayAverage.
+ * The info tag asyn:STATISTIC selects the value computed from the array elements */
+static long initArrayAverage(aiRecord *pai, const char *interfaceType,
+                             asynInterface **ppasynInterface)
+{
+    devPvt *pPvt;
+    asynInterface *pasynInterface;
+    const char *statistic;
+    static const char *functionName="initArrayAverage";
+
+    if (initDevice((dbCommon *)pai, &pai->inp, 0) != INIT_OK) return INIT_ERROR;
+    pPvt = pai->dpvt;
+    pasynInterface = pasynManager->findInterface(pPvt->pasynUser, interfaceType, 1);
+    if (!pasynInterface) {
+        printf("%s %s::%s findInterface %s %s\n",
+               pai->name, driverName, functionName, interfaceType,
+               pPvt->pasynUser->errorMessage);
+        recGblSetSevr(pai, LINK_ALARM, INVALID_ALARM);
+        pai->pact = 1;
+        return INIT_ERROR;
+    }
+    statistic = asynDbGetInfo((dbCommon *)pai, "asyn:STATISTIC");
+    if (statistic) {
+        size_t i;
+        for (i = 0; i < NUM_STATISTICS; i++) {
+            if (epicsStrCaseCmp(statistic, statisticNames[i]) == 0) break;
+        }
+        if (i < NUM_STATISTICS) {
+            pPvt->statistic = (arrayStatistic)i;
+        } else {
+            printf("%s %s::%s unknown asyn:STATISTIC %s, using MEAN\n",
+                   pai->name, driverName, functionName, statistic);
+        }
+    }
+    pPvt->arrayPvt = pasynInterface->drvPvt;
+    pPvt->isAiAverage = 1;
+    pPvt->isArrayAverage = 1;
+    scanIoInit(&pPvt->ioScanPvt);
+    *ppasynInterface = pasynInterface;
+    return INIT_OK;
+}
+
+static long initAiFloat64ArrayAverage(aiRecord *pai)
+{
+    devPvt *pPvt;
+    asynInterface *pasynInterface;
+    asynStatus status;
+    static const char *functionName="initAiFloat64ArrayAverage";
+
+    if (initArrayAverage(pai, asynFloat64ArrayType, &pasynInterface) != INIT_OK)
+        return INIT_ERROR;
+    pPvt = pai->dpvt;
+    pPvt->pfloat64Array = pasynInterface->pinterface;
+    status = pPvt->pfloat64Array->registerInterruptUser(
+                 pPvt->arrayPvt, pPvt->pasynUser,
+                 interruptCallbackFloat64ArrayAverage, pPvt, &pPvt->registrarPvt);
+    if (status != asynSuccess) {
+        printf("%s %s::%s registerInterruptUser %s\n",
+               pai->name, driverName, functionName, pPvt->pasynUser->errorMessage);
+    }
+    return INIT_OK;
+}
+
+static long initAiInt32ArrayAverage(aiRecord *pai)
+{
+    devPvt *pPvt;
+    asynInterface *pasynInterface;
+    asynStatus status;
+    static const char *functionName="initAiInt32ArrayAverage";
+
+    if (initArrayAverage(pai, asynInt32ArrayType, &pasynInterface) != INIT_OK)
+        return INIT_ERROR;
+    pPvt = pai->dpvt;
+    pPvt->pint32Array = pasynInterface->pinterface;
+    status = pPvt->pint32Array->registerInterruptUser(
+                 pPvt->arrayPvt, pPvt->pasynUser,
+                 interruptCallbackInt32ArrayAverage, pPvt, &pPvt->registrarPvt);
+    if (status != asynSuccess) {
+        printf("%s %s::%s registerInterruptUser %s\n",
+               pai->name, driverName, functionName, pPvt->pasynUser->errorMessage);
+    }
+    return INIT_OK;
+}
+
 static long processAiAverage(aiRecord *pai)
 {
     devPvt *pPvt = (devPvt *)pai->dpvt;
@@ -724,7 +1029,12 @@ static long processAiAverage(aiRecord *pai)
             epicsMutexUnlock(pPvt->devPvtLock);
             return -2;
         }
-        dval = pPvt->sum/pPvt->numAverage;
+        if (pPvt->isArrayAverage) {
+            dval = statisticValue(pPvt);
+            resetStatistics(&pPvt->stats);
+        } else {
+            dval = pPvt->sum/pPvt->numAverage;
+        }
         pPvt->numAverage = 0;
         pPvt->sum = 0.;
     }
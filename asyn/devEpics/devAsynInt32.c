@@ -87,11 +87,7 @@ typedef struct devPvt{
     epicsInt32        deviceLow;
     epicsInt32        deviceHigh;
     epicsMutexId      devPvtLock;
-    ringBufferElement *ringBuffer;
-    int               ringHead;
-    int               ringTail;
-    int               ringSize;
-    int               ringBufferOverflows;
+    asynEpicsRing     *ringBuffer;
     ringBufferElement result;
     asynStatus        lastStatus;
     interruptCallbackInt32 interruptCallback;
@@ -122,6 +118,7 @@ static void setEnums(char *outStrings, int *outVals, epicsEnum16 *outSeverities,
                      size_t numIn, size_t numOut);
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt);
 static long createRingBuffer(dbCommon *pr);
+static long report(int level);
 static long convertAi(aiRecord *pai, int pass);
 static long convertAo(aoRecord *pao, int pass);
 static void processCallbackInput(asynUser *pasynUser);
@@ -165,7 +162,7 @@ typedef struct analogDset { /* analog  dset */
 } analogDset;
 
 analogDset asynAiInt32 = {
-    6,0,0,initAi,       getIoIntInfo, processAi, convertAi };
+    6,report,0,initAi,       getIoIntInfo, processAi, convertAi };
 analogDset asynAiInt32Average = {
     6,0,0,initAiAverage,getIoIntInfo, processAiAverage , convertAi };
 analogDset asynAoInt32 = {
@@ -357,14 +354,35 @@ static long createRingBuffer(dbCommon *pr)
     const char *sizeString;
  
     if (!pPvt->ringBuffer) {
-        pPvt->ringSize = DEFAULT_RING_BUFFER_SIZE;
+        int ringSize = DEFAULT_RING_BUFFER_SIZE;
+        double maxRate = 0.0, deadband = 0.0;
         sizeString = asynDbGetInfo(pr, "asyn:FIFO");
-        if (sizeString) pPvt->ringSize = atoi(sizeString);
-        pPvt->ringBuffer = callocMustSucceed(pPvt->ringSize+1, sizeof *pPvt->ringBuffer, "devAsynInt32::createRingBuffer");
+        if (sizeString) ringSize = atoi(sizeString);
+        if (ringSize < 1) ringSize = 1;
+        /* With asyn:COALESCE only the latest value is kept and the record is
+         * only scanned again once it has processed the previous value */
+        sizeString = asynDbGetInfo(pr, "asyn:COALESCE");
+        if (sizeString && atoi(sizeString)) ringSize = 0;
+        pPvt->ringBuffer = pasynEpicsUtils->ringCreate(pr, driverName, ringSize,
+                                                       sizeof(ringBufferElement));
+        sizeString = asynDbGetInfo(pr, "asyn:MAX_RATE");
+        if (sizeString) maxRate = atof(sizeString);
+        sizeString = asynDbGetInfo(pr, "asyn:DEADBAND");
+        if (sizeString) deadband = atof(sizeString);
+        pasynEpicsUtils->ringSetFilter(pPvt->ringBuffer, maxRate, deadband,
+                                       pPvt->ioScanPvt);
     }
     return asynSuccess;
 }
 
+/* The FIFO statistics of all records that use this device support are
+ * reported by the first dset */
+static long report(int level)
+{
+    pasynEpicsUtils->ringReport(stdout, driverName, level);
+    return 0;
+}
+
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
 {
     devPvt *pPvt = (devPvt *)pr->dpvt;
@@ -531,6 +549,7 @@ static void interruptCallbackInput(void *drvPvt, asynUser *pasynUser,
 {
     devPvt *pPvt = (devPvt *)drvPvt;
     dbCommon *pr = pPvt->pr;
+    ringBufferElement element;
     ringBufferElement *rp;
     static const char *functionName="interruptCallbackInput";
 
@@ -554,27 +573,22 @@ static void interruptCallbackInput(void *drvPvt, asynUser *pasynUser,
      * Instead we just return.  There will then be nothing in the ring buffer, so the first
      * read will do a read from the driver, which should be OK. */
     if (!interruptAccept) return;
-    epicsMutexLock(pPvt->devPvtLock);
-    rp = &pPvt->ringBuffer[pPvt->ringHead];
-    rp->value = value;
-    rp->time = pasynUser->timestamp;
-    rp->status = pasynUser->auxStatus;
-    rp->alarmStatus = pasynUser->alarmStatus;
-    rp->alarmSeverity = pasynUser->alarmSeverity;
-    pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-    if (pPvt->ringHead == pPvt->ringTail) {
-        /* There was no room in the ring buffer.  In the past we just threw away
-         * the new value.  However, it is better to remove the oldest value from the
-         * ring buffer and add the new one.  That way the final value the record receives
-         * is guaranteed to be the most recent value */
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        pPvt->ringBufferOverflows++;
-    } else {
+    element.value = value;
+    element.time = pasynUser->timestamp;
+    element.status = pasynUser->auxStatus;
+    element.alarmStatus = pasynUser->alarmStatus;
+    element.alarmSeverity = pasynUser->alarmSeverity;
+    /* asyn:MAX_RATE and asyn:DEADBAND drop values before the record is scanned */
+    if (!pasynEpicsUtils->ringFilter(pPvt->ringBuffer, (double)value, element.status,
+                                     element.alarmStatus, element.alarmSeverity,
+                                     &element)) return;
+    rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
+    *rp = element;
+    if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
         /* We only need to request the record to process if we added a new
          * element to the ring buffer, not if we just replaced an element. */
         scanIoRequest(pPvt->ioScanPvt);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
@@ -593,18 +607,14 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
         "%s %s::%s new value=%d\n",
         pr->name, driverName, functionName, value);
     if (!interruptAccept) return;
-    epicsMutexLock(pPvt->devPvtLock);
-    rp = &pPvt->ringBuffer[pPvt->ringHead];
+    rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
     rp->value = value;
     rp->time = pasynUser->timestamp;
     rp->status = pasynUser->auxStatus;
     rp->alarmStatus = pasynUser->alarmStatus;
     rp->alarmSeverity = pasynUser->alarmSeverity;
-    pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-    if (pPvt->ringHead == pPvt->ringTail) {
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        pPvt->ringBufferOverflows++;
-    } else {
+    if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
+        epicsMutexLock(pPvt->devPvtLock);
         /* If this callback was received during asynchronous record processing
          * we must defer calling callbackRequest until end of record processing */
         if (pPvt->asyncProcessingActive) {
@@ -612,8 +622,8 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
         } else {
             callbackRequest(&pPvt->outputCallback);
         }
+        epicsMutexUnlock(pPvt->devPvtLock);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void outputCallbackCallback(CALLBACK *pcb)
@@ -675,7 +685,7 @@ static void interruptCallbackAverage(void *drvPvt, asynUser *pasynUser,
         if (numToAverage < 1) numToAverage = 1;
         if (pPvt->numAverage >= numToAverage) {
             double dval;
-            rp = &pPvt->ringBuffer[pPvt->ringHead];
+            rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
             dval = pPvt->sum/pPvt->numAverage;
             dval += (pPvt->sum>0.0) ? 0.5 : -0.5;
             rp->value = (epicsInt32)dval;
@@ -685,16 +695,7 @@ static void interruptCallbackAverage(void *drvPvt, asynUser *pasynUser,
             rp->status = pasynUser->auxStatus;
             rp->alarmStatus = pasynUser->alarmStatus;
             rp->alarmSeverity = pasynUser->alarmSeverity;
-            pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-            if (pPvt->ringHead == pPvt->ringTail) {
-                /* There was no room in the ring buffer.  In the past we just threw away
-                 * the new value.  However, it is better to remove the oldest value from the
-                 * ring buffer and add the new one.  That way the final value the record receives
-                 * is guaranteed to be the most recent value */
-                pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-                pPvt->ringBufferOverflows++;
-            } /* End ring buffer full */
-            else {
+            if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
                 /* We only need to request the record to process if we added a new
                  * element to the ring buffer, not if we just replaced an element. */
                 scanIoRequest(pPvt->ioScanPvt);
@@ -767,26 +768,20 @@ static void interruptCallbackEnumBo(void *drvPvt, asynUser *pasynUser,
 
 static int getCallbackValue(devPvt *pPvt)
 {
-    int ret = 0;
+    int overflows;
     static const char *functionName="getCallbackValue";
 
-    epicsMutexLock(pPvt->devPvtLock);
-    if (pPvt->ringTail != pPvt->ringHead) {
-        if (pPvt->ringBufferOverflows > 0) {
-            asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
-                "%s %s::%s warning, %d ring buffer overflows\n",
-                pPvt->pr->name, driverName, functionName, pPvt->ringBufferOverflows);
-            pPvt->ringBufferOverflows = 0;
-        }
-        pPvt->result = pPvt->ringBuffer[pPvt->ringTail];
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
-            "%s %s::%s from ringBuffer value=%d\n",
-            pPvt->pr->name, driverName, functionName,pPvt->result.value);
-        ret = 1;
+    if (!pPvt->ringBuffer ||
+        !pasynEpicsUtils->ringGet(pPvt->ringBuffer, &pPvt->result, &overflows)) return 0;
+    if (overflows > 0) {
+        asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
+            "%s %s::%s warning, %d ring buffer overflows\n",
+            pPvt->pr->name, driverName, functionName, overflows);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
-    return ret;
+    asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+        "%s %s::%s from ringBuffer value=%d\n",
+        pPvt->pr->name, driverName, functionName, pPvt->result.value);
+    return 1;
 }
 
 static void reportQueueRequestStatus(devPvt *pPvt, asynStatus status)
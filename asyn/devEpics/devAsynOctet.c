@@ -102,11 +102,9 @@ typedef struct devPvt {
     size_t              bufLen;
     /* Following are for ring buffer support */
     epicsMutexId        devPvtLock;
-    ringBufferElement   *ringBuffer;
-    int                 ringHead;
-    int                 ringTail;
+    asynEpicsRing       *ringBuffer;
     int                 ringSize;
-    int                 ringBufferOverflows;
+    ringBufferElement   *ringResult; /* followed by valSize chars */
     ringBufferElement   result;
     asynStatus          lastStatus;
     char                *pValue;
@@ -131,6 +129,7 @@ static long initCommon(dbCommon *precord, DBLINK *plink, userCallback callback,
                 int isOutput, int isWaveform, int useDrvUser, char *pValue,
                 epicsUInt32* pLen, size_t valSize);
 static long createRingBuffer(dbCommon *pr, int minRingSize);
+static long report(int level);
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt);
 static void outputCallbackCallback(CALLBACK *pcb);
 static void interruptCallback(void *drvPvt, asynUser *pasynUser,
@@ -194,7 +193,7 @@ typedef struct commonDset {
 } commonDset;
 
 commonDset asynSiOctetCmdResponse = {
-    5, 0, 0, initSiCmdResponse, 0,            processCommon};
+    5, report, 0, initSiCmdResponse, 0,            processCommon};
 commonDset asynSiOctetWriteRead   = {
     5, 0, 0, initSiWriteRead,   0,            processCommon};
 commonDset asynSiOctetRead        = {
@@ -396,7 +395,6 @@ bad:
 static long createRingBuffer(dbCommon *pr, int minRingSize)
 {
     devPvt *pPvt = (devPvt *)pr->dpvt;
-    int i;
     const char *sizeString;
 
     if (!pPvt->ringBuffer) {
@@ -404,18 +402,25 @@ static long createRingBuffer(dbCommon *pr, int minRingSize)
         sizeString = asynDbGetInfo(pr, "asyn:FIFO");
         if (sizeString) pPvt->ringSize = atoi(sizeString);
         if (pPvt->ringSize > 0) {
-            pPvt->ringBuffer = callocMustSucceed(pPvt->ringSize+1, sizeof *pPvt->ringBuffer,
-                                                "devAsynOctet::createRingBuffer");
-            /* Allocate array for each ring buffer element */
-            for (i=0; i<pPvt->ringSize+1; i++) {
-                pPvt->ringBuffer[i].pValue = callocMustSucceed(pPvt->valSize, 1,
-                        "devAsynOctet::createRingBuffer creating ring element array");
-            }
+            /* The string is stored in the ring after each element */
+            size_t elementSize = sizeof(ringBufferElement) + pPvt->valSize;
+            pPvt->ringBuffer = pasynEpicsUtils->ringCreate(pr, driverName, pPvt->ringSize,
+                                                           elementSize);
+            pPvt->ringResult = callocMustSucceed(1, elementSize,
+                                                 "devAsynOctet::createRingBuffer");
         }
     }
     return asynSuccess;
 }
 
+/* The FIFO statistics of all records that use this device support are
+ * reported by the first dset */
+static long report(int level)
+{
+    pasynEpicsUtils->ringReport(stdout, driverName, level);
+    return 0;
+}
+
 
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
 {
@@ -456,23 +461,18 @@ static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
 
 static int getRingBufferValue(devPvt *pPvt)
 {
-    int ret = 0;
+    int overflows;
     static const char *functionName="getRingBufferValue";
 
-    epicsMutexLock(pPvt->devPvtLock);
-    if (pPvt->ringTail != pPvt->ringHead) {
-        if (pPvt->ringBufferOverflows > 0) {
-            asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
-                "%s %s::%s warning, %d ring buffer overflows\n",
-                pPvt->precord->name, driverName, functionName, pPvt->ringBufferOverflows);
-            pPvt->ringBufferOverflows = 0;
-        }
-        pPvt->result = pPvt->ringBuffer[pPvt->ringTail];
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        ret = 1;
+    if (!pasynEpicsUtils->ringGet(pPvt->ringBuffer, pPvt->ringResult, &overflows)) return 0;
+    if (overflows > 0) {
+        asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
+            "%s %s::%s warning, %d ring buffer overflows\n",
+            pPvt->precord->name, driverName, functionName, overflows);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
-    return ret;
+    pPvt->result = *pPvt->ringResult;
+    pPvt->result.pValue = (char *)(pPvt->ringResult + 1);
+    return 1;
 }
 
 static void interruptCallback(void *drvPvt, asynUser *pasynUser,
@@ -482,14 +482,14 @@ static void interruptCallback(void *drvPvt, asynUser *pasynUser,
     dbCommon *pr = pPvt->precord;
     static const char *functionName="interruptCallback";
 
-    epicsMutexLock(pPvt->devPvtLock);
-    asynPrintIO(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+    asynPrintIORead(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
         (char *)value, len*sizeof(char),
         "%s %s::%s ringSize=%d, len=%d, callback data:",
         pr->name, driverName, functionName, pPvt->ringSize, (int)len);
     if (len >= pPvt->valSize) len = pPvt->valSize-1;
     if (pPvt->ringSize == 0) {
         /* Not using a ring buffer */
+        epicsMutexLock(pPvt->devPvtLock);
         if (pasynUser->auxStatus == asynSuccess) {
             /* Note: calling dbScanLock here may to lead to deadlocks when asyn:READBACK is set for output records
              * and the driver is non-blocking.
@@ -520,36 +520,30 @@ static void interruptCallback(void *drvPvt, asynUser *pasynUser,
         } else {
             scanIoRequest(pPvt->ioScanPvt);
         }
+        epicsMutexUnlock(pPvt->devPvtLock);
     } else {
         /* Using a ring buffer */
         ringBufferElement *rp;
+        char *pValue;
 
         /* If interruptAccept is false we just return.  This prevents more ring pushes than pops.
          * There will then be nothing in the ring buffer, so the first
          * read will do a read from the driver, which should be OK. */
-        if (!interruptAccept) {
-            epicsMutexUnlock(pPvt->devPvtLock);
-            return;
-        }
-        rp = &pPvt->ringBuffer[pPvt->ringHead];
+        if (!interruptAccept) return;
+        rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
+        pValue = (char *)(rp + 1);
         rp->len = len;
-        memcpy(rp->pValue, value, len);
-        rp->pValue[len] = 0;
+        memcpy(pValue, value, len);
+        pValue[len] = 0;
         rp->time = pasynUser->timestamp;
         rp->status = pasynUser->auxStatus;
         rp->alarmStatus = pasynUser->alarmStatus;
         rp->alarmSeverity = pasynUser->alarmSeverity;
-        pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-        if (pPvt->ringHead == pPvt->ringTail) {
-            /* There was no room in the ring buffer.  Remove the oldest value from the
-             * ring buffer and add the new one so the final value the record receives
-             * is guaranteed to be the most recent value */
-            pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-            pPvt->ringBufferOverflows++;
-        } else {
+        if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
             /* We only need to request the record to process if we added a new
              * element to the ring buffer, not if we just replaced an element. */
             if (pPvt->isOutput) {
+                epicsMutexLock(pPvt->devPvtLock);
                 /* If this callback was received during asynchronous record processing
                  * we must defer calling callbackRequest until end of record processing */
                 if (pPvt->asyncProcessingActive) {
@@ -557,12 +551,12 @@ static void interruptCallback(void *drvPvt, asynUser *pasynUser,
                 } else {
                     callbackRequest(&pPvt->outputCallback);
                 }
+                epicsMutexUnlock(pPvt->devPvtLock);
             } else {
                 scanIoRequest(pPvt->ioScanPvt);
             }
         }
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void outputCallbackCallback(CALLBACK *pcb)
@@ -688,7 +682,7 @@ static asynStatus writeIt(asynUser *pasynUser,const char *message,size_t nbytes)
         return asynError;
     }
     else {
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE, message, nbytes,
+        asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DEVICE, message, nbytes,
             "%s %s::%s\n", precord->name, driverName, functionName);
     }
     pPvt->lastStatus = pPvt->result.status;
@@ -711,7 +705,7 @@ static asynStatus readIt(asynUser *pasynUser,char *message,
     pPvt->result.alarmStatus = pPvt->pasynUser->alarmStatus;
     pPvt->result.alarmSeverity = pPvt->pasynUser->alarmSeverity;
     if (pPvt->result.status == asynSuccess) {
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE, message, *nBytesRead,
+        asynPrintIORead(pasynUser, ASYN_TRACEIO_DEVICE, message, *nBytesRead,
             "%s %s::%s eomReason %d\n", precord->name, driverName, functionName, eomReason);
     } else {
         if (pPvt->result.status != pPvt->lastStatus) {
@@ -790,11 +784,8 @@ static long processCommon(dbCommon *precord)
                      precord->name, driverName, functionName);
             }
         } else {
-            /* Copy data from ring buffer */
+            /* Copy data from ring buffer, pPvt->result.pValue points to pPvt->ringResult */
             ringBufferElement *rp = &pPvt->result;
-            /* Need to copy the array with the lock because that is shared even though
-               pPvt->result is a copy */
-            epicsMutexLock(pPvt->devPvtLock);
             if (rp->status == asynSuccess) {
                 memcpy(pPvt->pValue, rp->pValue, rp->len);
                 if (pPvt->pLen != NULL) {
@@ -802,10 +793,9 @@ static long processCommon(dbCommon *precord)
                 }
             }
             precord->time = rp->time;
-            epicsMutexUnlock(pPvt->devPvtLock);
         }
         len = (int)strlen(pPvt->pValue);
-        asynPrintIO(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+        asynPrintIORead(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
             pPvt->pValue, len,
             "%s %s::%s len=%d,  data:",
             precord->name, driverName, functionName, len);
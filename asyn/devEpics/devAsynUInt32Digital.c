@@ -83,11 +83,7 @@ typedef struct devPvt{
     int               canBlock;
     epicsMutexId      devPvtLock;
     epicsUInt32        mask;
-    ringBufferElement *ringBuffer;
-    int               ringHead;
-    int               ringTail;
-    int               ringSize;
-    int               ringBufferOverflows;
+    asynEpicsRing     *ringBuffer;
     ringBufferElement result;
     asynStatus        lastStatus;
     interruptCallbackUInt32Digital interruptCallback;
@@ -112,6 +108,7 @@ static void setEnums(char *outStrings, int *outVals, epicsEnum16 *outSeverities,
                      char *inStrings[], int *inVals, int *inSeverities,
                      size_t numIn, size_t numOut);
 static long createRingBuffer(dbCommon *pr);
+static long report(int level);
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt);
 static void processCallbackInput(asynUser *pasynUser);
 static void processCallbackOutput(asynUser *pasynUser);
@@ -151,7 +148,7 @@ typedef struct analogDset { /* analog  dset */
 } analogDset;
 
 analogDset asynBiUInt32Digital = {
-    6,0,0,initBi,         getIoIntInfo, processBi};
+    6,report,0,initBi,         getIoIntInfo, processBi};
 analogDset asynBoUInt32Digital = {
     6,0,0,initBo,         getIoIntInfo, processBo};
 analogDset asynLiUInt32Digital = {
@@ -314,14 +311,28 @@ static long createRingBuffer(dbCommon *pr)
     const char *sizeString;
 
     if (!pPvt->ringBuffer) {
-        pPvt->ringSize = DEFAULT_RING_BUFFER_SIZE;
+        int ringSize = DEFAULT_RING_BUFFER_SIZE;
         sizeString = asynDbGetInfo(pr, "asyn:FIFO");
-        if (sizeString) pPvt->ringSize = atoi(sizeString);
-        pPvt->ringBuffer = callocMustSucceed(pPvt->ringSize+1, sizeof *pPvt->ringBuffer, "devAsynUInt32Digital::createRingBuffer");
+        if (sizeString) ringSize = atoi(sizeString);
+        if (ringSize < 1) ringSize = 1;
+        /* With asyn:COALESCE only the latest value is kept and the record is
+         * only scanned again once it has processed the previous value */
+        sizeString = asynDbGetInfo(pr, "asyn:COALESCE");
+        if (sizeString && atoi(sizeString)) ringSize = 0;
+        pPvt->ringBuffer = pasynEpicsUtils->ringCreate(pr, driverName, ringSize,
+                                                       sizeof(ringBufferElement));
     }
     return asynSuccess;
 }
 
+/* The FIFO statistics of all records that use this device support are
+ * reported by the first dset */
+static long report(int level)
+{
+    pasynEpicsUtils->ringReport(stdout, driverName, level);
+    return 0;
+}
+
 
 static long getIoIntInfo(int cmd, dbCommon *pr, IOSCANPVT *iopvt)
 {
@@ -458,27 +469,17 @@ static void interruptCallbackInput(void *drvPvt, asynUser *pasynUser,
      * Instead we just return.  There will then be nothing in the ring buffer, so the first
      * read will do a read from the driver, which should be OK. */
     if (!interruptAccept) return;
-    epicsMutexLock(pPvt->devPvtLock);
-    rp = &pPvt->ringBuffer[pPvt->ringHead];
+    rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
     rp->value = value;
     rp->time = pasynUser->timestamp;
     rp->status = pasynUser->auxStatus;
     rp->alarmStatus = pasynUser->alarmStatus;
     rp->alarmSeverity = pasynUser->alarmSeverity;
-    pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-    if (pPvt->ringHead == pPvt->ringTail) {
-        /* There was no room in the ring buffer.  In the past we just threw away
-         * the new value.  However, it is better to remove the oldest value from the
-         * ring buffer and add the new one.  That way the final value the record receives
-         * is guaranteed to be the most recent value */
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        pPvt->ringBufferOverflows++;
-    } else {
+    if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
         /* We only need to request the record to process if we added a
          * new element to the ring buffer, not if we just replaced an element. */
         scanIoRequest(pPvt->ioScanPvt);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
@@ -493,18 +494,14 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
         "%s %s::%s new value=%u\n",
         pr->name, driverName, functionName, value);
     if (!interruptAccept) return;
-    epicsMutexLock(pPvt->devPvtLock);
-    rp = &pPvt->ringBuffer[pPvt->ringHead];
+    rp = pasynEpicsUtils->ringPutStart(pPvt->ringBuffer);
     rp->value = value;
     rp->time = pasynUser->timestamp;
     rp->status = pasynUser->auxStatus;
     rp->alarmStatus = pasynUser->alarmStatus;
     rp->alarmSeverity = pasynUser->alarmSeverity;
-    pPvt->ringHead = (pPvt->ringHead==pPvt->ringSize) ? 0 : pPvt->ringHead+1;
-    if (pPvt->ringHead == pPvt->ringTail) {
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        pPvt->ringBufferOverflows++;
-    } else {
+    if (pasynEpicsUtils->ringPutDone(pPvt->ringBuffer)) {
+        epicsMutexLock(pPvt->devPvtLock);
         /* If this callback was received during asynchronous record processing
          * we must defer calling callbackRequest until end of record processing */
         if (pPvt->asyncProcessingActive) {
@@ -512,8 +509,8 @@ static void interruptCallbackOutput(void *drvPvt, asynUser *pasynUser,
         } else {
             callbackRequest(&pPvt->outputCallback);
         }
+        epicsMutexUnlock(pPvt->devPvtLock);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
 }
 
 static void outputCallbackCallback(CALLBACK *pcb)
@@ -602,26 +599,20 @@ static void interruptCallbackEnumBo(void *drvPvt, asynUser *pasynUser,
 
 static int getCallbackValue(devPvt *pPvt)
 {
-    int ret = 0;
+    int overflows;
     static const char *functionName="getCallbackValue";
 
-    epicsMutexLock(pPvt->devPvtLock);
-    if (pPvt->ringTail != pPvt->ringHead) {
-        if (pPvt->ringBufferOverflows > 0) {
-            asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
-                "%s %s::%s warning, %d ring buffer overflows\n",
-                                    pPvt->pr->name, driverName, functionName, pPvt->ringBufferOverflows);
-            pPvt->ringBufferOverflows = 0;
-        }
-        pPvt->result = pPvt->ringBuffer[pPvt->ringTail];
-        pPvt->ringTail = (pPvt->ringTail==pPvt->ringSize) ? 0 : pPvt->ringTail+1;
-        asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
-            "%s %s::%s from ringBuffer value=%d\n",
-                                            pPvt->pr->name, driverName, functionName,pPvt->result.value);
-        ret = 1;
+    if (!pPvt->ringBuffer ||
+        !pasynEpicsUtils->ringGet(pPvt->ringBuffer, &pPvt->result, &overflows)) return 0;
+    if (overflows > 0) {
+        asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING,
+            "%s %s::%s warning, %d ring buffer overflows\n",
+            pPvt->pr->name, driverName, functionName, overflows);
     }
-    epicsMutexUnlock(pPvt->devPvtLock);
-    return ret;
+    asynPrint(pPvt->pasynUser, ASYN_TRACEIO_DEVICE,
+        "%s %s::%s from ringBuffer value=%d\n",
+        pPvt->pr->name, driverName, functionName, pPvt->result.value);
+    return 1;
 }
 
 static int computeShift(epicsUInt32 mask)
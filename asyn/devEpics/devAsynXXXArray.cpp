@@ -32,6 +32,7 @@
 #include <asynDriver.h>
 #include <asynDrvUser.h>
 #include <asynEpicsUtils.h>
+#include <asynArrayBuffer.h>
 #include <asynInt8Array.h>
 #include <asynInt16Array.h>
 #include <asynInt32Array.h>
@@ -56,9 +57,14 @@ class devAsynXXXArray
 {
 
 private:
+    /* Each element owns a reference to pBuffer, which is either the driver's
+     * asynArrayBuffer or a copy of the callback data if isCopy.
+     * pValue points into pBuffer. getRingBufferValue moves the reference to result_ */
     struct ringBufferElement {
         EPICS_TYPE          *pValue;
         size_t              len;
+        asynArrayBuffer     *pBuffer;
+        bool                isCopy;
         epicsTimeStamp      time;
         asynStatus          status;
         epicsAlarmCondition alarmStatus;
@@ -82,6 +88,7 @@ private:
     int                 ringSize_;
     int                 ringBufferOverflows_;
     ringBufferElement   result_;
+    asynArrayBuffer     *spareCopy_; /* A copy buffer that process has finished with */
     int                 gotValue_; /* For interruptCallbackInput */
     INTERRUPT           interruptCallback_;
     char                *portName_;
@@ -104,6 +111,8 @@ public:
         ringTail_(0),
         ringSize_(0),
         ringBufferOverflows_(0),
+        result_(),
+        spareCopy_(0),
         gotValue_(0),
         interruptCallback_(interruptCallback),
         interfaceType_(epicsStrDup(interfaceType)),
@@ -208,17 +217,10 @@ public:
             sizeString = dbGetInfo(pdbentry, "asyn:FIFO");
             if (sizeString) ringSize_ = atoi(sizeString);
             if (ringSize_ > 0) {
-                int i;
+                /* The arrays for the elements are allocated in interruptCallback as needed */
                 ringBuffer_ = (ringBufferElement *) callocMustSucceed(
                                   ringSize_, sizeof(*ringBuffer_),
                                   "devAsynXXXArray::createRingBuffer creating ring buffer");
-                /* Allocate array for each ring buffer element */
-                for (i=0; i<ringSize_; i++) {
-                    ringBuffer_[i].pValue =
-                        (EPICS_TYPE *)callocMustSucceed(
-                            pRecord_->nelm, sizeof(EPICS_TYPE),
-                            "devAsynXXXArray::createRingBuffer creating ring element array");
-                }
             }
         }
         return asynSuccess;
@@ -311,19 +313,17 @@ public:
                 EPICS_TYPE *pData = (EPICS_TYPE *)pRecord_->bptr;
                 ringBufferElement *rp = &result_;
                 int i;
-                /* Need to copy the array with the lock because that is shared even though
-                   result_ is a copy */
+                /* result_ owns pBuffer, so the copy needs no lock */
                 if (rp->status == asynSuccess) {
-                    epicsMutexLock(ringBufferLock_);
                     for (i=0; i<(int)rp->len; i++) pData[i] = rp->pValue[i];
-                    epicsMutexUnlock(ringBufferLock_);
                     pRecord_->nord = (epicsUInt32)rp->len;
-                    asynPrintIO(pasynUser_, ASYN_TRACEIO_DEVICE,
+                    asynPrintIORead(pasynUser_, ASYN_TRACEIO_DEVICE,
                         (char *)pRecord_->bptr, pRecord_->nord*sizeof(EPICS_TYPE),
                         "%s %s::%s nord=%d, pRecord_->bptr data:",
                         pRecord_->name, driverName, driverName, pRecord_->nord);
                 }
                 pRecord_->time = rp->time;
+                releaseBuffer(rp);
             }
         }
         pasynEpicsUtils->asynStatusToEpicsAlarm(result_.status,
@@ -385,7 +385,11 @@ public:
                     pRecord_->name, driverName, functionName, ringBufferOverflows_);
                 ringBufferOverflows_ = 0;
             }
+            /* Move the reference to the buffer to result_ */
+            releaseBufferLocked(&result_);
             result_ = ringBuffer_[ringTail_];
+            ringBuffer_[ringTail_].pBuffer = 0;
+            ringBuffer_[ringTail_].pValue = 0;
             ringTail_ = (ringTail_ == ringSize_-1) ? 0 : ringTail_ + 1;
             ret = 1;
         }
@@ -393,13 +397,50 @@ public:
         return ret;
     }
 
+    /* Keeps one copy buffer for reuse by interruptCallback. Must be called with ringBufferLock_ */
+    void releaseBufferLocked(ringBufferElement *rp)
+    {
+        if (rp->isCopy && !spareCopy_) {
+            spareCopy_ = rp->pBuffer;
+        } else {
+            asynArrayBufferRelease(rp->pBuffer);
+        }
+        rp->pBuffer = 0;
+        rp->pValue = 0;
+    }
+
+    void releaseBuffer(ringBufferElement *rp)
+    {
+        if (!rp->pBuffer) return;
+        epicsMutexLock(ringBufferLock_);
+        releaseBufferLocked(rp);
+        epicsMutexUnlock(ringBufferLock_);
+    }
+
+    /* Returns a copy buffer for at least nBytes. Must be called with ringBufferLock_ */
+    asynArrayBuffer *getCopyBuffer(ringBufferElement *rp, size_t nBytes)
+    {
+        asynArrayBuffer *pBuffer = 0;
+
+        if (rp->isCopy && rp->pBuffer && asynArrayBufferSize(rp->pBuffer) >= nBytes) {
+            pBuffer = rp->pBuffer;
+            rp->pBuffer = 0;
+        } else if (spareCopy_ && asynArrayBufferSize(spareCopy_) >= nBytes) {
+            pBuffer = spareCopy_;
+            spareCopy_ = 0;
+        }
+        releaseBufferLocked(rp);
+        if (!pBuffer) pBuffer = asynArrayBufferCreate(nBytes);
+        return pBuffer;
+    }
+
     void interruptCallback(asynUser *pasynUser, EPICS_TYPE *value, size_t len)
     {
         int i;
         EPICS_TYPE *pData = (EPICS_TYPE *)pRecord_->bptr;
         static const char *functionName = "interruptCallback";
 
-        asynPrintIO(pasynUser_, ASYN_TRACEIO_DEVICE,
+        asynPrintIORead(pasynUser_, ASYN_TRACEIO_DEVICE,
             (char *)value, len*sizeof(EPICS_TYPE),
             "%s %s::%s ringSize=%d, len=%d, callback data:",
             pRecord_->name, driverName, functionName, ringSize_, (int)len);
@@ -424,6 +465,7 @@ public:
         } else {
             /* Using a ring buffer */
             ringBufferElement *rp;
+            asynArrayBuffer *pBuffer;
 
             /* If interruptAccept is false we just return.  This prevents more ring pushes than pops.
              * There will then be nothing in the ring buffer, so the first
@@ -434,7 +476,23 @@ public:
             rp = &ringBuffer_[ringHead_];
             if (len > pRecord_->nelm) len = pRecord_->nelm;
             rp->len = len;
-            for (i=0; i<(int)len; i++) rp->pValue[i] = value[i];
+            /* Keep a reference to the driver's buffer if there is one, otherwise copy */
+            pBuffer = pasynUser->arrayBuffer;
+            if (pBuffer && ((char *)value < (char *)asynArrayBufferData(pBuffer) ||
+                            (char *)(value + len) > (char *)asynArrayBufferData(pBuffer) + asynArrayBufferSize(pBuffer)))
+                pBuffer = 0;
+            if (pBuffer) {
+                asynArrayBufferReserve(pBuffer);
+                releaseBufferLocked(rp);
+                rp->pBuffer = pBuffer;
+                rp->pValue = value;
+                rp->isCopy = false;
+            } else {
+                rp->pBuffer = getCopyBuffer(rp, len*sizeof(EPICS_TYPE));
+                rp->pValue = (EPICS_TYPE *)asynArrayBufferData(rp->pBuffer);
+                rp->isCopy = true;
+                for (i=0; i<(int)len; i++) rp->pValue[i] = value[i];
+            }
             rp->time = pasynUser->timestamp;
             rp->status = (asynStatus) pasynUser->auxStatus;
             rp->alarmStatus = (epicsAlarmCondition) pasynUser->alarmStatus;
@@ -1,3 +1,11 @@
+/* The waveform record looks up BPTR each time the array is read since base 3.16,
+ * so streaming mode can give the record a full buffer instead of copying it */
+#if LT_EPICSBASE(3,16,0,0)
+#define ASYN_TIME_SERIES_SWAP_BPTR 0
+#else
+#define ASYN_TIME_SERIES_SWAP_BPTR 1
+#endif
+
 #define ASYN_XXX_TIME_SERIES_FUNCS(DRIVER_NAME, INTERFACE, INTERFACE_TYPE, \
                                    INTERRUPT, EPICS_TYPE, DSET, \
                                    SIGNED_TYPE, UNSIGNED_TYPE) \
@@ -30,10 +38,20 @@ typedef struct devAsynWfPvt{ \
     epicsMutexId    lock; \
     int             addr; \
     asynStatus      status; \
+    /* Streaming mode (asyn:TS_BLOCK). Blocks are collected in pFill. A full \
+     * block is moved to pReady for the record and pFree replaces pFill */ \
+    int             streaming; \
+    epicsUInt32     blockSize; \
+    EPICS_TYPE      *pFill; \
+    EPICS_TYPE      *pReady; \
+    EPICS_TYPE      *pFree; \
+    unsigned long   overruns; \
 } devAsynWfPvt; \
  \
 static long initRecord(dbCommon *pr); \
 static long process(dbCommon *pr); \
+static long processStreaming(dbCommon *pr); \
+static void startStopCallbacks(devAsynWfPvt *pPvt, int busy); \
 static void interruptCallback(void *drvPvt, asynUser *pasynUser,  \
                 EPICS_TYPE value); \
  \
@@ -114,6 +132,20 @@ static long initRecord(dbCommon *pr) \
     } \
     pPvt->pInterface = pasynInterface->pinterface; \
     pPvt->ifacePvt = pasynInterface->drvPvt; \
+    /* asyn:TS_BLOCK enables streaming mode with that many values per block */ \
+    { \
+        const char *blockString = asynDbGetInfo(pr, "asyn:TS_BLOCK"); \
+        if (blockString) { \
+            int blockSize = atoi(blockString); \
+            if ((blockSize <= 0) || (blockSize > (int)pwf->nelm)) blockSize = pwf->nelm; \
+            pPvt->streaming = 1; \
+            pPvt->blockSize = blockSize; \
+            pPvt->pFill = callocMustSucceed(pwf->nelm, sizeof(EPICS_TYPE), \
+                                            "devAsynXXXTimeSeries::initRecord"); \
+            pPvt->pFree = callocMustSucceed(pwf->nelm, sizeof(EPICS_TYPE), \
+                                            "devAsynXXXTimeSeries::initRecord"); \
+        } \
+    } \
     return 0; \
 bad: \
    pr->pact=1; \
@@ -121,15 +153,41 @@ bad: \
 } \
  \
  \
+static void startStopCallbacks(devAsynWfPvt *pPvt, int busy) \
+{ \
+    dbCommon *pr = pPvt->pr; \
+    asynStatus status; \
+ \
+    if (busy) { \
+      status = pPvt->pInterface->registerInterruptUser( \
+         pPvt->ifacePvt, pPvt->pasynUser, \
+         interruptCallback, pPvt, &pPvt->registrarPvt); \
+      if(status!=asynSuccess) { \
+          asynPrint(pPvt->pasynUser, ASYN_TRACE_ERROR, \
+              "%s %s registerInterruptUser %s\n", \
+              pr->name, driverName, pPvt->pasynUser->errorMessage); \
+      } \
+    } \
+    else {\
+      status = pPvt->pInterface->cancelInterruptUser( \
+         pPvt->ifacePvt, pPvt->pasynUser, pPvt->registrarPvt); \
+      if(status!=asynSuccess) { \
+          asynPrint(pPvt->pasynUser, ASYN_TRACE_ERROR, \
+              "%s %s cancelInterruptUser %s\n", \
+              pr->name, driverName, pPvt->pasynUser->errorMessage); \
+      } \
+    } \
+} \
+ \
 static long process(dbCommon *pr) \
 { \
     devAsynWfPvt *pPvt = (devAsynWfPvt *)pr->dpvt; \
     waveformRecord *pwf = (waveformRecord *)pr; \
     int busy; \
-    asynStatus status; \
     epicsAlarmCondition alarmStat; \
     epicsAlarmSeverity alarmSevr; \
  \
+    if (pPvt->streaming) return processStreaming(pr); \
     epicsMutexLock(pPvt->lock); \
     busy = pPvt->busy; \
     switch(pwf->rarm) { \
@@ -155,25 +213,7 @@ static long process(dbCommon *pr) \
       pwf->busy = busy; \
       db_post_events(pwf, &pwf->busy, DBE_VALUE | DBE_LOG); \
       /* BUSY has changed state so either register or cancel callbacks */ \
-      if (busy) { \
-        status = pPvt->pInterface->registerInterruptUser( \
-           pPvt->ifacePvt, pPvt->pasynUser, \
-           interruptCallback, pPvt, &pPvt->registrarPvt); \
-        if(status!=asynSuccess) { \
-            asynPrint(pPvt->pasynUser, ASYN_TRACE_ERROR, \
-                "%s %s registerInterruptUser %s\n", \
-                pr->name, driverName, pPvt->pasynUser->errorMessage); \
-        } \
-      } \
-      else {\
-        status = pPvt->pInterface->cancelInterruptUser( \
-           pPvt->ifacePvt, pPvt->pasynUser, pPvt->registrarPvt); \
-        if(status!=asynSuccess) { \
-            asynPrint(pPvt->pasynUser, ASYN_TRACE_ERROR, \
-                "%s %s cancelInterruptUser %s\n", \
-                pr->name, driverName, pPvt->pasynUser->errorMessage); \
-        } \
-      } \
+      startStopCallbacks(pPvt, busy); \
     } \
     pPvt->busy = pwf->busy; \
     pwf->rarm = 0; \
@@ -188,6 +228,70 @@ static long process(dbCommon *pr) \
     return 0; \
 }  \
  \
+/* In streaming mode the record is processed each time a block is full. \
+ * It takes the full block, by swapping buffers with BPTR where possible, \
+ * and acquisition continues into the other buffer. */ \
+static long processStreaming(dbCommon *pr) \
+{ \
+    devAsynWfPvt *pPvt = (devAsynWfPvt *)pr->dpvt; \
+    waveformRecord *pwf = (waveformRecord *)pr; \
+    int busy; \
+    epicsUInt32 nord = pwf->nord; \
+    epicsAlarmCondition alarmStat; \
+    epicsAlarmSeverity alarmSevr; \
+ \
+    epicsMutexLock(pPvt->lock); \
+    busy = pPvt->busy; \
+    switch(pwf->rarm) { \
+      case 1: \
+        /* Discard the partial and the unpublished block */ \
+        pPvt->nord = 0; \
+        if (pPvt->pReady) { \
+            pPvt->pFree = pPvt->pReady; \
+            pPvt->pReady = 0; \
+        } \
+        busy = 1; \
+        break; \
+      case 2: \
+        busy = 0; \
+        break; \
+      case 3: \
+        busy = 1; \
+        break; \
+    } \
+    if (pPvt->pReady) { \
+        if (ASYN_TIME_SERIES_SWAP_BPTR) { \
+            pPvt->pFree = (EPICS_TYPE *)pwf->bptr; \
+            pwf->bptr = pPvt->pReady; \
+        } else { \
+            memcpy(pwf->bptr, pPvt->pReady, pPvt->blockSize*sizeof(EPICS_TYPE)); \
+            pPvt->pFree = pPvt->pReady; \
+        } \
+        pPvt->pReady = 0; \
+        nord = pPvt->blockSize; \
+    } \
+    pPvt->busy = busy; \
+    epicsMutexUnlock(pPvt->lock); \
+    if (pwf->nord != nord) { \
+      pwf->nord = nord; \
+      db_post_events(pwf, &pwf->nord, DBE_VALUE | DBE_LOG); \
+    } \
+    if (pwf->busy != busy) { \
+      pwf->busy = busy; \
+      db_post_events(pwf, &pwf->busy, DBE_VALUE | DBE_LOG); \
+      startStopCallbacks(pPvt, busy); \
+    } \
+    pwf->rarm = 0; \
+    pwf->udf = 0; \
+    if (pPvt->status != asynSuccess) { \
+        pasynEpicsUtils->asynStatusToEpicsAlarm(pPvt->status, READ_ALARM, &alarmStat, \
+                                                INVALID_ALARM, &alarmSevr); \
+        recGblSetSevr(pr, alarmStat, alarmSevr); \
+    } \
+    pPvt->status = asynSuccess; \
+    return 0; \
+} \
+ \
 static void interruptCallback(void *drvPvt, asynUser *pasynUser, EPICS_TYPE value) \
 { \
     devAsynWfPvt *pPvt = (devAsynWfPvt *)drvPvt; \
@@ -199,7 +303,28 @@ static void interruptCallback(void *drvPvt, asynUser *pasynUser, EPICS_TYPE valu
         "%s %s::interruptCallback, value=%f, nord=%d\n", \
         pwf->name, driverName, (double)value, pPvt->nord); \
     /* If we are not acquiring then nothing to do */  \
-    if (pPvt->busy) { \
+    if (pPvt->busy && pPvt->streaming) { \
+      pPvt->pFill[pPvt->nord++] = value; \
+      if (pPvt->nord >= pPvt->blockSize) { \
+        EPICS_TYPE *pFull = pPvt->pFill; \
+        pPvt->nord = 0; \
+        if (pPvt->pReady) { \
+          /* The record has not taken the previous block. Replace it with this one \
+           * rather than wait, and reuse its buffer */ \
+          pPvt->pFill = pPvt->pReady; \
+          pPvt->overruns++; \
+          asynPrint(pPvt->pasynUser, ASYN_TRACE_WARNING, \
+              "%s %s::interruptCallback, block overrun, %lu overruns\n", \
+              pwf->name, driverName, pPvt->overruns); \
+        } else { \
+          pPvt->pFill = pPvt->pFree; \
+          pPvt->pFree = 0; \
+          callbackRequestProcessCallback(&pPvt->callback,pwf->prio,pwf); \
+        } \
+        pPvt->pReady = pFull; \
+      } \
+    } \
+    else if (pPvt->busy) { \
       if (pPvt->nord < pwf->nelm) { \
         pData[pPvt->nord] = value; \
         pPvt->nord++; \
@@ -129,7 +129,7 @@ static int readCvtio(gpibDpvt *pgpibDpvt,int P1, int P2, char **P3)
     status  = pasynOctet->write(asynOctetPvt,pasynUser,
         pgpibCmd->cmd,lenmsg,&nchars);
     if(nchars==lenmsg) {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,pgpibCmd->cmd,nchars,
+        asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DEVICE,pgpibCmd->cmd,nchars,
                                             "%s readCvtio\n",precord->name);
     } else {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
@@ -148,7 +148,7 @@ static int readCvtio(gpibDpvt *pgpibDpvt,int P1, int P2, char **P3)
     asynPrint(pasynUser,ASYN_TRACE_FLOW,"%s readCvtio nchars %d\n",
         precord->name,nchars);
     if(nchars > 0) {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,nchars,
+        asynPrintIORead(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,nchars,
             "%s readCvtio\n",precord->name);
     } else {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
@@ -205,7 +205,7 @@ static int writeCvtio(gpibDpvt *pgpibDpvt,int P1, int P2, char **P3)
     status  = pasynOctet->write(asynOctetPvt,pasynUser,
         pgpibDpvt->msg,lenmsg,&nsent);
     if(nsent==lenmsg) {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,lenmsg,
+        asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,lenmsg,
                                             "%s writeCvtio\n",precord->name);
     } else {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
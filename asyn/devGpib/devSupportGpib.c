@@ -579,7 +579,7 @@ static int readArbitraryBlockProgramData(gpibDpvt *pgpibDpvt)
     pgpibDpvt->msgInputLen = (int)(buf - pgpibDpvt->msg);
     if (pgpibDpvt->msgInputLen < pgpibCmd->msgLen)
         *buf = '\0'; /* Add a hidden trailing NUL as a professional courtesy */
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,pgpibDpvt->msgInputLen,
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,pgpibDpvt->msgInputLen,
         "%s readArbitraryBlockProgramData\n",pgpibDpvt->precord->name);
     return pgpibDpvt->msgInputLen;
 }
@@ -978,7 +978,7 @@ static void gpibRead(gpibDpvt *pgpibDpvt,int failure)
     asynPrint(pasynUser,ASYN_TRACE_FLOW,"%s gpibRead nchars %lu\n",
         precord->name,(unsigned long)nchars);
     if(nchars > 0) {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,nchars,
+        asynPrintIORead(pasynUser,ASYN_TRACEIO_DEVICE,pgpibDpvt->msg,nchars,
             "%s gpibRead\n",precord->name);
     } else {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
@@ -1384,7 +1384,7 @@ static int writeIt(gpibDpvt *pgpibDpvt,char *message,size_t len)
 
     status = pasynOctet->write(asynOctetPvt,pasynUser, message,len,&nchars);
     if(nchars==len) {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,message,nchars,
+        asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DEVICE,message,nchars,
                                             "%s writeIt\n",precord->name);
     } else {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
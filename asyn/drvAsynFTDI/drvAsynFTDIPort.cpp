@@ -381,7 +381,7 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
     assert(ftdi);
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
               "%d:%d write.\n", ftdi->FTDIvendor, ftdi->FTDIproduct);
-    asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
+    asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
                 "%d:%d write %lu\n", ftdi->FTDIvendor, ftdi->FTDIproduct, numchars);
     *nbytesTransfered = 0;
 
@@ -45,7 +45,10 @@
 #include <errlog.h>
 #include <iocsh.h>
 #include <epicsAssert.h>
+#include <epicsEvent.h>
 #include <epicsExit.h>
+#include <epicsMessageQueue.h>
+#include <epicsMutex.h>
 #include <epicsStdio.h>
 #include <epicsString.h>
 #include <epicsThread.h>
@@ -68,6 +71,12 @@
 # include <sys/un.h>
 #endif
 
+/* sendmsg() is used to write several segments with one system call */
+#if !defined(_WIN32)
+# define HAS_SENDMSG 1
+# include <sys/uio.h>
+#endif
+
 #if defined(__rtems__)
 # define USE_SOCKTIMEOUT
 #else
@@ -98,6 +107,19 @@
 #define SEND_RETRY_DELAY 0.01
 
 #define ISCOM_UNKNOWN (-1)
+/* Largest number of segments written by one sendmsg() call */
+#define MAX_SEGMENTS 16
+/* Socket send and receive timeouts have not been set since the socket was opened */
+#define TIMEOUT_NOT_SET (-2)
+/* Defaults for streaming mode: largest frame and number of frames that can be queued */
+#define STREAM_FRAME_SIZE 256
+#define STREAM_QUEUE_SIZE 32
+/* How long the stream reader waits for input before checking for changes to the port */
+#define STREAM_POLL_DELAY 0.1
+/* Largest number of characters the stream reader receives with one read */
+#define STREAM_READ_SIZE 512
+/* How long to wait for each stream thread to exit when the stream is stopped */
+#define STREAM_EXIT_TIMEOUT 2.0
 
 /*
  * This structure holds the hardware-specific information for a single
@@ -115,6 +137,31 @@ typedef struct {
     SOCKET             fd;
     unsigned long      nRead;
     unsigned long      nWritten;
+    char              *readAheadBuffer;
+    size_t             readAheadSize;
+    size_t             readAheadHead;
+    size_t             readAheadCount;
+    unsigned long      nReadAhead;
+    unsigned long      nSocketCalls;
+    int                recvTimeoutMsec;
+    int                sendTimeoutMsec;
+    int                streamEnabled;   /* Only accessed with the port lock */
+    size_t             streamFrameSize;
+    int                streamQueueSize;
+    asynUser          *streamUser;
+    asynUser          *streamCallbackUser;
+    asynInterface     *pstreamOctet;
+    void              *octetInterruptPvt;
+    epicsEventId       streamEvent;     /* Wakes the parked stream reader */
+    epicsEventId       streamReadExited;
+    epicsEventId       streamCallbackExited;
+    epicsMessageQueueId streamQueue;
+    epicsMutexId       streamLock;      /* Protects streamShutdown, and the socket while the stream reader polls it */
+    int                streamShutdown;
+    int                streamReadRunning;
+    int                streamCallbackRunning;
+    unsigned long      nStreamFrames;
+    unsigned long      nStreamOverruns;
     union {
       osiSockAddr        oa;
 #if defined(HAS_AF_UNIX)
@@ -127,6 +174,7 @@ typedef struct {
     asynInterface      common;
     asynInterface      option;
     asynInterface      octet;
+    asynInterface      octetSegments;
 } ttyController_t;
 
 #define FLAG_BROADCAST                  0x1
@@ -136,6 +184,14 @@ typedef struct {
 #define FLAG_NEED_LOOKUP                0x100
 #define FLAG_DONE_LOOKUP                0x200
 
+/*
+ * Header of a frame in the stream queue, followed by the characters
+ */
+typedef struct {
+    size_t             nbytes;
+    int                eomReason;
+} streamFrame_t;
+
 #ifdef FAKE_POLL
 /*
  * Use select() to simulate enough of poll() to get by.
@@ -208,9 +264,13 @@ closeConnection(asynUser *pasynUser,ttyController_t *tty,const char *why)
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
               "Closing %s connection (fd %d): %s\n", tty->IPDeviceName, tty->fd, why);
     if (tty->fd != INVALID_SOCKET) {
+        /* The stream reader polls the socket without the port lock */
+        if (tty->streamLock) epicsMutexMustLock(tty->streamLock);
         epicsSocketDestroy(tty->fd);
         tty->fd = INVALID_SOCKET;
+        if (tty->streamLock) epicsMutexUnlock(tty->streamLock);
     }
+    tty->readAheadCount = 0;
     if (!(tty->flags & FLAG_CONNECT_PER_TRANSACTION) ||
          (tty->flags & FLAG_SHUTDOWN))
         pasynManager->exceptionDisconnect(pasynUser);
@@ -235,9 +295,19 @@ asynCommonReport(void *drvPvt, FILE *fp, int details)
         fprintf(fp, "                    fd: %d\n", (int)tty->fd);
         fprintf(fp, "    Characters written: %lu\n", tty->nWritten);
         fprintf(fp, "       Characters read: %lu\n", tty->nRead);
+        if (tty->readAheadSize > 0)
+            fprintf(fp, "     Read-ahead buffer: %lu bytes, %lu buffered, %lu reads from buffer\n",
+                    (unsigned long)tty->readAheadSize, (unsigned long)tty->readAheadCount,
+                    tty->nReadAhead);
+        fprintf(fp, "      Socket I/O calls: %lu\n", tty->nSocketCalls);
+        if (tty->streamQueue)
+            fprintf(fp, "             Streaming: %s, %lu frames queued, %lu overruns\n",
+                    tty->streamEnabled ? "on" : "off", tty->nStreamFrames, tty->nStreamOverruns);
     }
 }
 
+static void stopStreamThreads(ttyController_t *tty);
+
 /*
  * Clean up a socket on exit
  * This helps reduce problems with vxWorks when the IOC restarts
@@ -249,6 +319,8 @@ cleanup (void *arg)
     ttyController_t *tty = (ttyController_t *)arg;
 
     if (!tty) return;
+    /* The stream reader takes the port lock, so stop it first */
+    stopStreamThreads(tty);
     status=pasynManager->lockPort(tty->pasynUser);
     if(status!=asynSuccess)
         asynPrint(tty->pasynUser, ASYN_TRACE_ERROR, "%s: cleanup locking error\n", tty->portName);
@@ -553,6 +625,9 @@ connectIt(void *drvPvt, asynUser *pasynUser)
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
                           "Opened connection OK to %s\n", tty->IPDeviceName);
     tty->fd = fd;
+    tty->readAheadCount = 0;
+    tty->recvTimeoutMsec = tty->sendTimeoutMsec = TIMEOUT_NOT_SET;
+    if (tty->streamEvent) epicsEventSignal(tty->streamEvent);
     return asynSuccess;
 }
 
@@ -582,27 +657,74 @@ asynCommonDisconnect(void *drvPvt, asynUser *pasynUser)
 }
 
 /*Beginning of asynOctet methods*/
+/*
+ * Send the segments, starting offset characters into the first one
+ */
+static int sendSegments(ttyController_t *tty, const asynOctetSegment *segments,
+    int nsegments, size_t offset)
+{
+#ifdef HAS_SENDMSG
+    if (nsegments > 1) {
+        struct iovec iov[MAX_SEGMENTS];
+        struct msghdr msg;
+        int i;
+
+        if (nsegments > MAX_SEGMENTS) nsegments = MAX_SEGMENTS;
+        for (i=0; i<nsegments; i++) {
+            iov[i].iov_base = (char *)segments[i].data;
+            iov[i].iov_len = segments[i].numchars;
+        }
+        iov[0].iov_base = (char *)segments[0].data + offset;
+        iov[0].iov_len -= offset;
+        memset(&msg, 0, sizeof msg);
+        if (tty->socketType == SOCK_DGRAM) {
+            msg.msg_name = &tty->farAddr.oa.sa;
+            msg.msg_namelen = tty->farAddrSize;
+        }
+        msg.msg_iov = iov;
+        msg.msg_iovlen = nsegments;
+        return sendmsg(tty->fd, &msg, 0);
+    }
+#endif
+    if (tty->socketType == SOCK_DGRAM) {
+        return sendto(tty->fd, (char *)segments[0].data + offset,
+                      (int)(segments[0].numchars - offset), 0,
+                      &tty->farAddr.oa.sa, (int)tty->farAddrSize);
+    }
+    return send(tty->fd, (char *)segments[0].data + offset,
+                (int)(segments[0].numchars - offset), 0);
+}
+
 /*
  * Write to the TCP port
  */
-static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
-    const char *data, size_t numchars,size_t *nbytesTransfered)
+static asynStatus writeSegmentsIt(void *drvPvt, asynUser *pasynUser,
+    const asynOctetSegment *segments, int nsegments, size_t *nbytesTransfered)
 {
     ttyController_t *tty = (ttyController_t *)drvPvt;
     int thisWrite;
+    size_t numchars = 0;
+    size_t offset = 0;
+    int i;
     asynStatus status = asynSuccess;
     int writePollmsec;
     int epicsTimeStatus;
     epicsTimeStamp startTime;
     epicsTimeStamp endTime;
     int haveStartTime;
+#ifdef USE_POLL
+    int sendPending = 0;
+#endif
     char sockerrmsg[256];
 
     assert(tty);
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
               "%s write.\n", tty->IPDeviceName);
-    asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
-                "%s write %lu\n", tty->IPDeviceName, (unsigned long)numchars);
+    for (i=0; i<nsegments; i++) {
+        asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, segments[i].data, segments[i].numchars,
+                    "%s write %lu\n", tty->IPDeviceName, (unsigned long)segments[i].numchars);
+        numchars += segments[i].numchars;
+    }
     *nbytesTransfered = 0;
     if (tty->fd == INVALID_SOCKET) {
         if (tty->flags & FLAG_CONNECT_PER_TRANSACTION) {
@@ -621,14 +743,27 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
     }
     if (numchars == 0)
         return asynSuccess;
+    if ((tty->socketType == SOCK_DGRAM) && (nsegments > MAX_SEGMENTS)) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s %d segments, a datagram can have at most %d",
+                      tty->IPDeviceName, nsegments, MAX_SEGMENTS);
+        return asynError;
+    }
+    /* Empty segments are skipped */
+    while (segments->numchars == 0) {
+        segments++;
+        nsegments--;
+    }
     writePollmsec = (int) (pasynUser->timeout * 1000.0);
     if (writePollmsec == 0) writePollmsec = 1;
     if (writePollmsec < 0) writePollmsec = -1;
 #ifdef USE_SOCKTIMEOUT
-    {
+    /* Only change the socket timeout when the caller's timeout changes */
+    if (writePollmsec != tty->sendTimeoutMsec) {
     struct timeval tv;
     tv.tv_sec = writePollmsec / 1000;
     tv.tv_usec = (writePollmsec % 1000) * 1000;
+    tty->nSocketCalls++;
     if (setsockopt(tty->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv) < 0) {
         epicsSocketConvertErrnoToString(sockerrmsg, sizeof(sockerrmsg));
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
@@ -636,39 +771,45 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
                       tty->IPDeviceName, sockerrmsg);
         return asynError;
     }
+    tty->sendTimeoutMsec = writePollmsec;
     }
 #endif
     haveStartTime = 0;
     for (;;) {
 #ifdef USE_POLL
-        int pollstatus;
-        struct pollfd pollfd;
-        pollfd.fd = tty->fd;
-        pollfd.events = POLLOUT;
-        epicsTimeGetCurrent(&startTime);
-        while ((pollstatus = poll(&pollfd, 1, writePollmsec)) < 0) {
-            if (SOCKERRNO != SOCK_EINTR) {
-                epicsSocketConvertErrnoToString(sockerrmsg, sizeof(sockerrmsg));
-                epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
-                                          "%s poll() failed: %s", tty->IPDeviceName, sockerrmsg);
-                return asynError;
+        /* The socket is non-blocking, so the first send() is attempted without
+         * waiting.  poll() is only needed once the socket buffer is full. */
+        if (sendPending) {
+            int pollstatus;
+            struct pollfd pollfd;
+            pollfd.fd = tty->fd;
+            pollfd.events = POLLOUT;
+            epicsTimeGetCurrent(&startTime);
+            tty->nSocketCalls++;
+            while ((pollstatus = poll(&pollfd, 1, writePollmsec)) < 0) {
+                if (SOCKERRNO != SOCK_EINTR) {
+                    epicsSocketConvertErrnoToString(sockerrmsg, sizeof(sockerrmsg));
+                    epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                                              "%s poll() failed: %s", tty->IPDeviceName, sockerrmsg);
+                    return asynError;
+                }
+                epicsTimeGetCurrent(&endTime);
+                if (epicsTimeDiffInSeconds(&endTime, &startTime)*1000 > writePollmsec) break;
+            }
+            if (pollstatus == 0) {
+                epicsSnprintf(pasynUser->errorMessage, pasynUser->errorMessageSize,
+                                         "%s poll() timed out", tty->IPDeviceName);
+                return asynTimeout;
             }
-            epicsTimeGetCurrent(&endTime);
-            if (epicsTimeDiffInSeconds(&endTime, &startTime)*1000 > writePollmsec) break;
-        }
-        if (pollstatus == 0) {
-            epicsSnprintf(pasynUser->errorMessage, pasynUser->errorMessageSize,
-                                     "%s poll() timed out", tty->IPDeviceName);
-            return asynTimeout;
         }
 #endif
         for (;;) {
-            if (tty->socketType == SOCK_DGRAM) {
-                thisWrite = sendto(tty->fd, (char *)data, (int)numchars, 0, &tty->farAddr.oa.sa, (int)tty->farAddrSize);
-            } else {
-                thisWrite = send(tty->fd, (char *)data, (int)numchars, 0);
-            }
+            tty->nSocketCalls++;
+            thisWrite = sendSegments(tty, segments, nsegments, offset);
             if (thisWrite >= 0) break;
+#ifdef USE_POLL
+            if (!sendPending && (SOCKERRNO == SOCK_EWOULDBLOCK)) break;
+#endif
             if (SOCKERRNO == SOCK_EWOULDBLOCK || SOCKERRNO == SOCK_EINTR) {
                 if (!haveStartTime) {
                     epicsTimeStatus = epicsTimeGetCurrent(&startTime);
@@ -686,13 +827,24 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
                 epicsThreadSleep(SEND_RETRY_DELAY);
             } else break;
         }
+#ifdef USE_POLL
+        if (!sendPending) {
+            sendPending = 1;
+            if ((thisWrite < 0) && (SOCKERRNO == SOCK_EWOULDBLOCK)) continue;
+        }
+#endif
         if (thisWrite > 0) {
             tty->nWritten += (unsigned long)thisWrite;
             *nbytesTransfered += thisWrite;
             numchars -= thisWrite;
             if (numchars == 0)
                 break;
-            data += thisWrite;
+            offset += thisWrite;
+            while (offset >= segments->numchars) {
+                offset -= segments->numchars;
+                segments++;
+                nsegments--;
+            }
         }
         else if (thisWrite == 0) {
             status = asynTimeout;
@@ -717,6 +869,76 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
     return status;
 }
 
+static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
+    const char *data, size_t numchars,size_t *nbytesTransfered)
+{
+    asynOctetSegment segment;
+
+    segment.data = data;
+    segment.numchars = numchars;
+    return writeSegmentsIt(drvPvt, pasynUser, &segment, 1, nbytesTransfered);
+}
+
+/*
+ * Copy characters received by an earlier read into the caller's buffer
+ */
+static size_t takeReadAhead(ttyController_t *tty, char *data, size_t maxchars)
+{
+    size_t n = tty->readAheadCount;
+
+    if (n > maxchars) n = maxchars;
+    memcpy(data, tty->readAheadBuffer + tty->readAheadHead, n);
+    tty->readAheadHead += n;
+    tty->readAheadCount -= n;
+    return n;
+}
+
+/*
+ * Receive whatever is waiting in the socket without waiting for more
+ */
+static int receiveIt(ttyController_t *tty, asynUser *pasynUser, char *data, size_t maxchars)
+{
+    int thisRead;
+
+    tty->nSocketCalls++;
+    if (tty->socketType == SOCK_DGRAM) {
+        /* We use recvfrom() for SOCK_DRAM so we can print the source address with ASYN_TRACEIO_DRIVER */
+        osiSockAddr oa;
+        unsigned int addrlen = sizeof(oa.ia);
+        thisRead = recvfrom(tty->fd, data, (int)maxchars, 0, &oa.sa, &addrlen);
+        if (thisRead >= 0) {
+            if (pasynTrace->getTraceMask(pasynUser) & ASYN_TRACEIO_DRIVER) {
+                char inetBuff[32];
+                ipAddrToDottedIP(&oa.ia, inetBuff, sizeof(inetBuff));
+                asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
+                          "%s (from %s) read %d\n",
+                          tty->IPDeviceName, inetBuff, thisRead);
+            }
+            tty->nRead += (unsigned long)thisRead;
+        }
+    } else if (tty->readAheadSize > maxchars) {
+        /* Receive everything that is available, the characters that do not fit
+         * in data are kept for the next reads */
+        thisRead = recv(tty->fd, tty->readAheadBuffer, (int)tty->readAheadSize, 0);
+        if (thisRead >= 0) {
+            asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, tty->readAheadBuffer, thisRead,
+                        "%s read %d\n", tty->IPDeviceName, thisRead);
+            tty->nRead += (unsigned long)thisRead;
+            tty->readAheadHead = 0;
+            tty->readAheadCount = thisRead;
+            thisRead = (int)takeReadAhead(tty, data, maxchars);
+        }
+    } else {
+        thisRead = recv(tty->fd, data, (int)maxchars, 0);
+        if (thisRead >= 0) {
+            asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
+                        "%s read %d\n", tty->IPDeviceName, thisRead);
+            tty->nRead += (unsigned long)thisRead;
+        }
+    }
+    return thisRead;
+}
+
 /*
  * Read from the TCP port
  */
@@ -735,6 +957,12 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
     assert(tty);
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
               "%s read.\n", tty->IPDeviceName);
+    if (tty->streamEnabled && (pasynUser != tty->streamUser)) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s is streaming, input is only delivered by interrupt callbacks",
+                      tty->IPDeviceName);
+        return asynError;
+    }
     if (tty->fd == INVALID_SOCKET) {
         if (tty->flags & FLAG_CONNECT_PER_TRANSACTION) {
             if ((status = connectIt(drvPvt, pasynUser)) != asynSuccess)
@@ -751,14 +979,30 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
                   "%s maxchars %d. Why <=0?",tty->IPDeviceName,(int)maxchars);
         return asynError;
     }
+    /* Characters left over from an earlier read are returned without any system call */
+    if (tty->readAheadCount > 0) {
+        thisRead = (int)takeReadAhead(tty, data, maxchars);
+        tty->nReadAhead++;
+        asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
+                    "%s read %d from read-ahead buffer\n", tty->IPDeviceName, thisRead);
+        *nbytesTransfered = thisRead;
+        if (thisRead < (int) maxchars)
+            data[thisRead] = 0;
+        else
+            reason |= ASYN_EOM_CNT;
+        if (gotEom) *gotEom = reason;
+        return asynSuccess;
+    }
     readPollmsec = (int) (pasynUser->timeout * 1000.0);
     if (readPollmsec == 0) readPollmsec = 1;
     if (readPollmsec < 0) readPollmsec = -1;
 #ifdef USE_SOCKTIMEOUT
-    {
+    /* Only change the socket timeout when the caller's timeout changes */
+    if (readPollmsec != tty->recvTimeoutMsec) {
     struct timeval tv;
     tv.tv_sec = readPollmsec / 1000;
     tv.tv_usec = (readPollmsec % 1000) * 1000;
+    tty->nSocketCalls++;
     if (setsockopt(tty->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv) < 0) {
         epicsSocketConvertErrnoToString(sockerrmsg, sizeof(sockerrmsg));
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
@@ -766,15 +1010,21 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
                       tty->IPDeviceName, sockerrmsg);
         status = asynError;
     }
+    else {
+        tty->recvTimeoutMsec = readPollmsec;
+    }
     }
 #endif
     if (gotEom) *gotEom = 0;
+    thisRead = receiveIt(tty, pasynUser, data, maxchars);
 #ifdef USE_POLL
-    {
+    if ((thisRead < 0) && (SOCKERRNO == SOCK_EWOULDBLOCK)) {
+        /* Nothing was waiting in the non-blocking socket, wait for input */
         struct pollfd pollfd;
         pollfd.fd = tty->fd;
         pollfd.events = POLLIN;
         epicsTimeGetCurrent(&startTime);
+        tty->nSocketCalls++;
         while (poll(&pollfd, 1, readPollmsec) < 0) {
             if (SOCKERRNO != SOCK_EINTR) {
                 epicsSocketConvertErrnoToString(sockerrmsg, sizeof(sockerrmsg));
@@ -785,31 +1035,9 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
             epicsTimeGetCurrent(&endTime);
             if (epicsTimeDiffInSeconds(&endTime, &startTime)*1000. > readPollmsec) break;
         }
+        thisRead = receiveIt(tty, pasynUser, data, maxchars);
     }
 #endif
-    if (tty->socketType == SOCK_DGRAM) {
-        /* We use recvfrom() for SOCK_DRAM so we can print the source address with ASYN_TRACEIO_DRIVER */
-        osiSockAddr oa;
-        unsigned int addrlen = sizeof(oa.ia);
-        thisRead = recvfrom(tty->fd, data, (int)maxchars, 0, &oa.sa, &addrlen);
-        if (thisRead >= 0) {
-            if (pasynTrace->getTraceMask(pasynUser) & ASYN_TRACEIO_DRIVER) {
-                char inetBuff[32];
-                ipAddrToDottedIP(&oa.ia, inetBuff, sizeof(inetBuff));
-                asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
-                          "%s (from %s) read %d\n",
-                          tty->IPDeviceName, inetBuff, thisRead);
-            }
-            tty->nRead += (unsigned long)thisRead;
-        }
-    } else {
-        thisRead = recv(tty->fd, data, (int)maxchars, 0);
-        if (thisRead >= 0) {
-            asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
-                        "%s read %d\n", tty->IPDeviceName, thisRead);
-            tty->nRead += (unsigned long)thisRead;
-        }
-    }
     if (thisRead < 0) {
         int should_disconnect = (((tty->disconnectOnReadTimeout) && (pasynUser->timeout > 0)) ||
                                  ((SOCKERRNO != SOCK_EWOULDBLOCK) && (SOCKERRNO != SOCK_EINTR)));
@@ -847,6 +1075,291 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
     return status;
 }
 
+/*
+ * Queue a frame for the stream callback thread.
+ * If the queue is full the frame is discarded and counted as an overrun.
+ */
+static void queueFrame(ttyController_t *tty, streamFrame_t *pframe, size_t nbytes, int eomReason)
+{
+    pframe->nbytes = nbytes;
+    pframe->eomReason = eomReason;
+    if (epicsMessageQueueTrySend(tty->streamQueue, pframe, sizeof(*pframe) + nbytes) != 0) {
+        tty->nStreamOverruns++;
+        asynPrint(tty->streamUser, ASYN_TRACE_WARNING,
+                  "%s stream queue full, %lu characters discarded\n",
+                  tty->IPDeviceName, (unsigned long)nbytes);
+        return;
+    }
+    tty->nStreamFrames++;
+}
+
+/*
+ * Returns 1 once stopStreamThreads has asked the stream threads to exit
+ */
+static int streamShutdownRequested(ttyController_t *tty)
+{
+    int shutdown;
+
+    epicsMutexMustLock(tty->streamLock);
+    shutdown = tty->streamShutdown;
+    epicsMutexUnlock(tty->streamLock);
+    return shutdown;
+}
+
+/*
+ * Stream reader thread.
+ * Reads input as it arrives and splits it into frames at the input EOS of
+ * the port or, if there is none, every streamFrameSize characters.
+ * It is parked on streamEvent while streaming is disabled or the port is
+ * not connected.
+ */
+static void streamReadThread(void *arg)
+{
+    ttyController_t *tty = (ttyController_t *)arg;
+    asynUser *pasynUser = tty->streamUser;
+    asynOctet *pasynOctet = (asynOctet *)tty->pstreamOctet->pinterface;
+    streamFrame_t *pframe;
+    char *frame;
+    size_t nFrame = 0;
+    char buffer[STREAM_READ_SIZE];
+    size_t nRead, i;
+    char eos[2];
+    int eosLen;
+    int eomReason;
+    asynStatus status;
+
+    pframe = mallocMustSucceed(sizeof(*pframe) + tty->streamFrameSize,
+                               "drvAsynIPPort:streamReadThread");
+    frame = (char *)(pframe + 1);
+    while (!streamShutdownRequested(tty)) {
+        if (pasynManager->lockPort(pasynUser) != asynSuccess) {
+            epicsThreadSleep(STREAM_POLL_DELAY);
+            continue;
+        }
+        if (!tty->streamEnabled || (tty->fd == INVALID_SOCKET)) {
+            pasynManager->unlockPort(pasynUser);
+            nFrame = 0;
+            /* setOption, connectIt and stopStreamThreads signal streamEvent */
+            epicsEventMustWait(tty->streamEvent);
+            continue;
+        }
+        /* Wait for input without holding the port lock. streamLock keeps
+         * closeConnection from closing the socket until the wait is over. */
+#ifdef USE_POLL
+        {
+        struct pollfd pollfd;
+        int ready;
+        pollfd.fd = tty->fd;
+        pollfd.events = POLLIN;
+        epicsMutexMustLock(tty->streamLock);
+        pasynManager->unlockPort(pasynUser);
+        ready = poll(&pollfd, 1, (int)(STREAM_POLL_DELAY * 1000.0));
+        epicsMutexUnlock(tty->streamLock);
+        if (ready <= 0)
+            continue;
+        }
+#else
+        pasynManager->unlockPort(pasynUser);
+        epicsThreadSleep(STREAM_POLL_DELAY);
+#endif
+        if (pasynManager->lockPort(pasynUser) != asynSuccess) {
+            epicsThreadSleep(STREAM_POLL_DELAY);
+            continue;
+        }
+        if (!tty->streamEnabled || (tty->fd == INVALID_SOCKET)) {
+            pasynManager->unlockPort(pasynUser);
+            continue;
+        }
+        if (pasynOctet->getInputEos(tty->pstreamOctet->drvPvt, pasynUser,
+                                    eos, sizeof(eos), &eosLen) != asynSuccess)
+            eosLen = 0;
+        pasynUser->timeout = 0;
+        nRead = 0;
+        eomReason = 0;
+        status = readIt(tty, pasynUser, buffer, sizeof(buffer), &nRead, &eomReason);
+        pasynManager->unlockPort(pasynUser);
+        if ((status == asynError) && (nRead == 0))
+            nFrame = 0;
+        for (i = 0; i < nRead; i++) {
+            frame[nFrame++] = buffer[i];
+            if ((eosLen > 0) && (nFrame >= (size_t)eosLen) &&
+                (memcmp(frame + nFrame - eosLen, eos, eosLen) == 0)) {
+                queueFrame(tty, pframe, nFrame - eosLen, ASYN_EOM_EOS);
+                nFrame = 0;
+            }
+            else if (nFrame == tty->streamFrameSize) {
+                queueFrame(tty, pframe, nFrame, ASYN_EOM_CNT);
+                nFrame = 0;
+            }
+        }
+        /* The peer closed the connection, pass on what is left */
+        if ((eomReason & ASYN_EOM_END) && (nFrame > 0)) {
+            queueFrame(tty, pframe, nFrame, ASYN_EOM_END);
+            nFrame = 0;
+        }
+    }
+    free(pframe);
+    epicsEventSignal(tty->streamReadExited);
+}
+
+/*
+ * Stream callback thread.
+ * Calls the asynOctet interrupt users for each queued frame.
+ * It waits on the queue until stopStreamThreads sends an empty message.
+ */
+static void streamCallbackThread(void *arg)
+{
+    ttyController_t *tty = (ttyController_t *)arg;
+    epicsMessageQueueId queue = tty->streamQueue;
+    size_t msgSize = sizeof(streamFrame_t) + tty->streamFrameSize;
+    streamFrame_t *pframe;
+    char *data;
+    size_t nbytes;
+    int eomReason;
+
+    /* One extra character for a terminating null */
+    pframe = mallocMustSucceed(msgSize + 1, "drvAsynIPPort:streamCallbackThread");
+    data = (char *)(pframe + 1);
+    while (epicsMessageQueueReceive(queue, pframe, (unsigned)msgSize) >= (int)sizeof(*pframe)) {
+        nbytes = pframe->nbytes;
+        eomReason = pframe->eomReason;
+        data[nbytes] = 0;
+        asynPrintIORead(tty->streamCallbackUser, ASYN_TRACEIO_FILTER, data, nbytes,
+                    "%s stream frame %lu\n", tty->IPDeviceName, (unsigned long)nbytes);
+        pasynOctetBase->callInterruptUsers(tty->streamCallbackUser, tty->octetInterruptPvt,
+                                           data, &nbytes, &eomReason);
+    }
+    free(pframe);
+    epicsEventSignal(tty->streamCallbackExited);
+}
+
+/*
+ * Wait for one stream thread to exit
+ */
+static void waitStreamThread(ttyController_t *tty, int *prunning, epicsEventId exited)
+{
+    if (!*prunning) return;
+    if (epicsEventWaitWithTimeout(exited, STREAM_EXIT_TIMEOUT) != epicsEventWaitOK) {
+        asynPrint(tty->pasynUser, ASYN_TRACE_ERROR,
+                  "%s: stream thread did not exit\n", tty->portName);
+        return;
+    }
+    *prunning = 0;
+}
+
+/*
+ * Stop the stream threads and wait for them to exit.
+ * Must be called without the port lock, which the stream reader takes.
+ */
+static void stopStreamThreads(ttyController_t *tty)
+{
+    char wakeup = 0;
+
+    if (!tty->streamReadRunning && !tty->streamCallbackRunning) return;
+    epicsMutexMustLock(tty->streamLock);
+    tty->streamShutdown = 1;
+    epicsMutexUnlock(tty->streamLock);
+    epicsEventSignal(tty->streamEvent);
+    if (tty->streamCallbackRunning)
+        epicsMessageQueueSendWithTimeout(tty->streamQueue, &wakeup, 0, STREAM_EXIT_TIMEOUT);
+    waitStreamThread(tty, &tty->streamReadRunning, tty->streamReadExited);
+    waitStreamThread(tty, &tty->streamCallbackRunning, tty->streamCallbackExited);
+}
+
+/*
+ * Free what startStream created. The stream threads must have exited.
+ */
+static void freeStream(ttyController_t *tty)
+{
+    if (tty->streamUser) pasynManager->freeAsynUser(tty->streamUser);
+    if (tty->streamCallbackUser) pasynManager->freeAsynUser(tty->streamCallbackUser);
+    if (tty->streamEvent) epicsEventDestroy(tty->streamEvent);
+    if (tty->streamReadExited) epicsEventDestroy(tty->streamReadExited);
+    if (tty->streamCallbackExited) epicsEventDestroy(tty->streamCallbackExited);
+    if (tty->streamQueue) epicsMessageQueueDestroy(tty->streamQueue);
+    if (tty->streamLock) epicsMutexDestroy(tty->streamLock);
+    tty->streamUser = NULL;
+    tty->streamCallbackUser = NULL;
+    tty->streamEvent = NULL;
+    tty->streamReadExited = NULL;
+    tty->streamCallbackExited = NULL;
+    tty->streamQueue = NULL;
+    tty->streamLock = NULL;
+    tty->pstreamOctet = NULL;
+}
+
+/*
+ * Create the stream queue and threads the first time streaming is enabled.
+ * Called with the port lock. A failed attempt leaves the port as it was
+ * and can be retried.
+ */
+static asynStatus startStream(ttyController_t *tty, asynUser *pasynUser)
+{
+    char threadName[64];
+    asynStatus status;
+
+    if (tty->streamReadRunning || tty->streamCallbackRunning) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s stream threads from an earlier attempt are still running", tty->portName);
+        return asynError;
+    }
+    status = pasynManager->getInterruptPvt(pasynUser, asynOctetType, &tty->octetInterruptPvt);
+    if (status != asynSuccess) return status;
+    tty->pstreamOctet = pasynManager->findInterface(pasynUser, asynOctetType, 1);
+    if (!tty->pstreamOctet) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s can't find asynOctet interface", tty->portName);
+        return asynError;
+    }
+    tty->streamUser = pasynManager->createAsynUser(0,0);
+    tty->streamCallbackUser = pasynManager->createAsynUser(0,0);
+    if ((pasynManager->connectDevice(tty->streamUser, tty->portName, -1) != asynSuccess) ||
+        (pasynManager->connectDevice(tty->streamCallbackUser, tty->portName, -1) != asynSuccess)) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s stream connectDevice failed", tty->portName);
+        freeStream(tty);
+        return asynError;
+    }
+    tty->streamQueue = epicsMessageQueueCreate(tty->streamQueueSize,
+                                    (int)(sizeof(streamFrame_t) + tty->streamFrameSize));
+    if (!tty->streamQueue) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s can't create stream queue", tty->portName);
+        freeStream(tty);
+        return asynError;
+    }
+    tty->streamLock = epicsMutexMustCreate();
+    tty->streamEvent = epicsEventMustCreate(epicsEventEmpty);
+    tty->streamReadExited = epicsEventMustCreate(epicsEventEmpty);
+    tty->streamCallbackExited = epicsEventMustCreate(epicsEventEmpty);
+    tty->streamShutdown = 0;
+    /* The reader is created last. If it can't be created only the callback
+     * thread, which does not take the port lock, has to be stopped, which can
+     * be done while setOption holds the port lock. */
+    epicsSnprintf(threadName, sizeof(threadName), "%sStreamCB", tty->portName);
+    if (!epicsThreadCreate(threadName, epicsThreadPriorityMedium,
+                           epicsThreadGetStackSize(epicsThreadStackMedium),
+                           streamCallbackThread, tty)) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s can't create stream callback thread", tty->portName);
+        freeStream(tty);
+        return asynError;
+    }
+    tty->streamCallbackRunning = 1;
+    epicsSnprintf(threadName, sizeof(threadName), "%sStream", tty->portName);
+    if (!epicsThreadCreate(threadName, epicsThreadPriorityMedium,
+                           epicsThreadGetStackSize(epicsThreadStackMedium),
+                           streamReadThread, tty)) {
+        epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                      "%s can't create stream reader thread", tty->portName);
+        stopStreamThreads(tty);
+        if (!tty->streamCallbackRunning) freeStream(tty);
+        return asynError;
+    }
+    tty->streamReadRunning = 1;
+    return asynSuccess;
+}
+
 /*
  * Flush pending input
  */
@@ -859,6 +1372,8 @@ flushIt(void *drvPvt,asynUser *pasynUser)
 
     assert(tty);
     asynPrint(pasynUser, ASYN_TRACE_FLOW, "%s flush\n", tty->IPDeviceName);
+    numTotal = (int)tty->readAheadCount;
+    tty->readAheadCount = 0;
     if (tty->fd != INVALID_SOCKET) {
         /*
          * Toss characters until there are none left
@@ -867,6 +1382,7 @@ flushIt(void *drvPvt,asynUser *pasynUser)
         setNonBlock(tty->fd, 1);
 #endif
         while (1) {
+            tty->nSocketCalls++;
             numRecv = recv(tty->fd, cbuf, sizeof cbuf, 0);
             if (numRecv <= 0) break;
             numTotal += numRecv;
@@ -893,6 +1409,7 @@ ttyCleanup(ttyController_t *tty)
         free(tty->portName);
         free(tty->IPDeviceName);
         free(tty->IPHostName);
+        free(tty->readAheadBuffer);
         free(tty);
     }
 }
@@ -915,6 +1432,27 @@ getOption(void *drvPvt, asynUser *pasynUser,
     else if (epicsStrCaseCmp(key, "hostInfo") == 0) {
         l = epicsSnprintf(val, valSize, "%s", tty->IPDeviceName);
     }
+    else if (epicsStrCaseCmp(key, "readAheadSize") == 0) {
+        l = epicsSnprintf(val, valSize, "%lu", (unsigned long)tty->readAheadSize);
+    }
+    else if (epicsStrCaseCmp(key, "socketCalls") == 0) {
+        l = epicsSnprintf(val, valSize, "%lu", tty->nSocketCalls);
+    }
+    else if (epicsStrCaseCmp(key, "stream") == 0) {
+        l = epicsSnprintf(val, valSize, "%c", tty->streamEnabled ? 'Y' : 'N');
+    }
+    else if (epicsStrCaseCmp(key, "streamFrameSize") == 0) {
+        l = epicsSnprintf(val, valSize, "%lu", (unsigned long)tty->streamFrameSize);
+    }
+    else if (epicsStrCaseCmp(key, "streamQueueSize") == 0) {
+        l = epicsSnprintf(val, valSize, "%d", tty->streamQueueSize);
+    }
+    else if (epicsStrCaseCmp(key, "streamFrames") == 0) {
+        l = epicsSnprintf(val, valSize, "%lu", tty->nStreamFrames);
+    }
+    else if (epicsStrCaseCmp(key, "streamOverruns") == 0) {
+        l = epicsSnprintf(val, valSize, "%lu", tty->nStreamOverruns);
+    }
     else {
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
                                                 "Unsupported key \"%s\"", key);
@@ -954,6 +1492,71 @@ setOption(void *drvPvt, asynUser *pasynUser, const char *key, const char *val)
         int status = parseHostInfo(tty, val);
         if (status) return asynError;
     }
+    else if (epicsStrCaseCmp(key, "readAheadSize") == 0) {
+        int size;
+        char *buffer = NULL;
+        if ((sscanf(val, "%d", &size) != 1) || (size < 0)) {
+            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                                                    "Invalid readAheadSize value.");
+            return asynError;
+        }
+        if ((size_t)size < tty->readAheadCount) {
+            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                          "readAheadSize %d is less than the %lu characters buffered.",
+                          size, (unsigned long)tty->readAheadCount);
+            return asynError;
+        }
+        if (size > 0) {
+            buffer = mallocMustSucceed(size, "drvAsynIPPort:setOption");
+            memcpy(buffer, tty->readAheadBuffer + tty->readAheadHead, tty->readAheadCount);
+        }
+        free(tty->readAheadBuffer);
+        tty->readAheadBuffer = buffer;
+        tty->readAheadSize = size;
+        tty->readAheadHead = 0;
+    }
+    else if (epicsStrCaseCmp(key, "stream") == 0) {
+        if (epicsStrCaseCmp(val, "Y") == 0) {
+            if (tty->isCom == 1) {
+                /* The stream reader reads the socket directly, below asynInterposeCOM,
+                 * so the frames would contain the telnet protocol */
+                epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                              "%s streaming is not supported with the COM protocol", tty->portName);
+                return asynError;
+            }
+            if (!tty->streamReadRunning && (startStream(tty, pasynUser) != asynSuccess))
+                return asynError;
+            tty->streamEnabled = 1;
+            epicsEventSignal(tty->streamEvent);
+        }
+        else if (epicsStrCaseCmp(val, "N") == 0) {
+            /* The stream reader parks when it next takes the port lock */
+            tty->streamEnabled = 0;
+        }
+        else {
+            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                                                    "Invalid stream value.");
+            return asynError;
+        }
+    }
+    else if ((epicsStrCaseCmp(key, "streamFrameSize") == 0) ||
+             (epicsStrCaseCmp(key, "streamQueueSize") == 0)) {
+        int size;
+        if ((sscanf(val, "%d", &size) != 1) || (size <= 0)) {
+            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                                                    "Invalid %s value.", key);
+            return asynError;
+        }
+        if (tty->streamQueue) {
+            epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
+                          "%s can't be changed after streaming has been enabled.", key);
+            return asynError;
+        }
+        if (epicsStrCaseCmp(key, "streamFrameSize") == 0)
+            tty->streamFrameSize = size;
+        else
+            tty->streamQueueSize = size;
+    }
     else if (epicsStrCaseCmp(key, "") != 0) {
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
                                                 "Unsupported key \"%s\"", key);
@@ -962,6 +1565,9 @@ setOption(void *drvPvt, asynUser *pasynUser, const char *key, const char *val)
     return asynSuccess;
 }
 static const struct asynOption asynOptionMethods = { setOption, getOption };
+#ifdef HAS_SENDMSG
+static const struct asynOctetSegments asynOctetSegmentsMethods = { writeSegmentsIt };
+#endif
 
 /*
  * asynCommon methods
@@ -973,14 +1579,16 @@ static const struct asynCommon drvAsynIPPortAsynCommon = {
 };
 
 /*
- * Configure and register the drvAsynIPPort driver
+ * Configure and register the drvAsynIPPort driver.
+ * If sharedThread is non-zero the port is processed by the shared port thread pool.
 */
 ASYN_API int
-drvAsynIPPortConfigure(const char *portName,
-                       const char *hostInfo,
-                       unsigned int priority,
-                       int noAutoConnect,
-                       int noProcessEos)
+drvAsynIPPortConfigureShared(const char *portName,
+                             const char *hostInfo,
+                             unsigned int priority,
+                             int noAutoConnect,
+                             int noProcessEos,
+                             int sharedThread)
 {
     ttyController_t *tty;
     asynInterface *pasynInterface;
@@ -1021,6 +1629,8 @@ drvAsynIPPortConfigure(const char *portName,
     tty->portName = epicsStrDup(portName);
     tty->fd = INVALID_SOCKET;
     tty->isCom =  ISCOM_UNKNOWN;
+    tty->streamFrameSize = STREAM_FRAME_SIZE;
+    tty->streamQueueSize = STREAM_QUEUE_SIZE;
 
     /*
      * Create socket from hostInfo
@@ -1042,7 +1652,7 @@ drvAsynIPPortConfigure(const char *portName,
     tty->option.pinterface  = (void *)&asynOptionMethods;
     tty->option.drvPvt = tty;
     if (pasynManager->registerPort(tty->portName,
-                                   ASYN_CANBLOCK,
+                                   ASYN_CANBLOCK | (sharedThread ? ASYN_SHAREDTHREAD : 0),
                                    !noAutoConnect,
                                    priority,
                                    0) != asynSuccess) {
@@ -1065,6 +1675,17 @@ drvAsynIPPortConfigure(const char *portName,
     pasynOctet->read = readIt;
     pasynOctet->write = writeIt;
     pasynOctet->flush = flushIt;
+#ifdef HAS_SENDMSG
+    tty->octetSegments.interfaceType = asynOctetSegmentsType;
+    tty->octetSegments.pinterface  = (void *)&asynOctetSegmentsMethods;
+    tty->octetSegments.drvPvt = tty;
+    status = pasynManager->registerInterface(tty->portName,&tty->octetSegments);
+    if(status != asynSuccess) {
+        printf("drvAsynIPPortConfigure: Can't register octetSegments.\n");
+        ttyCleanup(tty);
+        return -1;
+    }
+#endif
     tty->octet.interfaceType = asynOctetType;
     tty->octet.pinterface  = pasynOctet;
     tty->octet.drvPvt = tty;
@@ -1095,6 +1716,20 @@ drvAsynIPPortConfigure(const char *portName,
     return 0;
 }
 
+/*
+ * The original interface, the port gets a port thread of its own
+ */
+ASYN_API int
+drvAsynIPPortConfigure(const char *portName,
+                       const char *hostInfo,
+                       unsigned int priority,
+                       int noAutoConnect,
+                       int noProcessEos)
+{
+    return drvAsynIPPortConfigureShared(portName, hostInfo, priority,
+                                        noAutoConnect, noProcessEos, 0);
+}
+
 /*
  * IOC shell command registration
  */
@@ -1103,16 +1738,17 @@ static const iocshArg drvAsynIPPortConfigureArg1 = { "host:port [protocol]",iocs
 static const iocshArg drvAsynIPPortConfigureArg2 = { "priority",iocshArgInt};
 static const iocshArg drvAsynIPPortConfigureArg3 = { "disable auto-connect",iocshArgInt};
 static const iocshArg drvAsynIPPortConfigureArg4 = { "noProcessEos",iocshArgInt};
+static const iocshArg drvAsynIPPortConfigureArg5 = { "shared thread",iocshArgInt};
 static const iocshArg *drvAsynIPPortConfigureArgs[] = {
     &drvAsynIPPortConfigureArg0, &drvAsynIPPortConfigureArg1,
     &drvAsynIPPortConfigureArg2, &drvAsynIPPortConfigureArg3,
-    &drvAsynIPPortConfigureArg4};
+    &drvAsynIPPortConfigureArg4, &drvAsynIPPortConfigureArg5};
 static const iocshFuncDef drvAsynIPPortConfigureFuncDef =
-                      {"drvAsynIPPortConfigure",5,drvAsynIPPortConfigureArgs};
+                      {"drvAsynIPPortConfigure",6,drvAsynIPPortConfigureArgs};
 static void drvAsynIPPortConfigureCallFunc(const iocshArgBuf *args)
 {
-    drvAsynIPPortConfigure(args[0].sval, args[1].sval, args[2].ival,
-                           args[3].ival, args[4].ival);
+    drvAsynIPPortConfigureShared(args[0].sval, args[1].sval, args[2].ival,
+                                 args[3].ival, args[4].ival, args[5].ival);
 }
 
 /*
@@ -24,6 +24,12 @@ ASYN_API int drvAsynIPPortConfigure(const char *portName,
                                           unsigned int priority,
                                           int noAutoConnect,
                                           int userFlags);
+ASYN_API int drvAsynIPPortConfigureShared(const char *portName,
+                                          const char *hostInfo,
+                                          unsigned int priority,
+                                          int noAutoConnect,
+                                          int noProcessEos,
+                                          int sharedThread);
 
 #ifdef __cplusplus
 }
@@ -208,7 +208,7 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
         }
     }
     if (thisRead > 0) {
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
+        asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
                 "%s read %d\n", tty->IPDeviceName, thisRead);
         tty->nRead += thisRead;
     }
@@ -48,10 +48,14 @@
 # define CSTOPB STOPB
 #else
 # include <termios.h>
+# include <sys/uio.h>
 #endif
 
 #include "serial_rs485.h"
 
+/* Largest number of segments written by one writev() call */
+#define MAX_SEGMENTS 16
+
 #ifdef vxWorks
 /*
  * Fake termios structure
@@ -86,6 +90,7 @@ typedef struct {
     asynInterface      common;
     asynInterface      option;
     asynInterface      octet;
+    asynInterface      octetSegments;
 } ttyController_t;
 
 typedef struct serialBase {
@@ -781,23 +786,54 @@ disconnect(void *drvPvt, asynUser *pasynUser)
 }
 
 
+/*
+ * Write the segments, starting offset characters into the first one
+ */
+static int writeSegmentData(ttyController_t *tty, const asynOctetSegment *segments,
+    int nsegments, size_t offset)
+{
+#ifndef vxWorks
+    if (nsegments > 1) {
+        struct iovec iov[MAX_SEGMENTS];
+        int i;
+
+        if (nsegments > MAX_SEGMENTS) nsegments = MAX_SEGMENTS;
+        for (i=0; i<nsegments; i++) {
+            iov[i].iov_base = (char *)segments[i].data;
+            iov[i].iov_len = segments[i].numchars;
+        }
+        iov[0].iov_base = (char *)segments[0].data + offset;
+        iov[0].iov_len -= offset;
+        return writev(tty->fd, iov, nsegments);
+    }
+#endif
+    return write(tty->fd, (char *)segments[0].data + offset,
+                 segments[0].numchars - offset);
+}
+
 /*
  * Write to the serial line
  */
-static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
-    const char *data, size_t numchars,size_t *nbytesTransfered)
+static asynStatus writeSegmentsIt(void *drvPvt, asynUser *pasynUser,
+    const asynOctetSegment *segments, int nsegments, size_t *nbytesTransfered)
 {
     ttyController_t *tty = (ttyController_t *)drvPvt;
     int thisWrite;
-    int nleft = numchars;
+    size_t numchars = 0;
+    size_t offset = 0;
+    int nleft;
     int timerStarted = 0;
+    int i;
     asynStatus status = asynSuccess;
 
     assert(tty);
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
                             "%s write.\n", tty->serialDeviceName);
-    asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
-                            "%s write %lu\n", tty->serialDeviceName, (unsigned long)numchars);
+    for (i=0; i<nsegments; i++) {
+        asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, segments[i].data, segments[i].numchars,
+                            "%s write %lu\n", tty->serialDeviceName, (unsigned long)segments[i].numchars);
+        numchars += segments[i].numchars;
+    }
     if (tty->fd < 0) {
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
                                 "%s disconnected:", tty->serialDeviceName);
@@ -828,6 +864,11 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
     }
     tty->timeoutFlag = 0;
     nleft = numchars;
+    /* Empty segments are skipped */
+    while (segments->numchars == 0) {
+        segments++;
+        nsegments--;
+    }
 #ifdef vxWorks
     if (tty->writeTimeout >= 0)
 #else
@@ -838,13 +879,18 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
         timerStarted = 1;
         }
     for (;;) {
-        thisWrite = write(tty->fd, (char *)data, nleft);
+        thisWrite = writeSegmentData(tty, segments, nsegments, offset);
         if (thisWrite > 0) {
             tty->nWritten += thisWrite;
             nleft -= thisWrite;
             if (nleft == 0)
                 break;
-            data += thisWrite;
+            offset += thisWrite;
+            while (offset >= segments->numchars) {
+                offset -= segments->numchars;
+                segments++;
+                nsegments--;
+            }
         }
         if (tty->timeoutFlag || (tty->writeTimeout == 0)) {
             status = asynTimeout;
@@ -888,6 +934,16 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
     return status;
 }
 
+static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
+    const char *data, size_t numchars,size_t *nbytesTransfered)
+{
+    asynOctetSegment segment;
+
+    segment.data = data;
+    segment.numchars = numchars;
+    return writeSegmentsIt(drvPvt, pasynUser, &segment, 1, nbytesTransfered);
+}
+
 /*
  * Read from the serial line
  */
@@ -983,7 +1039,7 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
         }
         thisRead = read(tty->fd, data, maxchars);
         if (thisRead > 0) {
-            asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
+            asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, thisRead,
                        "%s read %d\n", tty->serialDeviceName, thisRead);
             nRead = thisRead;
             tty->nRead += thisRead;
@@ -1041,6 +1097,7 @@ flushIt(void *drvPvt,asynUser *pasynUser)
 }
 
 static asynOctet asynOctetMethods = { writeIt, readIt, flushIt };
+static asynOctetSegments asynOctetSegmentsMethods = { writeSegmentsIt };
 
 /*
  * Clean up a ttyController
@@ -1159,6 +1216,15 @@ drvAsynSerialPortConfigure(const char *portName,
         ttyCleanup(tty);
         return -1;
     }
+    tty->octetSegments.interfaceType = asynOctetSegmentsType;
+    tty->octetSegments.pinterface  = &asynOctetSegmentsMethods;
+    tty->octetSegments.drvPvt = tty;
+    status = pasynManager->registerInterface(tty->portName,&tty->octetSegments);
+    if(status != asynSuccess) {
+        printf("drvAsynSerialPortConfigure: Can't register octetSegments.\n");
+        ttyCleanup(tty);
+        return -1;
+    }
     tty->octet.interfaceType = asynOctetType;
     tty->octet.pinterface  = &asynOctetMethods;
     tty->octet.drvPvt = tty;
@@ -963,7 +963,7 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
     assert(tty);
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
                             "%s write.\n", tty->serialDeviceName);
-    asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
+    asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
                             "%s write %d\n", tty->serialDeviceName, numchars);
     if (tty->commHandle == INVALID_HANDLE_VALUE) {
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
@@ -1279,7 +1279,7 @@ static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
         }
     }
     if (nRead > 0) {
-            asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, nRead,
+            asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, nRead,
                        "%s read %d\n", tty->serialDeviceName, nRead);
             tty->nRead += nRead;
     } else if (status == asynSuccess) {
@@ -769,7 +769,7 @@ asynOctetWrite(void *pvt, asynUser *pasynUser,
         pkSend = nSend + BULK_IO_HEADER_SIZE;
         while (pkSend & 0x3)
             pdpvt->buf[pkSend++] = 0;
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, (const char *)pdpvt->buf,
+        asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, (const char *)pdpvt->buf,
                                                     pkSend, "Send %d: ", pkSend);
         s = libusb_bulk_transfer(pdpvt->handle, pdpvt->bulkOutEndpointAddress,
                                       pdpvt->buf, pkSend, &pkSent, timeout);
@@ -868,7 +868,7 @@ asynOctetRead(void *pvt, asynUser *pasynUser,
         pdpvt->buf[11] = 0;
         bTag = pdpvt->bTag;
         pdpvt->bTag = (pdpvt->bTag == 0xFF) ? 0x1 : pdpvt->bTag + 1;
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, (const char *)pdpvt->buf,
+        asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, (const char *)pdpvt->buf,
                             BULK_IO_HEADER_SIZE,
                             "Request %d, command: ", BULK_IO_PAYLOAD_CAPACITY);
         s = libusb_bulk_transfer(pdpvt->handle, pdpvt->bulkOutEndpointAddress,
@@ -891,7 +891,7 @@ asynOctetRead(void *pvt, asynUser *pasynUser,
                                     "Bulk read failed: %s", libusb_strerror(s));
             return asynError;
         }
-        asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, (const char *)pdpvt->buf,
+        asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, (const char *)pdpvt->buf,
                         ioCount, "Read %d, flags %#x: ", ioCount, pdpvt->buf[8]);
 
         /*
@@ -358,7 +358,7 @@ prologixRead(void *drvPvt, asynUser *pasynUser,
      pdpvt->bufIndex += n;
     if (eomReason) *eomReason = eom;
     *nbytesTransfered = n;
-    asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, n,
+    asynPrintIORead(pasynUser, ASYN_TRACEIO_DRIVER, data, n,
                                 "%s %d prologixRead %d EOM:%#x\n",
                                 pdpvt->portName, pdpvt->lastAddress, (int)n, eom);
     return asynSuccess;
@@ -391,7 +391,7 @@ prologixWrite(void *drvPvt, asynUser *pasynUser,
     /*
      * Create command string
      */
-    asynPrintIO(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
+    asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DRIVER, data, numchars,
                  "%s %d prologixWrite\n", pdpvt->portName, pdpvt->lastAddress);
     n = numchars;
     pdpvt->bufCount = 0;
@@ -607,7 +607,7 @@ static asynStatus gpibPortRead(void *pdrvPvt,asynUser *pasynUser,
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
             "%s readGpib failed %s",pgsport->portName,pgsport->errorMessage);
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DRIVER,
         data,actual,"%s addr %d gpibPortRead\n",pgsport->portName,addr);
     *nbytesTransfered = actual;
     return status;
@@ -636,7 +636,7 @@ static asynStatus gpibPortWrite(void *pdrvPvt,asynUser *pasynUser,
             "%s requested %d but sent %d bytes",pgsport->portName,numchars,actual);
         status = asynError;
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         data,actual,"%s addr %d gpibPortWrite\n",pgsport->portName,addr);
     *nbytesTransfered = actual;
     return status;
@@ -720,7 +720,7 @@ static asynStatus gpibPortAddressedCmd(void *pdrvPvt,asynUser *pasynUser,
             "%s writeGpib failed %s",pgsport->portName,pgsport->errorMessage);
     }
     actual = length - pgsport->bytesRemainingCmd;
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         data,actual,"%s gpibPortAddressedCmd\n",pgsport->portName);
     if(status!=asynSuccess) return status;
     writeCmd(pgsport,(char *)cmdbuf,2,timeout,transferStateIdle);
@@ -743,7 +743,7 @@ static asynStatus gpibPortUniversalCmd(void *pdrvPvt, asynUser *pasynUser, int c
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
             "%s writeGpib failed %s",pgsport->portName,pgsport->errorMessage);
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         buffer,1,"%s gpibPortUniversalCmd\n",pgsport->portName);
     return status;
 }
@@ -54,12 +54,33 @@ typedef struct asynOctet{
                     char *eos, int eossize, int *eoslen);
 }asynOctet;
 
+/* One piece of the data passed to asynOctetSegments:writeSegments */
+typedef struct asynOctetSegment {
+    const char *data;
+    size_t     numchars;
+}asynOctetSegment;
+
+/* Optional companion of asynOctet for writes that are not first copied
+ * into a single buffer. A layer that implements it registers it with the
+ * same drvPvt as its asynOctet, so a layer above only uses it if no other
+ * asynOctet has been interposed in between. */
+#define asynOctetSegmentsType "asynOctetSegments"
+typedef struct asynOctetSegments{
+    /* Writes the segments in order as one message.
+     * nbytesTransfered is the total for all segments. */
+    asynStatus (*writeSegments)(void *drvPvt,asynUser *pasynUser,
+                    const asynOctetSegment *segments,int nsegments,
+                    size_t *nbytesTransfered);
+}asynOctetSegments;
+
 /* asynOctetBase does the following:
    calls  registerInterface for asynOctet.
    Implements registerInterruptUser and cancelInterruptUser
    Provides default implementations of all methods.
    registerInterruptUser and cancelInterruptUser can be called
    directly rather than via queueRequest.
+   Passes asynOctetSegments through if the driver registered it,
+   with the same drvPvt, before calling initialize.
 */
 
 #define asynOctetBaseType "asynOctetBase"
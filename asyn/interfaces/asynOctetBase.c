@@ -35,6 +35,8 @@ typedef struct octetPvt {
     asynInterface octetBase; /*Implemented by asynOctetBase*/
     asynOctet     *pasynOctet; /* copy of driver with defaults*/
     void          *drvPvt;
+    asynInterface segmentsBase; /*Implemented by asynOctetBase*/
+    asynOctetSegments *pasynOctetSegments; /* NULL if driver has none*/
     int           override;
     void          *pasynPvt;   /*For registerInterruptSource*/
     int           interruptProcess;
@@ -69,12 +71,15 @@ static asynStatus setOutputEos(void *drvPvt,asynUser *pasynUser,
                         const char *eos,int eoslen);
 static asynStatus getOutputEos(void *drvPvt,asynUser *pasynUser,
                        char *eos, int eossize, int *eoslen);
+static asynStatus writeSegments(void *drvPvt,asynUser *pasynUser,
+    const asynOctetSegment *segments,int nsegments,size_t *nbytesTransfered);
 
 static asynOctet octet = {
     writeIt,readIt,flushIt,
     registerInterruptUser,cancelInterruptUser,
     setInputEos,getInputEos,setOutputEos,getOutputEos
 };
+static asynOctetSegments octetSegments = {writeSegments};
 /*Implementation to replace null methods*/
 static asynStatus writeFail(void *drvPvt, asynUser *pasynUser,
     const char *data,size_t numchars,size_t *nbytesTransfered);
@@ -119,6 +124,25 @@ static void initOverride(octetPvt *poctetPvt, asynOctet *pasynOctet)
     poctetPvt->override = override;
 }
 
+/* Returns the asynOctetSegments that the driver registered with drvPvt, if any */
+static asynOctetSegments *findDriverSegments(const char *portName,void *drvPvt)
+{
+    asynOctetSegments *pasynOctetSegments = 0;
+    asynInterface     *pasynInterface;
+    asynUser          *pasynUser;
+
+    pasynUser = pasynManager->createAsynUser(0,0);
+    if(pasynManager->connectDevice(pasynUser,portName,-1)==asynSuccess) {
+        pasynInterface = pasynManager->findInterface(
+            pasynUser,asynOctetSegmentsType,1);
+        if(pasynInterface && pasynInterface->drvPvt==drvPvt)
+            pasynOctetSegments = (asynOctetSegments *)pasynInterface->pinterface;
+        pasynManager->disconnect(pasynUser);
+    }
+    pasynManager->freeAsynUser(pasynUser);
+    return pasynOctetSegments;
+}
+
 static asynStatus initialize(const char *portName,
     asynInterface *pdriver,
     int processEosIn,int processEosOut,
@@ -158,6 +182,15 @@ static asynStatus initialize(const char *portName,
     status = pasynManager->interposeInterface(
         portName,-1,&poctetPvt->octetBase,0);
     if(status!=asynSuccess) return status;
+    poctetPvt->pasynOctetSegments = findDriverSegments(portName,pdriver->drvPvt);
+    if(poctetPvt->pasynOctetSegments) {
+        poctetPvt->segmentsBase.interfaceType = asynOctetSegmentsType;
+        poctetPvt->segmentsBase.pinterface = &octetSegments;
+        poctetPvt->segmentsBase.drvPvt = poctetPvt;
+        status = pasynManager->interposeInterface(
+            portName,-1,&poctetPvt->segmentsBase,0);
+        if(status!=asynSuccess) return status;
+    }
     poctetPvt->interruptProcess = interruptProcess;
     if(interruptProcess) {
         status = pasynManager->registerInterruptSource(
@@ -221,6 +254,16 @@ static asynStatus writeIt(void *drvPvt, asynUser *pasynUser,
                       data,numchars,nbytesTransfered);
 }
 
+static asynStatus writeSegments(void *drvPvt,asynUser *pasynUser,
+    const asynOctetSegment *segments,int nsegments,size_t *nbytesTransfered)
+{
+    octetPvt          *poctetPvt = (octetPvt *)drvPvt;
+    asynOctetSegments *pasynOctetSegments = poctetPvt->pasynOctetSegments;
+
+    return pasynOctetSegments->writeSegments(poctetPvt->drvPvt,pasynUser,
+                      segments,nsegments,nbytesTransfered);
+}
+
 static asynStatus readIt(void *drvPvt, asynUser *pasynUser,
     char *data,size_t maxchars,size_t *nbytesTransfered,int *eomReason)
 {
@@ -255,7 +298,7 @@ static asynStatus flushIt(void *drvPvt,asynUser *pasynUser)
         pasynOctet->read(poctetPvt->drvPvt,pasynUser,
             buffer,sizeof(buffer),&nbytesTransfered,0);
         if(nbytesTransfered==0) break;
-        asynPrintIO(pasynUser,ASYN_TRACEIO_FILTER,
+        asynPrintIORead(pasynUser,ASYN_TRACEIO_FILTER,
             buffer,nbytesTransfered,"asynOctetBase:flush\n");
     }
     pasynUser->timeout = savetimeout;
@@ -192,7 +192,7 @@ static asynStatus writeIt(asynUser *pasynUser,
     status = pioPvt->pasynOctet->write(
         pioPvt->octetPvt,pasynUser,buffer,buffer_len,nbytesTransfered);
     if(status==asynSuccess) {
-         asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE,
+         asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DEVICE,
              buffer,buffer_len,"asynOctetSyncIO wrote:\n");
     }
     unlockStatus = pasynManager->queueUnlockPort(pasynUser);
@@ -218,7 +218,7 @@ static asynStatus readIt(asynUser *pasynUser,
     status = pioPvt->pasynOctet->read(
         pioPvt->octetPvt,pasynUser,buffer,buffer_len,nbytesTransfered,eomReason);
     if(status==asynSuccess) {
-         asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE,
+         asynPrintIORead(pasynUser, ASYN_TRACEIO_DEVICE,
              buffer,*nbytesTransfered,"asynOctetSyncIO read:\n");
     }
     unlockStatus = pasynManager->queueUnlockPort(pasynUser);
@@ -256,7 +256,7 @@ static asynStatus writeRead(asynUser *pasynUser,
     if(status!=asynSuccess) {
         goto bad;
     } else {
-         asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE,
+         asynPrintIOWrite(pasynUser, ASYN_TRACEIO_DEVICE,
              write_buffer,*nbytesOut,"asynOctetSyncIO wrote:\n");
     }
     status = pioPvt->pasynOctet->read(
@@ -264,7 +264,7 @@ static asynStatus writeRead(asynUser *pasynUser,
     if(status!=asynSuccess) {
         goto bad;
     } else {
-         asynPrintIO(pasynUser, ASYN_TRACEIO_DEVICE,
+         asynPrintIORead(pasynUser, ASYN_TRACEIO_DEVICE,
              read_buffer,*nbytesIn,"asynOctetSyncIO read:\n");
     }
     bad:
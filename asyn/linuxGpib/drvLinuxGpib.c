@@ -467,7 +467,7 @@ static asynStatus gpibRead(void *pdrvPvt,asynUser *pasynUser,char
         return status;
     }
 
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,data,ibcnt,"%s addr %d gpibPortRead\n",pGpibBoardPvt->portName,addr);
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DRIVER,data,ibcnt,"%s addr %d gpibPortRead\n",pGpibBoardPvt->portName,addr);
 
     /*if last response is shorter than previous*/
     if(ibcnt<maxchars) data[ibcnt] = 0;
@@ -521,7 +521,7 @@ static asynStatus gpibWrite(void *pdrvPvt,asynUser *pasynUser,
     /*ibcnt holds number of bytes transfered*/
     *nbytesTransfered=ibcnt;
 
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
                 data,ibcnt,"%s addr %d gpibPortWrite\n",pGpibBoardPvt->portName,addr);
 
     return status;
@@ -230,7 +230,7 @@ readIt(void *ppvt, asynUser *pasynUser,
         memmove(data, data + 1, nCheck);
     }
     if (unstuffed)
-        asynPrintIO(pasynUser, ASYN_TRACEIO_FILTER, base, nRead,
+        asynPrintIORead(pasynUser, ASYN_TRACEIO_FILTER, base, nRead,
                                 "nRead %d after IAC unstuffing", (int)nRead);
     if (nRead == maxchars)
         eom |= ASYN_EOM_CNT;
@@ -32,12 +32,16 @@
 
 #define START_OUTPUT_SIZE 100
 #define INPUT_SIZE        2048
+/* Largest number of segments, including the output eos, passed to writeSegments */
+#define MAX_SEGMENTS      8
 
 typedef struct eosPvt {
     char          *portName;
     asynInterface eosInterface;
     asynOctet     *poctet;  /* The methods we're overriding */
     void          *octetPvt;
+    asynInterface segmentsInterface;
+    asynOctetSegments *psegments; /* NULL if the layer below has none */
     asynUser      *pasynUser;     /* For connect/disconnect reporting */
     int           processEosIn;
     size_t        inBufSize;
@@ -80,12 +84,17 @@ static asynOctet octet = {
     registerInterruptUser, cancelInterruptUser,
     setInputEos,getInputEos,setOutputEos,getOutputEos
 };
+/* asynOctetSegments methods */
+static asynStatus writeSegments(void *ppvt,asynUser *pasynUser,
+    const asynOctetSegment *segments,int nsegments,size_t *nbytesTransfered);
+static asynOctetSegments octetSegments = {writeSegments};
 
 ASYN_API int asynInterposeEosConfig(const char *portName,int addr,
     int processEosIn,int processEosOut)
 {
     eosPvt        *peosPvt;
     asynInterface *plowerLevelInterface;
+    asynInterface *plowerSegments;
     asynStatus    status;
     asynUser      *pasynUser;
     size_t        len;
@@ -114,6 +123,7 @@ ASYN_API int asynInterposeEosConfig(const char *portName,int addr,
         free(peosPvt);
         return -1;
     }
+    plowerSegments = pasynManager->findInterface(pasynUser,asynOctetSegmentsType,1);
     status = pasynManager->interposeInterface(portName,addr,
        &peosPvt->eosInterface,&plowerLevelInterface);
     if(status!=asynSuccess) {
@@ -125,6 +135,15 @@ ASYN_API int asynInterposeEosConfig(const char *portName,int addr,
     }
     peosPvt->poctet = (asynOctet *)plowerLevelInterface->pinterface;
     peosPvt->octetPvt = plowerLevelInterface->drvPvt;
+    /* Only if it belongs to the asynOctet below, not to one under a layer that rewrites the data */
+    if(plowerSegments && (plowerSegments->drvPvt == peosPvt->octetPvt)) {
+        peosPvt->psegments = (asynOctetSegments *)plowerSegments->pinterface;
+        peosPvt->segmentsInterface.interfaceType = asynOctetSegmentsType;
+        peosPvt->segmentsInterface.pinterface = &octetSegments;
+        peosPvt->segmentsInterface.drvPvt = peosPvt;
+        pasynManager->interposeInterface(portName,addr,
+            &peosPvt->segmentsInterface,0);
+    }
     peosPvt->processEosIn = processEosIn;
     if(processEosIn) {
         peosPvt->inBuf = callocMustSucceed(1,INPUT_SIZE,
@@ -154,28 +173,77 @@ static void eosInExceptionHandler(asynUser *pasynUser,asynException exception)
 static asynStatus writeIt(void *ppvt,asynUser *pasynUser,
     const char *data,size_t numchars,size_t *nbytesTransfered)
 {
-    eosPvt     *peosPvt = (eosPvt *)ppvt;
-    asynStatus status;
-    size_t     nbytesActual = 0;
+    asynOctetSegment segment;
+
+    segment.data = data;
+    segment.numchars = numchars;
+    return writeSegments(ppvt,pasynUser,&segment,1,nbytesTransfered);
+}
+
+static asynStatus writeSegments(void *ppvt,asynUser *pasynUser,
+    const asynOctetSegment *segments,int nsegments,size_t *nbytesTransfered)
+{
+    eosPvt           *peosPvt = (eosPvt *)ppvt;
+    asynOctet        *poctet = peosPvt->poctet;
+    asynOctetSegments *psegments = peosPvt->psegments;
+    asynStatus       status;
+    asynOctetSegment withEos[MAX_SEGMENTS];
+    size_t           numchars = 0;
+    size_t           nbytesActual = 0;
+    int              eosOutLen = 0;
+    int              i;
 
-    if((!peosPvt->processEosOut) || (peosPvt->eosOutLen <= 0)) {
-        return peosPvt->poctet->write(peosPvt->octetPvt,
-            pasynUser,data,numchars,nbytesTransfered);
+    if(peosPvt->processEosOut && (peosPvt->eosOutLen > 0))
+        eosOutLen = peosPvt->eosOutLen;
+    if((eosOutLen == 0) && psegments) {
+        return psegments->writeSegments(peosPvt->octetPvt,
+            pasynUser,segments,nsegments,nbytesTransfered);
     }
-    if(peosPvt->outBufSize<(numchars + peosPvt->eosOutLen)) {
-        pasynManager->memFree(peosPvt->outBuf,peosPvt->outBufSize);
-        peosPvt->outBufSize = numchars + peosPvt->eosOutLen;
-        peosPvt->outBuf = pasynManager->memMalloc(peosPvt->outBufSize);
+    if((eosOutLen == 0) && (nsegments == 1)) {
+        return poctet->write(peosPvt->octetPvt,
+            pasynUser,segments[0].data,segments[0].numchars,nbytesTransfered);
     }
-    memcpy(peosPvt->outBuf,data,numchars);
-    if(peosPvt->eosOutLen>0) {
-        memcpy(&peosPvt->outBuf[numchars],peosPvt->eosOut,peosPvt->eosOutLen);
+    for(i=0; i<nsegments; i++) numchars += segments[i].numchars;
+    if(psegments && (nsegments < MAX_SEGMENTS)) {
+        /* Send the output eos as one more segment so the data is not copied */
+        for(i=0; i<nsegments; i++) withEos[i] = segments[i];
+        withEos[nsegments].data = peosPvt->eosOut;
+        withEos[nsegments].numchars = eosOutLen;
+        status = psegments->writeSegments(peosPvt->octetPvt, pasynUser,
+             withEos,nsegments+1,&nbytesActual);
+        if (status!=asynError) {
+            /* Only trace the bytes that were written */
+            size_t nleft = nbytesActual;
+            for(i=0; (i<=nsegments) && (nleft>0); i++) {
+                size_t n = (withEos[i].numchars<nleft) ? withEos[i].numchars : nleft;
+                asynPrintIOWrite(pasynUser,ASYN_TRACEIO_FILTER,
+                    withEos[i].data,n,
+                    "%s wrote\n",peosPvt->portName);
+                nleft -= n;
+            }
+        }
+    } else {
+        /* The layer below has no asynOctetSegments, so gather the segments into outBuf */
+        size_t nchars = 0;
+        if(peosPvt->outBufSize<(numchars + eosOutLen)) {
+            if(peosPvt->outBuf)
+                pasynManager->memFree(peosPvt->outBuf,peosPvt->outBufSize);
+            peosPvt->outBufSize = numchars + eosOutLen;
+            peosPvt->outBuf = pasynManager->memMalloc(peosPvt->outBufSize);
+        }
+        for(i=0; i<nsegments; i++) {
+            memcpy(&peosPvt->outBuf[nchars],segments[i].data,segments[i].numchars);
+            nchars += segments[i].numchars;
+        }
+        if(eosOutLen>0) {
+            memcpy(&peosPvt->outBuf[numchars],peosPvt->eosOut,eosOutLen);
+        }
+        status = poctet->write(peosPvt->octetPvt, pasynUser,
+             peosPvt->outBuf,(numchars + eosOutLen),&nbytesActual);
+        if ((status!=asynError) && (eosOutLen>0))
+            asynPrintIOWrite(pasynUser,ASYN_TRACEIO_FILTER,peosPvt->outBuf,nbytesActual,
+                    "%s wrote\n",peosPvt->portName);
     }
-    status = peosPvt->poctet->write(peosPvt->octetPvt, pasynUser,
-         peosPvt->outBuf,(numchars + peosPvt->eosOutLen),&nbytesActual);
-    if (status!=asynError)
-        asynPrintIO(pasynUser,ASYN_TRACEIO_FILTER,peosPvt->outBuf,nbytesActual,
-                "%s wrote\n",peosPvt->portName);
     *nbytesTransfered = (nbytesActual>numchars) ? numchars : nbytesActual;
     return status;
 }
@@ -231,7 +299,7 @@ static asynStatus readIt(void *ppvt,asynUser *pasynUser,
         status = peosPvt->poctet->read(peosPvt->octetPvt,
              pasynUser,peosPvt->inBuf,peosPvt->inBufSize,&thisRead,&eom);
         if(status==asynSuccess) {
-            asynPrintIO(pasynUser,ASYN_TRACEIO_FILTER,peosPvt->inBuf,thisRead,
+            asynPrintIORead(pasynUser,ASYN_TRACEIO_FILTER,peosPvt->inBuf,thisRead,
                 "%s read %llu bytes eom=%d\n",peosPvt->portName, (epicsUInt64)thisRead, eom);
             /*
              * Read could have returned with ASYN_EOM_CNT set in eom because
@@ -125,7 +125,7 @@ static asynStatus flushIt(void *ppvt,asynUser *pasynUser)
         pasynOctetDrv->read(drvPvt,pasynUser,
             buffer,sizeof(buffer),&nbytesTransfered,0);
         if(nbytesTransfered==0) break;
-        asynPrintIO(pasynUser,ASYN_TRACEIO_FILTER,
+        asynPrintIORead(pasynUser,ASYN_TRACEIO_FILTER,
             buffer,nbytesTransfered,"asynInterposeFlush:flush\n");
     }
     pasynUser->timeout = savetimeout;
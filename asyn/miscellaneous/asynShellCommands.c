@@ -729,6 +729,7 @@ static const char asynSetTraceIOMaskUsage[] =
     "    0x01 - ASCII\n"
     "    0x02 - ESCAPE\n"
     "    0x04 - HEX\n"
+    "    0x08 - BINARY (see asynSetTraceBinaryFile)\n"
     "\n"
     "  eg. the following are equivalent\n"
     "    asynSetTraceIOMask MYPORT -1 0x6\n"
@@ -780,6 +781,7 @@ static int asynTraceIOMaskStringToInt(const char* maskStr) {
             else if (STARTSWITH(maskStr, ASCII)) mask |= ASYN_TRACEIO_ASCII;
             else if (STARTSWITH(maskStr, ESCAPE)) mask |= ASYN_TRACEIO_ESCAPE;
             else if (STARTSWITH(maskStr, HEX)) mask |= ASYN_TRACEIO_HEX;
+            else if (STARTSWITH(maskStr, BINARY)) mask |= ASYN_TRACEIO_BINARY;
             else break;
             while (isspace((unsigned char)*maskStr)) maskStr++;
         }
@@ -948,6 +950,92 @@ static void asynSetTraceIOTruncateSizeCall(const iocshArgBuf * args) {
     asynSetTraceIOTruncateSize(portName,addr,size);
 }
 
+static const iocshArg asynSetTraceAsyncArg0 = {"enable", iocshArgInt};
+static const iocshArg asynSetTraceAsyncArg1 = {"bufferSize", iocshArgInt};
+static const iocshArg asynSetTraceAsyncArg2 = {"overflow", iocshArgString};
+static const iocshArg *const asynSetTraceAsyncArgs[] = {
+    &asynSetTraceAsyncArg0,&asynSetTraceAsyncArg1,&asynSetTraceAsyncArg2};
+static const iocshFuncDef asynSetTraceAsyncDef =
+    {"asynSetTraceAsync", 3, asynSetTraceAsyncArgs};
+ASYN_API int
+ asynSetTraceAsync(int enable, int bufferSize, const char *overflow)
+{
+    asynTraceOverflow policy = asynTraceOverflowDropNew;
+    asynStatus status;
+
+    if(bufferSize<0) {
+        printf("bufferSize must be >= 0\n");
+        return -1;
+    }
+    if(overflow && strlen(overflow)>0) {
+        if(epicsStrCaseCmp(overflow,"dropNew")==0) {
+            policy = asynTraceOverflowDropNew;
+        } else if(epicsStrCaseCmp(overflow,"dropOld")==0) {
+            policy = asynTraceOverflowDropOld;
+        } else if(epicsStrCaseCmp(overflow,"block")==0) {
+            policy = asynTraceOverflowBlock;
+        } else {
+            char *endp;
+            long value = strtol(overflow,&endp,0);
+            if(*endp!=0 || value<asynTraceOverflowDropNew
+            || value>asynTraceOverflowBlock) {
+                printf("overflow must be dropNew, dropOld or block\n");
+                return -1;
+            }
+            policy = (asynTraceOverflow)value;
+        }
+    }
+    status = pasynTrace->setTraceAsync(enable,(size_t)bufferSize,policy);
+    return (status==asynSuccess) ? 0 : -1;
+}
+static void asynSetTraceAsyncCall(const iocshArgBuf * args) {
+    int enable = args[0].ival;
+    int bufferSize = args[1].ival;
+    const char *overflow = args[2].sval;
+    asynSetTraceAsync(enable,bufferSize,overflow);
+}
+
+static const iocshArg asynSetTraceBinaryFileArg0 = {"portName", iocshArgString};
+static const iocshArg asynSetTraceBinaryFileArg1 = {"filename", iocshArgString};
+static const iocshArg asynSetTraceBinaryFileArg2 = {"size", iocshArgInt};
+static const iocshArg *const asynSetTraceBinaryFileArgs[] = {
+    &asynSetTraceBinaryFileArg0,&asynSetTraceBinaryFileArg1,
+    &asynSetTraceBinaryFileArg2};
+static const iocshFuncDef asynSetTraceBinaryFileDef =
+    {"asynSetTraceBinaryFile", 3, asynSetTraceBinaryFileArgs};
+ASYN_API int
+ asynSetTraceBinaryFile(const char *portName, const char *filename, int size)
+{
+    asynUser   *pasynUser;
+    asynStatus status;
+
+    if(size<0) {
+        printf("size must be >= 0\n");
+        return -1;
+    }
+    pasynUser = pasynManager->createAsynUser(0,0);
+    if(portName && strlen(portName)!=0) {
+        status = pasynManager->connectDevice(pasynUser,portName,-1);
+        if(status!=asynSuccess) {
+            printf("%s\n",pasynUser->errorMessage);
+            pasynManager->freeAsynUser(pasynUser);
+            return -1;
+        }
+    }
+    status = pasynTrace->setTraceBinaryFile(pasynUser,filename,(size_t)size);
+    if(status!=asynSuccess) {
+        printf("%s\n",pasynUser->errorMessage);
+    }
+    pasynManager->freeAsynUser(pasynUser);
+    return (status==asynSuccess) ? 0 : -1;
+}
+static void asynSetTraceBinaryFileCall(const iocshArgBuf * args) {
+    const char *portName = args[0].sval;
+    const char *filename = args[1].sval;
+    int size = args[2].ival;
+    asynSetTraceBinaryFile(portName,filename,size);
+}
+
 static const iocshArg asynEnableArg0 = {"portName", iocshArgString};
 static const iocshArg asynEnableArg1 = {"addr", iocshArgInt};
 static const iocshArg asynEnableArg2 = {"yesNo", iocshArgInt};
@@ -1315,6 +1403,44 @@ static void asynSetQueueLockPortTimeoutCall(const iocshArgBuf * args) {
     asynSetQueueLockPortTimeout(portName,timeout);
 }
 
+static const iocshArg asynSetPortWorkersArg0 = {"portName", iocshArgString};
+static const iocshArg asynSetPortWorkersArg1 = {"numWorkers", iocshArgInt};
+static const iocshArg *const asynSetPortWorkersArgs[] = {
+    &asynSetPortWorkersArg0,&asynSetPortWorkersArg1};
+static const iocshFuncDef asynSetPortWorkersDef =
+    {"asynSetPortWorkers", 2, asynSetPortWorkersArgs};
+ASYN_API int
+ asynSetPortWorkers(const char *portName, int numWorkers)
+{
+    asynStatus status;
+
+    status = pasynManager->setPortWorkers(portName,numWorkers);
+    return (status==asynSuccess) ? 0 : -1;
+}
+static void asynSetPortWorkersCall(const iocshArgBuf * args) {
+    const char *portName = args[0].sval;
+    int numWorkers = args[1].ival;
+    asynSetPortWorkers(portName,numWorkers);
+}
+
+static const iocshArg asynSetPortPoolThreadsArg0 = {"numThreads", iocshArgInt};
+static const iocshArg *const asynSetPortPoolThreadsArgs[] = {
+    &asynSetPortPoolThreadsArg0};
+static const iocshFuncDef asynSetPortPoolThreadsDef =
+    {"asynSetPortPoolThreads", 1, asynSetPortPoolThreadsArgs};
+ASYN_API int
+ asynSetPortPoolThreads(int numThreads)
+{
+    asynStatus status;
+
+    status = pasynManager->setPortPoolThreads(numThreads);
+    return (status==asynSuccess) ? 0 : -1;
+}
+static void asynSetPortPoolThreadsCall(const iocshArgBuf * args) {
+    int numThreads = args[0].ival;
+    asynSetPortPoolThreads(numThreads);
+}
+
 static void asynRegister(void)
 {
     static int firstTime = 1;
@@ -1328,9 +1454,13 @@ static void asynRegister(void)
     iocshRegister(&asynSetTraceInfoMaskDef,asynSetTraceInfoMaskCall);
     iocshRegister(&asynSetTraceFileDef,asynSetTraceFileCall);
     iocshRegister(&asynSetTraceIOTruncateSizeDef,asynSetTraceIOTruncateSizeCall);
+    iocshRegister(&asynSetTraceAsyncDef,asynSetTraceAsyncCall);
+    iocshRegister(&asynSetTraceBinaryFileDef,asynSetTraceBinaryFileCall);
     iocshRegister(&asynEnableDef,asynEnableCall);
     iocshRegister(&asynAutoConnectDef,asynAutoConnectCall);
     iocshRegister(&asynSetQueueLockPortTimeoutDef,asynSetQueueLockPortTimeoutCall);
+    iocshRegister(&asynSetPortWorkersDef,asynSetPortWorkersCall);
+    iocshRegister(&asynSetPortPoolThreadsDef,asynSetPortPoolThreadsCall);
     iocshRegister(&asynOctetConnectDef,asynOctetConnectCall);
     iocshRegister(&asynOctetDisconnectDef,asynOctetDisconnectCall);
     iocshRegister(&asynOctetReadDef,asynOctetReadCall);
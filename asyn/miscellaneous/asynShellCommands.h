@@ -34,6 +34,10 @@ ASYN_API int
  asynSetTraceFile(const char *portName,int addr,const char *filename);
 ASYN_API int
  asynSetTraceIOTruncateSize(const char *portName,int addr,int size);
+ASYN_API int
+ asynSetTraceAsync(int enable, int bufferSize, const char *overflow);
+ASYN_API int
+ asynSetTraceBinaryFile(const char *portName, const char *filename, int size);
 ASYN_API int
  asynAutoConnect(const char *portName,int addr,int yesNo);
 ASYN_API int
@@ -70,6 +74,10 @@ ASYN_API int
  asynSetMinTimerPeriod(double period);
 ASYN_API int
  asynSetQueueLockPortTimeout(const char *portName, double timeout);
+ASYN_API int
+ asynSetPortWorkers(const char *portName, int numWorkers);
+ASYN_API int
+ asynSetPortPoolThreads(int numThreads);
 
 #ifdef __cplusplus
 }
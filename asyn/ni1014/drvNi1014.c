@@ -655,7 +655,7 @@ static asynStatus gpibPortRead(void *pdrvPvt,asynUser *pasynUser,
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
             "%s readGpib failed %s",pniport->portName,pniport->errorMessage);
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DRIVER,
         data,actual,"%s addr %d gpibPortRead\n",pniport->portName,addr);
     *nbytesTransfered = actual;
     return status;
@@ -684,7 +684,7 @@ static asynStatus gpibPortWrite(void *pdrvPvt,asynUser *pasynUser,
             "%s requested %d but sent %d bytes",pniport->portName,numchars,actual);
         status = asynError;
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         data,actual,"%s addr %d gpibPortWrite\n",pniport->portName,addr);
     *nbytesTransfered = actual;
     return status;
@@ -768,7 +768,7 @@ static asynStatus gpibPortAddressedCmd(void *pdrvPvt,asynUser *pasynUser,
             "%s writeGpib failed %s",pniport->portName,pniport->errorMessage);
     }
     actual = length - pniport->bytesRemainingCmd;
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         data,actual,"%s gpibPortAddressedCmd\n",pniport->portName);
     if(status!=asynSuccess) return status;
     writeCmd(pniport,cmdbuf,2,timeout,transferStateIdle);
@@ -791,7 +791,7 @@ static asynStatus gpibPortUniversalCmd(void *pdrvPvt, asynUser *pasynUser, int c
         epicsSnprintf(pasynUser->errorMessage,pasynUser->errorMessageSize,
             "%s writeGpib failed %s",pniport->portName,pniport->errorMessage);
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         buffer,1,"%s gpibPortUniversalCmd\n",pniport->portName);
     return status;
 }
@@ -1197,7 +1197,7 @@ static asynStatus vxiRead(void *drvPvt,asynUser *pasynUser,
         }
         thisRead = devReadR.data.data_len;
         if(thisRead>0) {
-            asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+            asynPrintIORead(pasynUser,ASYN_TRACEIO_DRIVER,
                 devReadR.data.data_val,devReadR.data.data_len,
                 "%s %d vxiRead\n",pvxiPort->portName,addr);
             memcpy(data, devReadR.data.data_val, thisRead);
@@ -1280,7 +1280,7 @@ static asynStatus vxiWrite(void *drvPvt,asynUser *pasynUser,
             break;
         } else {
             size = devWriteR.size;
-            asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+            asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
                 devWriteP.data.data_val,devWriteP.data.data_len,
                 "%s %d vxiWrite\n",pvxiPort->portName,addr);
             data += size;
@@ -1386,7 +1386,7 @@ static asynStatus vxiAddressedCmd(void *drvPvt,asynUser *pasynUser,
     if(!pdevLink->connected) return -1;
     asynPrint(pasynUser, ASYN_TRACE_FLOW,
         "%s %d vxiAddressedCmd %2.2x\n",pvxiPort->portName,addr, *data);
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,
         data,length,"%s %d vxiAddressedCmd\n",pvxiPort->portName,addr);
     nWrite = vxiWriteCmd(pvxiPort,pasynUser,addrBuffer,lenCmd);
     if(nWrite!=lenCmd)asynPrint(pasynUser,ASYN_TRACE_ERROR,
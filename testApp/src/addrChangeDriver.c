@@ -401,7 +401,7 @@ static asynStatus readIt(void *drvPvt,asynUser *pasynUser,
     }
     pasynOctetBase->callInterruptUsers(pasynUser,paddrChangePvt->pasynPvt,
         data,nbytesTransfered,eomReason);
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,data,*nbytesTransfered,
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DRIVER,data,*nbytesTransfered,
         "addrChangeDriver\n");
     return status;
 }
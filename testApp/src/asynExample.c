@@ -48,7 +48,7 @@ static void queueCallback(asynUser *pasynUser) {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
             "queueCallback write failed %s\n",pasynUser->errorMessage);
     } else {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,
+        asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DEVICE,
             pmydata->buffer,strlen(pmydata->buffer),
             "queueCallback write sent %lu bytes\n",(unsigned long)writeBytes);
     }
@@ -58,7 +58,7 @@ static void queueCallback(asynUser *pasynUser) {
         asynPrint(pasynUser,ASYN_TRACE_ERROR,
             "queueCallback read failed %s\n",pasynUser->errorMessage);
     } else {
-        asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,
+        asynPrintIORead(pasynUser,ASYN_TRACEIO_DEVICE,
             pmydata->buffer,BUFFER_SIZE,
             "queueCallback read returned: retlen %lu eomReason 0x%x data %s\n",
             (unsigned long)readBytes,eomReason,pmydata->buffer);
@@ -241,7 +241,7 @@ static asynStatus writeIt(asynUser *pasynUser,const char *message,size_t nbytes)
         recGblSetSevr(precord, WRITE_ALARM, MINOR_ALARM);
         return asynError;
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,message,nbytes,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DEVICE,message,nbytes,
        "%s devTestBlock: writeIt\n",precord->name);
     return status;
 }
@@ -265,7 +265,7 @@ static asynStatus readIt(asynUser *pasynUser,char *message,
         recGblSetSevr(precord, READ_ALARM, INVALID_ALARM);
         return status;
     }
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DEVICE,message,*nBytesRead,
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DEVICE,message,*nBytesRead,
        "%s devTestBlock: readIt eomReason %d\n",precord->name,eomReason);
     return status;
 }
@@ -302,7 +302,7 @@ static asynStatus echoWrite(void *drvPvt,asynUser *pasynUser,
     pdeviceBuffer = &pdeviceInfo->buffer;
     if(nchars>BUFFERSIZE) nchars = BUFFERSIZE;
     if(nchars>0) memcpy(pdeviceBuffer->buffer,data,nchars);
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,data,nchars,
+    asynPrintIOWrite(pasynUser,ASYN_TRACEIO_DRIVER,data,nchars,
             "echoWrite nchars %lu\n",(unsigned long)nchars);
     pdeviceBuffer->nchars = nchars;
     if(pechoPvt->delay>0.0) epicsThreadSleep(pechoPvt->delay);
@@ -392,7 +392,7 @@ static asynStatus echoRead(void *drvPvt,asynUser *pasynUser,
     }
     pasynOctetBase->callInterruptUsers(pasynUser,pechoPvt->pasynPvt,
         data,nbytesTransfered,eomReason);
-    asynPrintIO(pasynUser,ASYN_TRACEIO_DRIVER,data,nout,
+    asynPrintIORead(pasynUser,ASYN_TRACEIO_DRIVER,data,nout,
         "echoRead nbytesTransfered %lu\n",(unsigned long)*nbytesTransfered);
     return status;
 }
@@ -17,6 +17,7 @@
 #include <iocsh.h>
 
 #include <asynPortDriver.h>
+#include <asynArrayBuffer.h>
 
 #include <epicsExport.h>
 
@@ -59,7 +60,7 @@ protected:
 private:
     /* Our data */
     epicsEventId eventId_;
-    epicsInt32 *pData_;
+    asynArrayBuffer *pBuffer_; /* The most recent array */
 };
 
 void arrayGenTaskC(void *drvPvt)
@@ -89,7 +90,8 @@ testArrayRingBuffer::testArrayRingBuffer(const char *portName, int maxArrayLengt
     if (maxArrayLength < 1) maxArrayLength = 10;
 
     /* Allocate the waveform array */
-    pData_ = (epicsInt32 *)calloc(maxArrayLength, sizeof(epicsInt32));
+    pBuffer_ = asynArrayBufferCreate(maxArrayLength*sizeof(epicsInt32));
+    memset(asynArrayBufferData(pBuffer_), 0, maxArrayLength*sizeof(epicsInt32));
 
     eventId_ = epicsEventCreate(epicsEventEmpty);
     createParam(P_RunStopString,            asynParamInt32,         &P_RunStop);
@@ -130,6 +132,7 @@ void testArrayRingBuffer::arrayGenTask(void)
     double burstDelay;
     epicsInt32 maxArrayLength;
     epicsInt32 arrayLength;
+    epicsInt32 *pData;
 
     lock();
     /* Loop forever */
@@ -154,12 +157,17 @@ void testArrayRingBuffer::arrayGenTask(void)
         }
         getIntegerParam(P_BurstLength, &burstLength);
         for (i=0; i<burstLength; i++) {
+            /* Each array gets a new buffer because ring buffers in device support
+             * can still hold references to the previous ones */
+            asynArrayBufferRelease(pBuffer_);
+            pBuffer_ = asynArrayBufferCreate(maxArrayLength*sizeof(epicsInt32));
+            pData = (epicsInt32 *)asynArrayBufferData(pBuffer_);
             for (j=0; j<arrayLength; j++) {
-                pData_[j] = i;
+                pData[j] = i;
             }
             setIntegerParam(P_ScalarData, i);
             callParamCallbacks();
-            doCallbacksInt32Array(pData_, arrayLength, P_ArrayData, 0);
+            doCallbacksArrayBuffer(pBuffer_, arrayLength, P_ArrayData, 0);
             if (burstDelay > 0.0)
                 epicsThreadSleep(burstDelay);
         }
@@ -224,7 +232,7 @@ asynStatus testArrayRingBuffer::readInt32Array(asynUser *pasynUser, epicsInt32 *
     getIntegerParam(P_ArrayLength, &nCopy);
     if ((int)nElements < nCopy) nCopy = (int)nElements;
     if (function == P_ArrayData) {
-        memcpy(value, pData_, nCopy*sizeof(epicsInt32));
+        memcpy(value, asynArrayBufferData(pBuffer_), nCopy*sizeof(epicsInt32));
         *nIn = nCopy;
     }
     if (status)
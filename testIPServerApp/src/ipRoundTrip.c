@@ -0,0 +1,114 @@
+/* ipRoundTrip.c */
+/*
+ * Measures the cost of write/read round trips through a drvAsynIPPort client port
+ * connected to an echo server.  It reports the elapsed time and the number of
+ * socket I/O calls made by the driver for each round trip.
+ */
+/***********************************************************************
+* Copyright (c) 2002 The University of Chicago, as Operator of Argonne
+* National Laboratory, and the Regents of the University of
+* California, as Operator of Los Alamos National Laboratory
+* asynDriver is distributed subject to a Software License Agreement
+* found in file LICENSE that is included with this distribution.
+***********************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <epicsTime.h>
+#include <asynDriver.h>
+#include <asynOctetSyncIO.h>
+#include <asynOptionSyncIO.h>
+#include <iocsh.h>
+#include <epicsExport.h>
+
+#define MESSAGE_SIZE 80
+#define TIMEOUT 1.0
+
+static int getSocketCalls(asynUser *pasynUser, unsigned long *nCalls)
+{
+    char value[40];
+    asynStatus status;
+
+    status = pasynOptionSyncIO->getOption(pasynUser, "socketCalls", value, sizeof(value), TIMEOUT);
+    if (status != asynSuccess) {
+        printf("ipRoundTrip: getOption socketCalls failed: %s\n", pasynUser->errorMessage);
+        return -1;
+    }
+    *nCalls = strtoul(value, NULL, 10);
+    return 0;
+}
+
+static void ipRoundTrip(const char *portName, int count, const char *message)
+{
+    asynUser *pasynUserOctet;
+    asynUser *pasynUserOption;
+    char readBuffer[MESSAGE_SIZE];
+    size_t nWrite, nRead;
+    int eomReason;
+    unsigned long startCalls, endCalls;
+    epicsTimeStamp startTime, endTime;
+    double elapsed;
+    asynStatus status;
+    int i;
+
+    if (!portName || !*portName) {
+        printf("Usage: ipRoundTrip port [count] [message]\n");
+        return;
+    }
+    if (count <= 0) count = 1000;
+    if (!message || !*message) message = "round trip test";
+    status = pasynOctetSyncIO->connect(portName, 0, &pasynUserOctet, NULL);
+    if (status != asynSuccess) {
+        printf("ipRoundTrip: can't connect asynOctet to port %s\n", portName);
+        return;
+    }
+    status = pasynOptionSyncIO->connect(portName, 0, &pasynUserOption, NULL);
+    if (status != asynSuccess) {
+        printf("ipRoundTrip: can't connect asynOption to port %s\n", portName);
+        pasynOctetSyncIO->disconnect(pasynUserOctet);
+        return;
+    }
+    if (getSocketCalls(pasynUserOption, &startCalls)) goto done;
+    epicsTimeGetCurrent(&startTime);
+    for (i=0; i<count; i++) {
+        status = pasynOctetSyncIO->writeRead(pasynUserOctet, message, strlen(message),
+                                             readBuffer, sizeof(readBuffer), TIMEOUT,
+                                             &nWrite, &nRead, &eomReason);
+        if (status != asynSuccess) {
+            printf("ipRoundTrip: writeRead %d failed: %s\n", i, pasynUserOctet->errorMessage);
+            goto done;
+        }
+    }
+    epicsTimeGetCurrent(&endTime);
+    if (getSocketCalls(pasynUserOption, &endCalls)) goto done;
+    elapsed = epicsTimeDiffInSeconds(&endTime, &startTime);
+    printf("ipRoundTrip: %d round trips on %s in %.3f seconds\n", count, portName, elapsed);
+    printf("  %.1f microseconds per round trip\n", elapsed * 1.e6 / count);
+    printf("  %.2f socket I/O calls per round trip\n", (double)(endCalls - startCalls) / count);
+done:
+    pasynOptionSyncIO->disconnect(pasynUserOption);
+    pasynOctetSyncIO->disconnect(pasynUserOctet);
+}
+
+static const iocshArg ipRoundTripArg0 = {"port", iocshArgString};
+static const iocshArg ipRoundTripArg1 = {"count", iocshArgInt};
+static const iocshArg ipRoundTripArg2 = {"message", iocshArgString};
+static const iocshArg *const ipRoundTripArgs[] = {
+    &ipRoundTripArg0,
+    &ipRoundTripArg1,
+    &ipRoundTripArg2};
+static const iocshFuncDef ipRoundTripDef = {"ipRoundTrip", 3, ipRoundTripArgs};
+static void ipRoundTripCall(const iocshArgBuf * args)
+{
+    ipRoundTrip(args[0].sval, args[1].ival, args[2].sval);
+}
+
+static void ipRoundTripRegister(void)
+{
+    static int firstTime = 1;
+    if(!firstTime) return;
+    firstTime = 0;
+    iocshRegister(&ipRoundTripDef,ipRoundTripCall);
+}
+epicsExportRegistrar(ipRoundTripRegister);